@@ -0,0 +1,173 @@
+#pragma once
+
+/**
+ * @brief 把 answer_N.cpp 的原始实现作为可调用的参考版本
+ *
+ * 每个文件放在自己的命名空间 answer_N 中（各文件有同名的 BGR2GRAY、gaussian_filter 等函数），
+ * main 改名为 answer_N::main_，不会被调用。answer_N.cpp 用到的头文件必须先在这里包含。
+ * 只用于基准测试和正确性对比，不要在其他代码中包含。
+ *
+ * 注意：answer_32 ~ answer_40、answer_44 ~ answer_46 的实现固定处理 128 × 128 的图像。
+ */
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <math.h>
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+
+#define main main_
+
+// clang-format off
+namespace answer_1 {
+#include "answer_1.cpp"
+}
+namespace answer_2 {
+#include "answer_2.cpp"
+}
+namespace answer_3 {
+#include "answer_3.cpp"
+}
+namespace answer_4 {
+#include "answer_4.cpp"
+}
+namespace answer_5 {
+#include "answer_5.cpp"
+}
+namespace answer_6 {
+#include "answer_6.cpp"
+}
+namespace answer_7 {
+#include "answer_7.cpp"
+}
+namespace answer_8 {
+#include "answer_8.cpp"
+}
+namespace answer_9 {
+#include "answer_9.cpp"
+}
+namespace answer_10 {
+#include "answer_10.cpp"
+}
+namespace answer_11 {
+#include "answer_11.cpp"
+}
+namespace answer_12 {
+#include "answer_12.cpp"
+}
+namespace answer_13 {
+#include "answer_13.cpp"
+}
+namespace answer_14 {
+#include "answer_14.cpp"
+}
+namespace answer_15 {
+#include "answer_15.cpp"
+}
+namespace answer_16 {
+#include "answer_16.cpp"
+}
+namespace answer_17 {
+#include "answer_17.cpp"
+}
+namespace answer_18 {
+#include "answer_18.cpp"
+}
+namespace answer_19 {
+#include "answer_19.cpp"
+}
+namespace answer_21 {
+#include "answer_21.cpp"
+}
+namespace answer_22 {
+#include "answer_22.cpp"
+}
+namespace answer_23 {
+#include "answer_23.cpp"
+}
+namespace answer_24 {
+#include "answer_24.cpp"
+}
+namespace answer_25 {
+#include "answer_25.cpp"
+}
+namespace answer_26 {
+#include "answer_26.cpp"
+}
+namespace answer_27 {
+#include "answer_27.cpp"
+}
+namespace answer_28 {
+#include "answer_28.cpp"
+}
+namespace answer_29 {
+#include "answer_29.cpp"
+}
+namespace answer_30 {
+#include "answer_30.cpp"
+}
+namespace answer_31 {
+#include "answer_31.cpp"
+}
+namespace answer_32 {
+#include "answer_32.cpp"
+}
+namespace answer_33 {
+#include "answer_33.cpp"
+}
+namespace answer_34 {
+#include "answer_34.cpp"
+}
+namespace answer_35 {
+#include "answer_35.cpp"
+}
+namespace answer_36 {
+#include "answer_36.cpp"
+}
+namespace answer_37 {
+#include "answer_37.cpp"
+}
+namespace answer_38 {
+#include "answer_38.cpp"
+}
+namespace answer_39 {
+#include "answer_39.cpp"
+}
+namespace answer_40 {
+#include "answer_40.cpp"
+}
+namespace answer_41 {
+#include "answer_41.cpp"
+}
+namespace answer_42 {
+#include "answer_42.cpp"
+}
+namespace answer_43 {
+#include "answer_43.cpp"
+}
+namespace answer_44 {
+#include "answer_44.cpp"
+}
+namespace answer_45 {
+#include "answer_45.cpp"
+}
+namespace answer_46 {
+#include "answer_46.cpp"
+}
+namespace answer_47 {
+#include "answer_47.cpp"
+}
+namespace answer_48 {
+#include "answer_48.cpp"
+}
+namespace answer_49 {
+#include "answer_49.cpp"
+}
+namespace answer_50 {
+#include "answer_50.cpp"
+}
+// clang-format on
+
+#undef main
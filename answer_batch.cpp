@@ -0,0 +1,49 @@
+#include <cedar/image.hpp>
+#include <cstdlib>
+#include <iostream>
+
+#include "batch.hpp"
+
+// 用法：answer_batch <处理链> <输入目录|文件列表.txt|图像> ... [-o 输出目录] [-f 扩展名] [-j 并行文件数] [-q 预读长度]
+// 例如：./answer_batch gray,gauss:1.3:3,canny,hough:20 images/ -o lines -f png
+// 不带参数时用 gray,gauss,canny 处理 imori.jpg 和 imori_1.jpg，结果写到 out/。
+int main(int argc, char** argv) {
+    std::string spec = argc > 1 ? argv[1] : "gray,gauss,canny";
+    std::vector<std::string> inputs;
+    BatchConfig config;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.size() == 2 && arg[0] == '-' && i + 1 < argc) {
+            const char* value = argv[++i];
+            switch (arg[1]) {
+                case 'o': config.output_dir = value; break;
+                case 'f': config.format = value; break;
+                case 'j': config.workers = std::atoi(value); break;
+                case 'q': config.prefetch = std::max(1, std::atoi(value)); break;
+                default: std::cerr << "未知参数: " << arg << std::endl; return 1;
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (argc <= 2) {
+        inputs = {"imori.jpg", "imori_1.jpg"};
+    }
+
+    OperatorChain chain;
+    if (!chain.parse(spec)) {
+        return 1;
+    }
+    std::vector<std::string> files;
+    for (const std::string& in : inputs) {
+        if (!batch_inputs(in, files)) {
+            return 1;
+        }
+    }
+    std::cerr << chain.describe() << ": " << files.size() << " files" << std::endl;
+
+    BatchStats stats = batch_process(files, chain, config);
+    std::cerr << stats.report();
+
+    return stats.failed ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "clahe.hpp"
+#include "histogram.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 全局直方图均衡化，与 answer_23 相同
+    Mat global = equalize_hist(image);
+
+    // CLAHE：只处理亮度
+    ClaheConfig config;
+    Mat luminance = clahe(image, config);
+
+    // CLAHE：每个通道分别处理，块更小、截断更强
+    config.mode = CLAHE_PER_CHANNEL;
+    config.tiles_x = config.tiles_y = 4;
+    config.clip_limit = 1.5;
+    Mat per_channel = clahe(image, config);
+
+    saveImage("out_global.jpg", global);
+    saveImage("out_per_channel.jpg", per_channel);
+    saveImage("out.jpg", luminance);
+
+    return 0;
+}
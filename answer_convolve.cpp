@@ -0,0 +1,34 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "convolve.hpp"
+#include "morphology.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+    Mat gray = BGR2GRAY(image);
+
+    // 运动模糊，与 answer_12 相同（不可分离、3 × 3 展开）
+    Mat motion = motion_filter(image, 3);
+
+    // Sobel：秩 1 的整数核，按行、列分离后在 int16 上计算
+    Convolver sobel(kernel_sobel(false));
+    std::cout << "sobel: separable " << sobel.separable() << ", integer " << sobel.integer() << std::endl;
+    Mat edge = sobel.apply(gray);
+
+    // Emboss、LoG，与 answer_18、answer_19 相同
+    Mat emboss = emboss_filter(gray);
+    Mat log = log_filter(gray, 5, 3);
+
+    // 最大-最小滤波（answer_13）不是线性滤波，由形态学的膨胀、腐蚀相减得到
+    Mat max_min = max_min_filter(gray, 3);
+
+    saveImage("out_sobel.jpg", edge);
+    saveImage("out_emboss.jpg", emboss);
+    saveImage("out_log.jpg", log);
+    saveImage("out_max_min.jpg", max_min);
+    saveImage("out.jpg", motion);
+
+    return 0;
+}
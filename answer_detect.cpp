@@ -0,0 +1,92 @@
+#include <cedar/image.hpp>
+#include <fstream>
+#include <iostream>
+#include <xtensor/xadapt.hpp>
+#include <xtensor/xarray.hpp>
+
+#include "detector.hpp"
+#include "nn.hpp"
+#include "nn_int8.hpp"
+#include "nn_io.hpp"
+#include "sample_miner.hpp"
+
+/**
+ * @brief 训练检测用的神经网络并保存
+ *
+ * 从环形缓冲区中取出挖掘好的样本按 batch 训练，训练完成后保存到 path。
+ *
+ * @param ring 样本环形缓冲区
+ * @param path 模型保存路径
+ * @param iterations 训练的 batch 数
+ *
+ * @return 保存成功返回 true
+ */
+bool train_detector(SampleRing& ring, const string& path, int iterations = 3000) {
+    int batch = ring.batch_size();
+    int dim = ring.feature_dim();
+    NN nn(dim, 64, 64, 1, 0.01);
+
+    xt::xarray<double> x = xt::zeros<double>({(size_t)batch, (size_t)dim});
+    xt::xarray<double> t = xt::zeros<double>({(size_t)batch, (size_t)1});
+    std::vector<size_t> x_shape = {(size_t)batch, (size_t)dim};
+    std::vector<size_t> t_shape = {(size_t)batch, (size_t)1};
+
+    for (int i = 0; i < iterations; ++i) {
+        int slot = ring.acquire_ready();
+        x = xt::adapt(ring.features(slot), (size_t)batch * dim, xt::no_ownership(), x_shape);
+        t = xt::adapt(ring.labels(slot), (size_t)batch, xt::no_ownership(), t_shape);
+        ring.release(slot);
+        nn.train(x, t);
+    }
+
+    return save_nn(path, nn.layers());
+}
+
+int main() {
+    // 读取图片
+    Mat image = loadAndCheckImage("./imori_1.jpg");
+    Mat gray = BGR2GRAY(image);
+
+    // 挖掘样本：用于训练（模型不存在时）和 int8 校准
+    MinerConfig miner_config;
+    int dim = SampleMiner::feature_dim(miner_config);
+    SampleRing ring(8, 64, dim);
+    std::vector<MiningImage> images = {{gray, {47, 41, 129, 103}}};
+    SampleMiner miner(images, ring, miner_config);
+    miner.start();
+
+    const string model_path = "detector.model";
+    if (!std::ifstream(model_path) && !train_detector(ring, model_path)) {
+        return 1;
+    }
+
+    MappedNN model;
+    if (!model.open(model_path)) {
+        return 1;
+    }
+
+    // 取一个 batch 做 int8 校准
+    int slot = ring.acquire_ready();
+    std::vector<double> calib(ring.features(slot), ring.features(slot) + (size_t)ring.batch_size() * dim);
+    ring.release(slot);
+    miner.stop();
+    QuantizedNN first_stage(model.layers(), calib.data(), ring.batch_size());
+
+    // 检测
+    DetectorConfig config;
+    config.window = miner_config.canonical_size;
+    config.min_object = miner_config.crop_size;
+    Detector detector(model.layers(), config, &first_stage);
+    std::vector<Detection> dets = detector.detect(image);
+
+    // 绘制检测框
+    for (const Detection& d : dets) {
+        cout << "检测到: [" << d.box.x1 << ", " << d.box.y1 << ", " << d.box.x2 << ", " << d.box.y2
+             << "] score=" << d.score << endl;
+        cv::rectangle(image, cv::Point((int)d.box.x1, (int)d.box.y1), cv::Point((int)d.box.x2, (int)d.box.y2),
+                      cv::Scalar(0, 0, 255), 1);
+    }
+    saveImage("./out.jpg", image);
+
+    return 0;
+}
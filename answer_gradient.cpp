@@ -0,0 +1,41 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "convolve.hpp"
+#include "gradient.hpp"
+#include "hough.hpp"
+#include "lut.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+    Mat gray = BGR2GRAY(image);
+
+    // Canny 第一步（answer_41）：Sobel 梯度的幅值和 4 个方向，一次扫描得到
+    GradientImages canny = gradient(gray, GRAD_MAGNITUDE | GRAD_ORIENTATION);
+    Mat edge;
+    canny.magnitude.convertTo(edge, CV_8U);
+    // 方向编号 0 ~ 3 换成 answer_41 的角度 0、45、90、135
+    Mat angle = apply_lut(canny.orientation, Lut::generate([](int v) { return v * 45; }));
+
+    // HOG 使用的梯度：中心差分、边界镜像、9 个方向
+    GradientConfig config;
+    config.kernel = GRAD_CENTRAL;
+    config.reflect = true;
+    config.bins = 9;
+    config.centered = false;
+    GradientImages hog = gradient(gray, GRAD_X | GRAD_Y | GRAD_ORIENTATION, config);
+    std::cout << "hog gradient: " << hog.gx.cols << "x" << hog.gx.rows << std::endl;
+
+    // Hough 直线检测（answer_44 ~ 46）：高斯模糊后的 canny 边缘投票，画出票数最多的 30 条直线
+    std::vector<HoughLine> lines = hough_lines(convolve(gray, kernel_gaussian(5, 1.4)));
+    Mat hough = image.clone();
+    hough_draw(hough, lines);
+    std::cout << "hough: " << lines.size() << " lines" << std::endl;
+
+    saveImage("out_angle.jpg", angle);
+    saveImage("out_hough.jpg", hough);
+    saveImage("out.jpg", edge);
+
+    return 0;
+}
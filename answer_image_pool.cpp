@@ -0,0 +1,72 @@
+#include <cedar/image.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "convolve.hpp"
+#include "image_pool.hpp"
+#include "lut.hpp"
+#include "morphology.hpp"
+
+// 替换全局的 operator new，统计所有线程的堆分配次数（new[] 默认也经过这里；
+// OpenCV 的像素数据不经过 operator new，输出是否重新分配由 data 指针检查）
+static std::atomic<size_t> heap_allocations(0);
+
+void* operator new(size_t size) {
+    ++heap_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main() {
+    // 读取图像，用不同的伽马值模拟连续的几帧
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // answer_43 的前半部分（高斯 → Sobel → 二值化）加一次开运算，中间图像全部从缓冲池借出
+    ImagePool pool;
+    Convolver gauss(kernel_gaussian(5, 1.4)), sobel(kernel_sobel(true));
+    MorphologyConfig open;
+    open.op = MORPHOLOGY_OPEN;
+    Mat result;
+    size_t warm = 0;
+    for (int frame = 0; frame < 5; ++frame) {
+        size_t heap_before = heap_allocations;
+        Mat input = pool.acquire(image.size(), image.type());
+        apply_lut(image, input, lut_gamma(1, 1.0 + 0.2 * frame));
+        Mat blur = pool.acquire(image.size(), image.type());
+        gauss.apply(input, blur);
+        Mat edge = pool.acquire(image.size(), image.type());
+        sobel.apply(blur, edge);
+        Mat binary = pool.acquire(image.size(), image.type());
+        apply_lut(edge, binary, lut_threshold(64));
+        Mat opened = pool.acquire(image.size(), image.type());
+        const uchar* data = opened.data;
+        morphology(binary, opened, open);
+        size_t heap = heap_allocations - heap_before;
+        CV_Assert(opened.data == data);  // 输出直接写进借出的图像，没有重新分配
+
+        const ImagePoolStats& s = pool.stats();
+        std::cout << "frame " << frame << ": allocations " << s.allocations << ", reuses " << s.reuses << ", bytes "
+                  << s.bytes << ", heap allocations " << heap << std::endl;
+        // 第一帧之后池不再申请新的缓冲区，滤波、形态学内部与并行调度也不再申请内存
+        if (frame == 0) {
+            warm = s.allocations;
+        } else {
+            CV_Assert(heap == 0);
+        }
+        CV_Assert(s.allocations == warm);
+
+        result = opened.clone();  // 借出的图像在 next_frame 之后失效
+        pool.next_frame();
+    }
+
+    saveImage("out.jpg", result);
+
+    return 0;
+}
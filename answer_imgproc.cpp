@@ -0,0 +1,28 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "imgproc.hpp"
+
+// 需要先执行 ./build_lib.sh 编译 libimgproc.a
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+    Mat gray = BGR2GRAY(image);
+
+    std::cout << "cpu: " << imgproc::cpu_level_name(imgproc::cpu_detect())
+              << ", using: " << imgproc::cpu_level_name(imgproc::cpu_level()) << std::endl;
+
+    // 与头文件中的同名函数结果相同，内核按当前 CPU 选择
+    Mat blurred, equalized, edge;
+    imgproc::convolve(image, blurred, kernel_gaussian(3, 1.3));
+    imgproc::equalize_hist(blurred, equalized);
+
+    GradientImages grad;
+    imgproc::gradient(gray, grad, GRAD_MAGNITUDE);
+    grad.magnitude.convertTo(edge, CV_8U);
+
+    saveImage("out_edge.jpg", edge);
+    saveImage("out.jpg", equalized);
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "histogram.hpp"
+#include "lut.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 单个点运算：二值化（answer_3）、减色（answer_6）、伽马校正（answer_24）
+    Mat binary = apply_lut(BGR2GRAY(image), lut_threshold(128));
+    Mat decreased = apply_lut(image, lut_quantize(4));
+
+    // 伽马校正 -> 直方图归一化 -> 减色，先合成一张表，只遍历一次图像
+    Lut gamma = lut_gamma(1, 2.2);
+    Histogram hist(apply_lut(image, gamma));
+    Lut chain = gamma.then(normalize_lut(hist, 0, 255)).then(lut_quantize(8));
+    Mat chained = apply_lut(image, chain);
+
+    // 每个通道使用不同的表
+    ChannelLut tint(Lut::identity(), lut_gamma(1, 1.2), lut_gamma(1, 0.8));
+    Mat tinted = apply_lut(image, tint);
+
+    saveImage("out_binary.jpg", binary);
+    saveImage("out_decreased.jpg", decreased);
+    saveImage("out_tinted.jpg", tinted);
+    saveImage("out.jpg", chained);
+
+    return 0;
+}
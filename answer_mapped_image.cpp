@@ -0,0 +1,46 @@
+#include <cedar/image.hpp>
+
+#include <chrono>
+#include <iostream>
+
+#include "convolve.hpp"
+#include "mapped_image.hpp"
+
+// 毫秒
+template <typename F>
+static double time_ms(F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main() {
+    // 第一阶段：解码一次 JPEG，缓存为 .cimg 与 .ppm
+    Mat image = loadAndCheckImage("imori.jpg");
+    if (!save_mapped_image("imori.cimg", image) || !save_pnm("imori.ppm", image)) {
+        return 1;
+    }
+
+    // 第二阶段（可以是另一个进程）：映射缓存，结果直接写进输出文件的映射
+    Mat decoded;
+    MappedImage cached, ppm;
+    double t_decode = time_ms([&] { decoded = loadAndCheckImage("imori.jpg"); });
+    double t_map = time_ms([&] { cached.open("imori.cimg"); });
+    double t_ppm = time_ms([&] { ppm.open("imori.ppm"); });
+    std::cout << "imread: " << t_decode << " ms, cimg: " << t_map << " ms, ppm: " << t_ppm << " ms" << std::endl;
+
+    MappedImage blurred;
+    if (!blurred.create("blurred.cimg", cached.rows(), cached.cols(), cached.type())) {
+        return 1;
+    }
+    Mat view = blurred.image();
+    Convolver(kernel_gaussian(5, 1.4)).apply(cached.image(), view);
+    CV_Assert(view.data == blurred.image().data);  // 没有重新分配
+
+    // PPM 的零拷贝视图是 RGB，保存前用 bgr() 转换
+    CV_Assert(ppm.rgb());
+    saveImage("out.jpg", blurred.image());
+    saveImage("out_ppm.jpg", ppm.bgr());
+
+    return 0;
+}
@@ -1,9 +1,14 @@
 #include <cedar/image.hpp>
+#include <chrono>
 #include <iostream>
 #include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xadapt.hpp>
 #include <xtensor/xarray.hpp>
 #include <xtensor/xrandom.hpp>  // 包含 xtensor 库的随机数头文件
 
+#include "nn.hpp"
+#include "sample_miner.hpp"
+
 /**
  * @brief 打印 xarray 对象
  *
@@ -128,5 +133,32 @@ int main() {
 
     saveImage("./out.jpg", img);
 
+    // 多线程挖掘训练样本，按 batch 训练神经网络
+    MinerConfig config;
+    int dim = SampleMiner::feature_dim(config);
+    int batch = 64;
+    SampleRing ring(8, batch, dim);
+    std::vector<MiningImage> images = {{BGR2GRAY(loadAndCheckImage("./imori_1.jpg")), {47, 41, 129, 103}}};
+    SampleMiner miner(images, ring, config);
+    NN nn(dim, 64, 64, 1, 0.01);
+
+    xt::xarray<double> x = xt::zeros<double>({(size_t)batch, (size_t)dim});
+    xt::xarray<double> t = xt::zeros<double>({(size_t)batch, (size_t)1});
+    std::vector<size_t> x_shape = {(size_t)batch, (size_t)dim};
+    std::vector<size_t> t_shape = {(size_t)batch, (size_t)1};
+
+    auto start = std::chrono::steady_clock::now();
+    miner.start();
+    for (int i = 0; i < 2000; ++i) {
+        int slot = ring.acquire_ready();
+        x = xt::adapt(ring.features(slot), (size_t)batch * dim, xt::no_ownership(), x_shape);
+        t = xt::adapt(ring.labels(slot), (size_t)batch, xt::no_ownership(), t_shape);
+        ring.release(slot);
+        nn.train(x, t);
+    }
+    miner.stop();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cout << "挖掘样本数: " << miner.produced() << ", 窗口/秒: " << miner.produced() / seconds << endl;
+
     return 0;
 }
@@ -0,0 +1,37 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "morphology.hpp"
+#include "otsu.hpp"
+
+int main() {
+    // 读取图像并用大津法二值化
+    Mat image = loadAndCheckImage("imori.jpg");
+    Mat binary = otsu_binarize(BGR2GRAY(image));
+
+    // 膨胀、腐蚀各 2 次，与 answer_47、answer_48 相同
+    MorphologyConfig config;
+    config.iterations = 2;
+    Mat dilated = morphology(binary, config);
+    config.op = MORPHOLOGY_ERODE;
+    Mat eroded = morphology(binary, config);
+
+    // 开运算，与 answer_49 相同
+    MorphologyConfig open;
+    open.op = MORPHOLOGY_OPEN;
+    Mat opened = morphology(binary, open);
+
+    // 彩色图像的 3 × 3 方形闭运算，各通道独立处理
+    MorphologyConfig close;
+    close.op = MORPHOLOGY_CLOSE;
+    close.square = true;
+    Mat closed = morphology(image, close);
+    std::cout << "threads: " << parallel_threads() << std::endl;
+
+    saveImage("out_erode.jpg", eroded);
+    saveImage("out_open.jpg", opened);
+    saveImage("out_close.jpg", closed);
+    saveImage("out.jpg", dilated);
+
+    return 0;
+}
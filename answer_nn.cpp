@@ -6,88 +6,9 @@
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
 
-class NN {
-   private:
-    xt::xarray<double> w1, b1, w2, b2, wout, bout;
-    xt::xarray<double> z2, z3, out;
-    double learning_rate;
-    // Sigmoid函数作为类内方法
-    xt::xarray<double> sigmoid(const xt::xarray<double>& x) { return 1 / (1 + xt::exp(-x)); }
-
-   public:
-    /**
-     * @brief 构造函数，初始化神经网络
-     *
-     * 初始化神经网络的权重和偏置，包括输入层到隐藏层、隐藏层到隐藏层以及隐藏层到输出层的权重和偏置。
-     *
-     * @param input_dim 输入层维度，默认为2
-     * @param hidden_dim 第一个隐藏层维度，默认为64
-     * @param hidden_dim2 第二个隐藏层维度，默认为64
-     * @param output_dim 输出层维度，默认为1
-     * @param lr 学习率，默认为0.1
-     */
-    NN(int input_dim = 2, int hidden_dim = 64, int hidden_dim2 = 64, int output_dim = 1, double lr = 0.1) {
-        // 初始化权重和偏置
-        w1 = xt::random::randn<double>({input_dim, hidden_dim});
-        b1 = xt::random::randn<double>({hidden_dim});
-        w2 = xt::random::randn<double>({hidden_dim, hidden_dim2});
-        b2 = xt::random::randn<double>({hidden_dim2});
-        wout = xt::random::randn<double>({hidden_dim2, output_dim});
-        bout = xt::random::randn<double>({output_dim});
-        learning_rate = lr;
-    }
-
-    /**
-     * @brief 前向传播
-     *
-     * 根据给定的输入数组 x，执行前向传播计算并返回输出结果。
-     *
-     * @param x 输入数组
-     *
-     * @return 输出结果数组
-     */
-    xt::xarray<double> forward(const xt::xarray<double>& x) {
-        // 前向传播
-        z2 = sigmoid(xt::linalg::dot(x, w1) + b1);
-        z3 = sigmoid(xt::linalg::dot(z2, w2) + b2);
-        out = sigmoid(xt::linalg::dot(z3, wout) + bout);
-
-        return out;
-    }
-
-    /**
-     * @brief 训练函数
-     *
-     * 使用给定的输入和目标进行训练，更新权重和偏置。
-     *
-     * @param x 输入数据
-     * @param t 目标数据
-     */
-    void train(const xt::xarray<double>& x, const xt::xarray<double>& t) {
-        // 训练
-
-        out = forward(x);
-        xt::xarray<double> En = (out - t) * out * (1 - out);
-
-        // 更新输出层权重和偏置
-        wout -= learning_rate * xt::linalg::dot(xt::transpose(z3), En);
-        bout -= learning_rate * xt::sum(En, {0});
-
-        // 计算误差传播到第二层的梯度
-        xt::xarray<double> grad_u2 = xt::linalg::dot(En, xt::transpose(wout)) * z3 * (1 - z3);
-
-        // 更新第二层权重和偏置
-        w2 -= learning_rate * xt::linalg::dot(xt::transpose(z2), grad_u2);
-        b2 -= learning_rate * xt::sum(grad_u2, {0});
-
-        // 计算误差传播到第一层的梯度
-        xt::xarray<double> grad_u1 = xt::linalg::dot(grad_u2, xt::transpose(w2)) * z2 * (1 - z2);
-
-        // 更新第一层权重和偏置
-        w1 -= learning_rate * xt::linalg::dot(xt::transpose(x), grad_u1);
-        b1 -= learning_rate * xt::sum(grad_u1, {0});
-    }
-};
+#include "nn.hpp"
+#include "nn_int8.hpp"
+#include "nn_io.hpp"
 
 /**
  * @brief 打印 xt::xarray<double> 类型的数组
@@ -109,7 +30,8 @@ void print_xarray(const xt::xarray<double>& arr) {
 /**
  * @brief 主函数
  *
- * 主函数用于训练神经网络模型并测试其预测结果。
+ * 主函数用于训练神经网络模型并测试其预测结果，再与 int8 量化推理的结果做比较，
+ * 最后保存模型并通过 mmap 重新加载推理。
  *
  * @return 返回值为0，表示程序正常结束。
  */
@@ -130,5 +52,25 @@ int main() {
     std::cout << "Predictions:" << std::endl;
     std::cout << pred << std::endl;
 
+    // int8 量化推理，用训练数据做校准
+    QuantizedNN qnn(nn.layers(), x.data(), (int)x.shape()[0]);
+    QuantizationReport rep = compare_quantized(nn.layers(), qnn, x_test.data(), t.data(), (int)x_test.shape()[0]);
+    const char* isa;
+    dot_u8s8_select(&isa);
+    std::cout << "int8 (" << isa << ") vs float: max_abs_diff=" << rep.max_abs_diff << " mean_abs_diff=" << rep.mean_abs_diff
+              << " float_acc=" << rep.float_acc << " int8_acc=" << rep.int8_acc << " agreement=" << rep.agreement
+              << std::endl;
+
+    // 保存模型，再通过 mmap 加载推理
+    if (save_nn("nn.model", nn.layers())) {
+        MappedNN mapped;
+        if (mapped.open("nn.model")) {
+            xt::xarray<double> mapped_pred = xt::zeros<double>({x_test.shape()[0], (size_t)1});
+            mapped.forward(x_test.data(), (int)x_test.shape()[0], mapped_pred.data());
+            std::cout << "Predictions (mmap):" << std::endl;
+            std::cout << mapped_pred << std::endl;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <cedar/image.hpp>
 
+#include "histogram.hpp"
+
 // 定义高斯滤波函数
 Mat gaussianBlur(const Mat& src, int kernel_size = 5, double sigma = 1.0) {
     // 对图像进行高斯滤波
@@ -10,11 +12,8 @@ Mat gaussianBlur(const Mat& src, int kernel_size = 5, double sigma = 1.0) {
 
 Mat drawHistogram(const Mat& image) {
     // 计算直方图
-    Mat hist;
-    int histSize = 256;        // 直方图的 bin 数量
-    float range[] = {0, 256};  // 像素值范围
-    const float* histRange = {range};
-    calcHist(&image, 1, nullptr, Mat(), hist, 1, &histSize, &histRange, true, false);
+    Histogram hist(image);
+    int histSize = 256;  // 直方图的 bin 数量
 
     // 创建直方图画布
     int histWidth = 512;
@@ -22,13 +21,17 @@ Mat drawHistogram(const Mat& image) {
     int binWidth = cvRound(static_cast<double>(histWidth) / histSize);
     Mat histImage(histHeight, histWidth, CV_8UC3, Scalar(255, 255, 255));
 
-    // 归一化直方图
-    normalize(hist, hist, 0, histImage.rows, NORM_MINMAX, -1, Mat());
+    // 归一化直方图：最大的 bin 对应画布高度
+    uint64_t maxCount = 1;
+    for (int i = 0; i < histSize; ++i) {
+        maxCount = std::max(maxCount, hist[i]);
+    }
+    auto height = [&](int i) { return cvRound(static_cast<double>(hist[i]) * histImage.rows / maxCount); };
 
     // 绘制直方图
     for (int i = 1; i < histSize; ++i) {
-        line(histImage, Point(binWidth * (i - 1), histHeight - cvRound(hist.at<float>(i - 1))),
-             Point(binWidth * (i), histHeight - cvRound(hist.at<float>(i))), Scalar(0, 0, 0), 2, 8, 0);
+        line(histImage, Point(binWidth * (i - 1), histHeight - height(i - 1)),
+             Point(binWidth * (i), histHeight - height(i)), Scalar(0, 0, 0), 2, 8, 0);
     }
 
     return histImage;
@@ -0,0 +1,35 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "otsu.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+    Mat gray = BGR2GRAY(image);
+
+    // 大津法二值化，与 answer_4 相同
+    int threshold = 0;
+    Mat binary = otsu_binarize(gray, &threshold);
+    std::cout << "threshold:" << threshold << std::endl;
+
+    // 多阈值：分成 4 类
+    std::vector<int> thresholds = otsu_thresholds(Histogram(gray), 4);
+    std::cout << "thresholds:";
+    for (int t : thresholds) {
+        std::cout << " " << t;
+    }
+    std::cout << std::endl;
+    Mat levels = apply_lut(gray, otsu_levels_lut(thresholds));
+
+    // Sauvola 局部阈值，适合光照不均匀的情况
+    SauvolaConfig config;
+    config.window = 15;
+    Mat adaptive = sauvola_binarize(gray, config);
+
+    saveImage("out_levels.jpg", levels);
+    saveImage("out_adaptive.jpg", adaptive);
+    saveImage("out.jpg", binary);
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "pipeline.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 声明处理链：灰度 → 5 × 5 高斯 → 两个方向的 Sobel（answer_41 的前半部分），
+    // 以及灰度 → 二值化 → 开运算（answer_49）
+    Pipeline p;
+    PipelineNode gray = p.gray(p.input());
+    PipelineNode blur = p.convolve(gray, kernel_gaussian(5, 1.4));
+    PipelineNode fx = p.convolve(blur, kernel_sobel(true));
+    PipelineNode fy = p.convolve(blur, kernel_sobel(false));
+    PipelineNode open = p.morphology(p.lut(gray, lut_threshold(128)), MORPHOLOGY_OPEN);
+
+    // 打印融合后的执行计划，再一次遍历计算三个输出，中间结果只存在于行缓冲中
+    std::cout << p.describe(image.channels(), {fx, fy, open});
+    std::vector<Mat> out;
+    p.run(image, {fx, fy, open}, out);
+
+    saveImage("out_fy.jpg", out[1]);
+    saveImage("out_open.jpg", out[2]);
+    saveImage("out.jpg", out[0]);
+
+    return 0;
+}
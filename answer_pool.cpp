@@ -0,0 +1,31 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "pool.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 8 × 8 平均池化、最大池化的马赛克输出，与 answer_7、answer_8 相同
+    PoolConfig config;
+    config.mosaic = true;
+    Mat average = pool(image, config);
+    config.type = POOL_MAX;
+    Mat maximum = pool(image, config);
+
+    // 特征图：3 × 3 窗口、步长 2、填充 1 的最大池化
+    PoolConfig feature;
+    feature.kernel = 3;
+    feature.stride = 2;
+    feature.pad = 1;
+    feature.type = POOL_MAX;
+    Mat downsampled = pool(image, feature);
+    std::cout << "feature map: " << downsampled.cols << "x" << downsampled.rows << std::endl;
+
+    saveImage("out_max.jpg", maximum);
+    saveImage("out_feature.jpg", downsampled);
+    saveImage("out.jpg", average);
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "resize.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 放大：双线性、双三次
+    Mat bilinear = resample(image, Size(image.cols * 3 / 2, image.rows * 3 / 2), RESAMPLE_BILINEAR);
+    Mat bicubic = resample(image, Size(image.cols * 3 / 2, image.rows * 3 / 2), RESAMPLE_BICUBIC);
+
+    // 缩小生成缩略图：采样表只计算一次，可以对同尺寸的多张图片重复使用
+    Resampler thumbnail(image.size(), Size(image.cols / 4, image.rows / 4), image.channels(), RESAMPLE_LANCZOS3);
+    Mat lanczos = thumbnail.apply(image);
+    Mat area = resample(image, Size(image.cols / 4, image.rows / 4), RESAMPLE_AREA);
+
+    saveImage("out_bilinear.jpg", bilinear);
+    saveImage("out_bicubic.jpg", bicubic);
+    saveImage("out_lanczos.jpg", lanczos);
+    saveImage("out.jpg", area);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <cedar/image.hpp>
+#include <cstdlib>
+#include <iostream>
+
+#include "lut.hpp"
+#include "pipeline.hpp"
+#include "stream.hpp"
+
+// 用法：answer_stream [输入.y4m|输入.ppm|-] [输出.y4m|输出.ppm|-] [期限(ms)]
+// 例如：ffmpeg -i in.mp4 -f yuv4mpegpipe - | ./answer_stream - out.y4m 40
+// 不带参数时先用 imori.jpg 生成 30 帧的 imori.y4m 作为输入。
+int main(int argc, char** argv) {
+    std::string input = argc > 1 ? argv[1] : "imori.y4m";
+    std::string output = argc > 2 ? argv[2] : "out.y4m";
+    if (argc <= 1) {
+        Mat image = loadAndCheckImage("imori.jpg");
+        FrameWriter writer;
+        if (!writer.open(input)) {
+            return 1;
+        }
+        Mat frame;
+        for (int i = 0; i < 30; ++i) {
+            apply_lut(image, frame, lut_gamma(1, 0.5 + 0.05 * i));
+            writer.write(frame);
+        }
+    }
+
+    FrameReader reader;
+    FrameWriter writer;
+    if (!reader.open(input) || !writer.open(output, STREAM_AUTO, reader.fps())) {
+        return 1;
+    }
+
+    // 每帧：灰度 → 5 × 5 高斯 → 水平 Sobel（answer_41 的前半部分）
+    Pipeline p;
+    PipelineNode gray = reader.type() == CV_8UC3 ? p.gray(p.input()) : p.input();
+    PipelineNode edge = p.convolve(p.convolve(gray, kernel_gaussian(5, 1.4)), kernel_sobel(true));
+    StreamConfig config;
+    config.deadline_ms = argc > 3 ? std::atof(argv[3]) : 0;
+    StreamStats stats = stream_process(reader, writer, [&](const Mat& in, Mat& out) {
+        std::vector<Mat> outs(1, out);
+        p.run(in, {edge}, outs);
+        out = outs[0];
+    }, config);
+    std::cerr << stats.report();
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <cedar/image.hpp>
+#include <sys/resource.h>
+
+#include <iostream>
+
+#include "tiled.hpp"
+
+// 峰值常驻内存（MB）
+static double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+int main() {
+    // 用 imori.jpg 拼出 4096 × 4096 的大图（48 MB），逐块写入磁盘后换出
+    Mat image = loadAndCheckImage("imori.jpg");
+    const int SIDE = 4096;
+    TiledImage big;
+    if (!big.create("big.tiled", SIDE, SIDE, image.type(), 256)) {
+        return 1;
+    }
+    for (int y = 0; y + image.rows <= SIDE; y += image.rows) {
+        for (int x = 0; x + image.cols <= SIDE; x += image.cols) {
+            big.write(Point(x, y), image);
+        }
+        big.evict(Rect(0, y, SIDE, image.rows));
+    }
+
+    // 高斯滤波、闭运算（halo 由运算决定），再缩小到 1 / 4
+    TiledImage blurred, closed, small;
+    blurred.create("blurred.tiled", SIDE, SIDE, image.type(), 256);
+    closed.create("closed.tiled", SIDE, SIDE, image.type(), 256);
+    small.create("small.tiled", SIDE / 4, SIDE / 4, image.type(), 256);
+    tiled_convolve(big, blurred, kernel_gaussian(5, 1.4));
+    MorphologyConfig close;
+    close.op = MORPHOLOGY_CLOSE;
+    close.iterations = 2;
+    tiled_morphology(blurred, closed, close);
+    tiled_resample(closed, small, RESAMPLE_AREA);
+
+    // 峰值内存由块大小和线程数决定，与图像大小无关
+    std::cout << "image: " << SIDE << "x" << SIDE << " (" << SIDE * SIDE * 3 / (1 << 20) << " MB)" << std::endl;
+    std::cout << "peak rss: " << peak_rss_mb() << " MB" << std::endl;
+
+    Mat corner;
+    small.read(Rect(0, 0, 256, 256), corner);
+    saveImage("out.jpg", corner);
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <cedar/image.hpp>
+#include <iostream>
+
+#include "remap.hpp"
+#include "warp.hpp"
+
+int main() {
+    // 读取图像
+    Mat image = loadAndCheckImage("imori.jpg");
+
+    // 绕图像中心旋转 -30 度，与 answer_30 相同
+    AffineMatrix rotation = affine_rotation(-30, image.cols / 2., image.rows / 2.);
+    Mat nearest = warp_affine(image, rotation, image.size(), WARP_NEAREST);
+    Mat bilinear = warp_affine(image, rotation, image.size(), WARP_BILINEAR);
+    Mat bicubic = warp_affine(image, rotation, image.size(), WARP_BICUBIC);
+
+    // 缩放 + 平移，与 answer_29 相同
+    AffineMatrix scale = {1.3, 0, 0, 0.8, 30, -30};
+    Mat scaled = warp_affine(image, scale, Size((int)(image.cols * 1.3), (int)(image.rows * 0.8)));
+
+    // 透视变换：把图像四角映射到任意四边形
+    cv::Point2f corners[4] = {{0, 0}, {(float)image.cols, 0}, {(float)image.cols, (float)image.rows}, {0, (float)image.rows}};
+    cv::Point2f quad[4] = {{20, 10}, {(float)image.cols - 5, 25}, {(float)image.cols - 15, (float)image.rows - 5}, {5, (float)image.rows - 30}};
+    Homography H = homography_from_points(corners, quad);
+    Mat perspective = warp_perspective(image, H, image.size());
+
+    // 同样的变换处理多帧时，只建一次表
+    RemapTable table = RemapTable::from_homography(H, image.size(), image.size());
+    Mat remapped = table.apply(image);
+
+    // 镜头去畸变
+    LensDistortion lens = {image.cols * 1.0, image.cols * 1.0, image.cols / 2., image.rows / 2., -0.3, 0.1, 0, 0, 0};
+    Mat undistorted = RemapTable::from_distortion(lens, image.size(), image.size()).apply(image);
+
+    saveImage("out_nearest.jpg", nearest);
+    saveImage("out_perspective.jpg", perspective);
+    saveImage("out_remap.jpg", remapped);
+    saveImage("out_undistort.jpg", undistorted);
+    saveImage("out_bicubic.jpg", bicubic);
+    saveImage("out_scaled.jpg", scaled);
+    saveImage("out.jpg", bilinear);
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+// 所有内核的基准测试：answer_N 的原始实现（单线程）与 include/ 中的优化实现
+//
+// 编译：g++ bench/bench_kernels.cpp -O2 -pthread -Iinclude -Ianswer -I/usr/local/include/opencv4 -L/usr/local/lib -lopencv_core -lopencv_highgui -o build/bench
+// 用法：build/bench [--filter=正则] [--sizes=128,512,2048,7680x4320] [--threads=1,2,4,0]
+//                   [--min-time=0.2] [--max-side=N] [--json=结果.json] [--list]
+// threads 中的 0 表示全部核心，不论是否列出 1 都会先运行单线程作为加速比的基准；原始实现默认只在 512 以内的尺寸上运行（--max-side 可以放宽）。
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "answers.hpp"
+#include "benchmark.hpp"
+
+#include "box.hpp"
+#include "clahe.hpp"
+#include "color.hpp"
+#include "convolve.hpp"
+#include "gradient.hpp"
+#include "histogram.hpp"
+#include "hog.hpp"
+#include "hough.hpp"
+#include "image_pool.hpp"
+#include "lut.hpp"
+#include "morphology.hpp"
+#include "nn_int8.hpp"
+#include "nn_kernels.hpp"
+#include "otsu.hpp"
+#include "pipeline.hpp"
+#include "pool.hpp"
+#include "remap.hpp"
+#include "resize.hpp"
+#include "warp.hpp"
+
+namespace {
+
+/**
+ * @brief 输入图像的种类
+ */
+enum BenchInput {
+    INPUT_COLOR,   // CV_8UC3
+    INPUT_GRAY,    // CV_8UC1
+    INPUT_BINARY,  // CV_8UC1，只有 0 和 255
+};
+
+cv::Mat make_input(cv::Size size, BenchInput input) {
+    cv::Mat img = bench_image(size, input == INPUT_COLOR ? CV_8UC3 : CV_8UC1);
+    if (input == INPUT_BINARY) {
+        for (int y = 0; y < img.rows; ++y) {
+            uint8_t* row = img.ptr<uint8_t>(y);
+            for (int x = 0; x < img.cols; ++x) {
+                row[x] = row[x] > 96 ? 255 : 0;
+            }
+        }
+    }
+    return img;
+}
+
+/**
+ * @brief 图像到图像的测试：每次处理的像素数为输入的像素数，数据量为输入 + 输出的字节数
+ */
+BenchCase image_case(const std::string& name, BenchInput input, bool threaded, int max_side,
+                     std::function<cv::Mat(const cv::Mat&)> fn, cv::Size fixed = cv::Size()) {
+    BenchCase c;
+    c.name = name;
+    c.threaded = threaded;
+    c.max_side = max_side;
+    c.fixed = fixed;
+    c.setup = [input, fn](cv::Size size) {
+        cv::Mat img = make_input(size, input);
+        cv::Mat out = fn(img);
+        BenchRun run;
+        run.items = (double)img.total();
+        run.bytes = (double)(img.total() * img.elemSize() + out.total() * out.elemSize());
+        run.fn = [img, fn] { cv::Mat o = fn(img); };
+        return run;
+    };
+    return c;
+}
+
+const int NAIVE_MAX = 512;     // 原始实现的默认尺寸上限
+const cv::Size FIXED_128(128, 128);  // answer_32 ~ 40、44 ~ 46 的固定尺寸
+
+void add_answer_cases(std::vector<BenchCase>& cases) {
+    auto naive = [&](const std::string& name, BenchInput input, std::function<cv::Mat(const cv::Mat&)> fn) {
+        cases.push_back(image_case("answer/" + name, input, false, NAIVE_MAX, fn));
+    };
+    auto fixed = [&](const std::string& name, BenchInput input, std::function<cv::Mat(const cv::Mat&)> fn) {
+        cases.push_back(image_case("answer/" + name, input, false, 0, fn, FIXED_128));
+    };
+
+    naive("01_channel_swap", INPUT_COLOR, [](const cv::Mat& m) { return answer_1::channel_swap(m); });
+    naive("02_bgr2gray", INPUT_COLOR, [](const cv::Mat& m) { return answer_2::BGR2GRAY(m); });
+    naive("03_binarize", INPUT_GRAY, [](const cv::Mat& m) { return answer_3::Binarize(m, 128); });
+    naive("04_otsu", INPUT_GRAY, [](const cv::Mat& m) { return answer_4::Binarize_Otsu(m); });
+    naive("05_inverse_hue", INPUT_COLOR, [](const cv::Mat& m) {
+        return answer_5::HSV2BGR(answer_5::inverse_hue(answer_5::BGR2HSV(m)));
+    });
+    naive("06_decrease_color", INPUT_COLOR, [](const cv::Mat& m) { return answer_6::decrease_color(m); });
+    naive("07_average_pooling", INPUT_COLOR, [](const cv::Mat& m) { return answer_7::average_pooling(m); });
+    naive("08_max_pooling", INPUT_COLOR, [](const cv::Mat& m) { return answer_8::max_pooling(m); });
+    naive("09_gaussian_filter", INPUT_COLOR, [](const cv::Mat& m) { return answer_9::gaussian_filter(m, 1.3, 3); });
+    naive("10_median_filter", INPUT_COLOR, [](const cv::Mat& m) { return answer_10::median_filter(m, 3); });
+    naive("11_mean_filter", INPUT_COLOR, [](const cv::Mat& m) { return answer_11::mean_filter(m, 3); });
+    naive("12_motion_filter", INPUT_COLOR, [](const cv::Mat& m) { return answer_12::motion_filter(m, 3); });
+    naive("13_max_min_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_13::max_min_filter(m, 3); });
+    naive("14_diff_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_14::diff_filter(m, 3, true); });
+    naive("15_sobel_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_15::sobel_filter(m, 3, true); });
+    naive("16_prewitt_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_16::prewitt_filter(m, 3, true); });
+    naive("17_laplacian_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_17::laplacian_filter(m, 3); });
+    naive("18_emboss_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_18::emboss_filter(m, 3); });
+    naive("19_log_filter", INPUT_GRAY, [](const cv::Mat& m) { return answer_19::LoG_filter(m, 5, 3); });
+    naive("21_histogram_normalization", INPUT_COLOR,
+          [](const cv::Mat& m) { return answer_21::histogram_normalization(m, 0, 255); });
+    naive("22_histogram_transform", INPUT_COLOR,
+          [](const cv::Mat& m) { return answer_22::histogram_transform(m, 128, 52); });
+    naive("23_histogram_equalization", INPUT_COLOR,
+          [](const cv::Mat& m) { return answer_23::histogram_equalization(m); });
+    naive("24_gamma_correction", INPUT_COLOR, [](const cv::Mat& m) { return answer_24::gamma_correction(m, 1, 2.2); });
+    naive("25_nearest_neighbor", INPUT_COLOR, [](const cv::Mat& m) { return answer_25::nearest_neighbor(m, 1.5, 1.5); });
+    naive("26_bilinear", INPUT_COLOR, [](const cv::Mat& m) { return answer_26::bilinear(m, 1.5, 1.5); });
+    naive("27_bicubic", INPUT_COLOR, [](const cv::Mat& m) { return answer_27::bicubic(m, 1.5, 1.5); });
+    naive("28_affine_translate", INPUT_COLOR, [](const cv::Mat& m) { return answer_28::affine(m, 1, 0, 0, 1, 30, -30); });
+    naive("29_affine_scale", INPUT_COLOR, [](const cv::Mat& m) { return answer_29::affine(m, 1.3, 0, 0, 0.8, 30, -30); });
+    naive("30_affine_rotate", INPUT_COLOR, [](const cv::Mat& m) { return answer_30::affine(m, 1, 0, 0, 1, 0, 0, -30); });
+    naive("31_affine_skew", INPUT_COLOR, [](const cv::Mat& m) { return answer_31::affine(m, 1, 0, 0, 1, 0, 0, 0, 30, 30); });
+
+    fixed("32_dft_idft", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_32::fourier_str> f(new answer_32::fourier_str());
+        *f = answer_32::dft(answer_32::BGR2GRAY(m), *f);
+        return answer_32::idft(cv::Mat::zeros(128, 128, CV_8UC1), *f);
+    });
+    fixed("33_lpf", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_33::fourier_str> f(new answer_33::fourier_str());
+        *f = answer_33::lpf(answer_33::dft(answer_33::BGR2GRAY(m), *f), 0.5);
+        return answer_33::idft(cv::Mat::zeros(128, 128, CV_8UC1), *f);
+    });
+    fixed("34_hpf", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_34::fourier_str> f(new answer_34::fourier_str());
+        *f = answer_34::hpf(answer_34::dft(answer_34::BGR2GRAY(m), *f), 0.1);
+        return answer_34::idft(cv::Mat::zeros(128, 128, CV_8UC1), *f);
+    });
+    fixed("35_bpf", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_35::fourier_str> f(new answer_35::fourier_str());
+        *f = answer_35::bpf(answer_35::dft(answer_35::BGR2GRAY(m), *f), 0.1, 0.5);
+        return answer_35::idft(cv::Mat::zeros(128, 128, CV_8UC1), *f);
+    });
+    fixed("36_dct_idct", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_36::dct_str> d(new answer_36::dct_str());
+        *d = answer_36::dct(m, *d);
+        return answer_36::idct(cv::Mat::zeros(128, 128, CV_8UC3), *d);
+    });
+    fixed("37_dct_k4", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_37::dct_str> d(new answer_37::dct_str());
+        *d = answer_37::dct(m, *d);
+        return answer_37::idct(cv::Mat::zeros(128, 128, CV_8UC3), *d);
+    });
+    fixed("38_dct_quantize", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_38::dct_str> d(new answer_38::dct_str());
+        *d = answer_38::quantization(answer_38::dct(m, *d));
+        return answer_38::idct(cv::Mat::zeros(128, 128, CV_8UC3), *d);
+    });
+    fixed("39_ycbcr", INPUT_COLOR, [](const cv::Mat& m) {
+        cv::Mat ycbcr = answer_39::process(answer_39::BGR2YCbCr(m, cv::Mat::zeros(128, 128, CV_32FC3)));
+        return answer_39::YCbCr2BGR(ycbcr, cv::Mat::zeros(128, 128, CV_8UC3));
+    });
+    fixed("40_jpeg", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_40::dct_str> d(new answer_40::dct_str());
+        cv::Mat ycbcr = answer_40::BGR2YCbCr(m, cv::Mat::zeros(128, 128, CV_32FC3));
+        *d = answer_40::quantization(answer_40::dct(ycbcr, *d));
+        ycbcr = answer_40::idct(ycbcr, *d);
+        return answer_40::YCbCr2BGR(ycbcr, cv::Mat::zeros(128, 128, CV_8UC3));
+    });
+    naive("41_canny_step1", INPUT_COLOR, [](const cv::Mat& m) {
+        cv::Mat gaussian = answer_41::gaussian_filter(answer_41::BGR2GRAY(m), 1.4, 5);
+        cv::Mat fy = answer_41::sobel_filter(gaussian, 3, false);
+        cv::Mat fx = answer_41::sobel_filter(gaussian, 3, true);
+        answer_41::get_angle(fx, fy);
+        return answer_41::get_edge(fx, fy);
+    });
+    naive("42_canny_step2", INPUT_COLOR, [](const cv::Mat& m) {
+        cv::Mat gaussian = answer_42::gaussian_filter(answer_42::BGR2GRAY(m), 1.4, 5);
+        cv::Mat fy = answer_42::sobel_filter(gaussian, 3, false);
+        cv::Mat fx = answer_42::sobel_filter(gaussian, 3, true);
+        return answer_42::non_maximum_suppression(answer_42::get_angle(fx, fy), answer_42::get_edge(fx, fy));
+    });
+    naive("43_canny", INPUT_COLOR, [](const cv::Mat& m) { return answer_43::Canny(m); });
+    fixed("44_hough_vote", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_44::struct_hough_table> t(new answer_44::struct_hough_table());
+        cv::Mat edge = answer_44::Canny(m);
+        *t = answer_44::Hough_vote(*t, edge);
+        return edge;
+    });
+    fixed("45_hough_nms", INPUT_COLOR, [](const cv::Mat& m) {
+        std::unique_ptr<answer_45::struct_hough_table> t(new answer_45::struct_hough_table());
+        cv::Mat edge = answer_45::Canny(m);
+        *t = answer_45::Hough_NMS(answer_45::Hough_vote(*t, edge));
+        return edge;
+    });
+    fixed("46_hough_line", INPUT_COLOR, [](const cv::Mat& m) { return answer_46::Hough_line(m); });
+    naive("47_erode", INPUT_BINARY, [](const cv::Mat& m) { return answer_47::Morphology_Erode(m, 1); });
+    naive("48_dilate", INPUT_BINARY, [](const cv::Mat& m) { return answer_48::Morphology_Dilate(m, 1); });
+    naive("49_opening", INPUT_BINARY, [](const cv::Mat& m) { return answer_49::Morphology_Opening(m, 1); });
+    naive("50_closing", INPUT_BINARY, [](const cv::Mat& m) { return answer_50::Morphology_Closing(m, 1); });
+}
+
+void add_optimized_cases(std::vector<BenchCase>& cases) {
+    auto opt = [&](const std::string& name, BenchInput input, std::function<cv::Mat(const cv::Mat&)> fn) {
+        cases.push_back(image_case("opt/" + name, input, true, 0, fn));
+    };
+
+    opt("channel_swap", INPUT_COLOR, [](const cv::Mat& m) { return channel_swap(m); });
+    opt("bgr_to_gray", INPUT_COLOR, [](const cv::Mat& m) { return bgr_to_gray(m); });
+    opt("inverse_hue", INPUT_COLOR, [](const cv::Mat& m) { return inverse_hue(m); });
+    opt("lut_gamma", INPUT_COLOR, [](const cv::Mat& m) { return apply_lut(m, lut_gamma(1, 2.2)); });
+    opt("lut_channels", INPUT_COLOR, [](const cv::Mat& m) {
+        return apply_lut(m, ChannelLut(lut_threshold(64), lut_quantize(), lut_gamma(1, 2.2)));
+    });
+    opt("equalize_hist", INPUT_COLOR, [](const cv::Mat& m) { return equalize_hist(m); });
+    opt("clahe", INPUT_COLOR, [](const cv::Mat& m) { return clahe(m); });
+    opt("otsu_binarize", INPUT_GRAY, [](const cv::Mat& m) { return otsu_binarize(m); });
+    opt("sauvola", INPUT_GRAY, [](const cv::Mat& m) { return sauvola_binarize(m); });
+    opt("convolve_gaussian3", INPUT_COLOR, [](const cv::Mat& m) { return convolve(m, kernel_gaussian(3, 1.3)); });
+    opt("convolve_motion3", INPUT_COLOR, [](const cv::Mat& m) { return convolve(m, kernel_motion(3)); });
+    opt("convolve_sobel", INPUT_GRAY, [](const cv::Mat& m) { return convolve(m, kernel_sobel(true)); });
+    opt("convolve_log5", INPUT_GRAY, [](const cv::Mat& m) { return convolve(m, kernel_log(5, 3)); });
+    opt("max_min_filter", INPUT_GRAY, [](const cv::Mat& m) { return max_min_filter(m, 3); });
+    opt("median_filter3", INPUT_COLOR, [](const cv::Mat& m) { return median_filter(m, 3); });
+    opt("gradient_mag_orient", INPUT_GRAY,
+        [](const cv::Mat& m) { return gradient(m, GRAD_MAGNITUDE | GRAD_ORIENTATION).magnitude; });
+    opt("pool_avg_mosaic", INPUT_COLOR, [](const cv::Mat& m) {
+        PoolConfig cfg;
+        cfg.mosaic = true;
+        return pool(m, cfg);
+    });
+    opt("pool_max_mosaic", INPUT_COLOR, [](const cv::Mat& m) {
+        PoolConfig cfg;
+        cfg.mosaic = true;
+        cfg.type = POOL_MAX;
+        return pool(m, cfg);
+    });
+    opt("morphology_dilate", INPUT_BINARY, [](const cv::Mat& m) { return morphology(m); });
+    opt("morphology_open_x4", INPUT_BINARY, [](const cv::Mat& m) {
+        MorphologyConfig cfg;
+        cfg.op = MORPHOLOGY_OPEN;
+        cfg.iterations = 4;
+        return morphology(m, cfg);
+    });
+    // 同一条处理链：逐步生成整幅中间图像与流水线按行融合计算（只取一个输出）
+    opt("chain_canny_front", INPUT_COLOR, [](const cv::Mat& m) {
+        Pipeline p;
+        cv::Mat blur = convolve(p.run(m, p.gray(p.input())), kernel_gaussian(5, 1.4));
+        cv::Mat fy = convolve(blur, kernel_sobel(false));
+        return convolve(blur, kernel_sobel(true));
+    });
+    opt("pipeline_canny_front", INPUT_COLOR, [](const cv::Mat& m) {
+        Pipeline p;
+        PipelineNode blur = p.convolve(p.gray(p.input()), kernel_gaussian(5, 1.4));
+        std::vector<cv::Mat> out;
+        p.run(m, {p.convolve(blur, kernel_sobel(true)), p.convolve(blur, kernel_sobel(false))}, out);
+        return out[0];
+    });
+    opt("canny", INPUT_GRAY, [](const cv::Mat& m) { return canny(m); });
+    // 约 2% 的像素为边缘，接近 canny 的输出
+    opt("hough_line", INPUT_GRAY, [](const cv::Mat& m) {
+        HoughSpace space;
+        hough_vote(apply_lut(m, lut_threshold(250)), space);
+        cv::Mat out = cv::Mat::zeros(m.rows, m.cols, CV_8UC3);
+        hough_draw(out, hough_peaks(space, 30));
+        return out;
+    });
+    // 同一条卷积链：每次新建中间图像与从按帧回收的缓冲池借出（稳定后不再申请内存）
+    opt("chain_gauss_sobel", INPUT_COLOR,
+        [](const cv::Mat& m) { return convolve(convolve(m, kernel_gaussian(5, 1.4)), kernel_sobel(true)); });
+    {
+        auto pool = std::make_shared<ImagePool>();
+        auto gauss = std::make_shared<Convolver>(kernel_gaussian(5, 1.4));
+        auto sobel = std::make_shared<Convolver>(kernel_sobel(true));
+        opt("chain_gauss_sobel_pooled", INPUT_COLOR, [=](const cv::Mat& m) {
+            pool->next_frame();
+            cv::Mat blur = pool->acquire(m.size(), m.type()), out = pool->acquire(m.size(), m.type());
+            gauss->apply(m, blur);
+            sobel->apply(blur, out);
+            return out;
+        });
+    }
+    opt("chain_threshold_open", INPUT_COLOR, [](const cv::Mat& m) {
+        Pipeline p;
+        cv::Mat bin = apply_lut(p.run(m, p.gray(p.input())), lut_threshold(128));
+        MorphologyConfig cfg;
+        cfg.op = MORPHOLOGY_OPEN;
+        return morphology(bin, cfg);
+    });
+    opt("pipeline_threshold_open", INPUT_COLOR, [](const cv::Mat& m) {
+        Pipeline p;
+        return p.run(m, p.morphology(p.lut(p.gray(p.input()), lut_threshold(128)), MORPHOLOGY_OPEN));
+    });
+    opt("resample_bilinear_x1.5", INPUT_COLOR, [](const cv::Mat& m) {
+        return resample(m, cv::Size(m.cols * 3 / 2, m.rows * 3 / 2), RESAMPLE_BILINEAR);
+    });
+    opt("resample_bicubic_x1.5", INPUT_COLOR, [](const cv::Mat& m) {
+        return resample(m, cv::Size(m.cols * 3 / 2, m.rows * 3 / 2), RESAMPLE_BICUBIC);
+    });
+    opt("resample_area_x0.5", INPUT_COLOR,
+        [](const cv::Mat& m) { return resample(m, cv::Size(m.cols / 2, m.rows / 2), RESAMPLE_AREA); });
+    opt("warp_affine_rotate", INPUT_COLOR, [](const cv::Mat& m) {
+        return warp_affine(m, affine_rotation(-30, m.cols / 2.0, m.rows / 2.0), m.size());
+    });
+    opt("warp_perspective", INPUT_COLOR, [](const cv::Mat& m) {
+        cv::Point2f src[4] = {{0, 0}, {(float)m.cols, 0}, {(float)m.cols, (float)m.rows}, {0, (float)m.rows}};
+        cv::Point2f dst[4] = {{m.cols * 0.1f, m.rows * 0.05f},
+                              {m.cols * 0.9f, 0},
+                              {(float)m.cols, (float)m.rows},
+                              {0, m.rows * 0.95f}};
+        return warp_perspective(m, homography_from_points(src, dst), m.size());
+    });
+
+    // HOG 的 cell 直方图（单线程，检测器按金字塔层并行）
+    {
+        BenchCase c;
+        c.name = "opt/hog_cells";
+        c.setup = [](cv::Size size) {
+            cv::Mat gray = make_input(size, INPUT_GRAY);
+            std::shared_ptr<HogCells> cells(new HogCells());
+            BenchRun run;
+            run.items = (double)gray.total();
+            run.bytes = (double)gray.total() + (double)(size.width / HOG_CELL) * (size.height / HOG_CELL) *
+                                                   HOG_BINS * sizeof(float);
+            run.fn = [gray, cells] { hog_cells(gray.data, gray.cols, gray.rows, gray.step, *cells); };
+            return run;
+        };
+        cases.push_back(c);
+    }
+
+    // 非图像的内核：以样本数计（固定规模）
+    // 同一个 36-64-64-1 网络分别用 double 与 int8 计算
+    for (bool int8 : {false, true}) {
+        BenchCase c;
+        c.name = int8 ? "opt/nn_int8_forward" : "opt/nn_mlp_forward";
+        c.fixed = cv::Size(64, 64);  // 4096 个样本
+        c.setup = [int8](cv::Size size) {
+            int rows = size.area(), dims[4] = {36, 64, 64, 1};
+            std::mt19937 rng(1);
+            std::normal_distribution<double> normal;
+            auto weights = std::make_shared<std::vector<std::vector<double>>>();
+            auto layers = std::make_shared<std::vector<DenseLayerView>>();
+            for (int l = 0; l < 3; ++l) {
+                std::vector<double> w((size_t)dims[l] * dims[l + 1]), b(dims[l + 1]);
+                for (double& v : w) v = normal(rng) * 0.3;
+                for (double& v : b) v = normal(rng) * 0.1;
+                weights->push_back(w);
+                weights->push_back(b);
+            }
+            for (int l = 0; l < 3; ++l) {
+                layers->push_back({dims[l], dims[l + 1], (*weights)[l * 2].data(), (*weights)[l * 2 + 1].data()});
+            }
+            auto x = std::make_shared<std::vector<double>>((size_t)rows * dims[0]);
+            for (double& v : *x) v = normal(rng);
+            auto qnn = std::make_shared<QuantizedNN>(*layers, x->data(), std::min(rows, 256));
+            auto buf = std::make_shared<std::vector<double>>(rows);
+            auto a = std::make_shared<std::vector<double>>(), b = std::make_shared<std::vector<double>>();
+            BenchRun run;
+            run.items = rows;
+            run.bytes = (double)rows * (dims[0] + 1) * sizeof(double);
+            if (int8) {
+                run.fn = [=] { qnn->forward(x->data(), rows, buf->data()); };
+            } else {
+                run.fn = [=] { mlp_forward(*layers, x->data(), rows, buf->data(), *a, *b); };
+            }
+            return run;
+        };
+        cases.push_back(c);
+    }
+    {
+        BenchCase c;
+        c.name = "opt/iou_box";
+        c.fixed = cv::Size(256, 256);  // 65536 对
+        c.setup = [](cv::Size size) {
+            int n = size.area();
+            std::mt19937 rng(2);
+            std::uniform_real_distribution<double> u(0, 100);
+            auto boxes = std::make_shared<std::vector<Box>>();
+            for (int i = 0; i < n + 1; ++i) {
+                double x = u(rng), y = u(rng);
+                boxes->push_back({x, y, x + u(rng) / 2, y + u(rng) / 2});
+            }
+            auto sink = std::make_shared<double>(0);
+            BenchRun run;
+            run.items = n;
+            run.bytes = (double)n * sizeof(Box);
+            run.fn = [=] {
+                double s = 0;
+                for (int i = 0; i < n; ++i) {
+                    s += iou_box((*boxes)[i], (*boxes)[i + 1]);
+                }
+                *sink = s;
+            };
+            return run;
+        };
+        cases.push_back(c);
+    }
+}
+
+std::vector<cv::Size> parse_sizes(const std::string& s) {
+    std::vector<cv::Size> sizes;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t end = s.find(',', pos);
+        std::string item = s.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        int w = 0, h = 0;
+        if (std::sscanf(item.c_str(), "%dx%d", &w, &h) == 2 || std::sscanf(item.c_str(), "%d", &w) == 1) {
+            sizes.push_back(cv::Size(w, h > 0 ? h : w));
+        }
+        pos = end == std::string::npos ? s.size() : end + 1;
+    }
+    return sizes;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    std::string json;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* key) -> const char* {
+            size_t n = std::strlen(key);
+            return arg.compare(0, n, key) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (const char* v = value("--filter=")) {
+            opt.filter = v;
+        } else if (const char* v = value("--sizes=")) {
+            opt.sizes = parse_sizes(v);
+        } else if (const char* v = value("--threads=")) {
+            opt.threads.clear();
+            for (cv::Size s : parse_sizes(v)) {
+                opt.threads.push_back(s.width);
+            }
+        } else if (const char* v = value("--min-time=")) {
+            opt.min_time = std::atof(v);
+        } else if (const char* v = value("--max-side=")) {
+            opt.max_side = std::atoi(v);
+        } else if (const char* v = value("--json=")) {
+            json = v;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchCase> cases;
+    add_answer_cases(cases);
+    add_optimized_cases(cases);
+    if (list) {
+        for (const BenchCase& c : cases) {
+            std::cout << c.name << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<BenchResult> results = bench_run(cases, opt);
+    if (!json.empty() && !bench_write_json(json, results, argv[0])) {
+        std::cerr << "cannot write " << json << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 一次测量的准备结果
+ *
+ * fn 为被计时的部分；items 为每次处理的像素（或样本）数，
+ * bytes 为每次读写的数据量（输入 + 输出），用于计算每像素字节数和带宽。
+ */
+struct BenchRun {
+    std::function<void()> fn;
+    double items = 0;
+    double bytes = 0;
+};
+
+/**
+ * @brief 一个基准测试
+ *
+ * setup 按给定的尺寸生成输入并返回 BenchRun，生成输入的时间不计入结果。
+ * fixed 非空时只在这个尺寸上运行（answer_32 等固定 128 × 128 的实现，或非图像的内核）。
+ */
+struct BenchCase {
+    std::string name;
+    bool threaded = false;  // 是否使用 parallel_for，只有这样的测试才测量多线程加速比
+    int max_side = 0;       // 尺寸上限（较长边），0 表示不限制
+    cv::Size fixed;
+    std::function<BenchRun(cv::Size)> setup;
+};
+
+/**
+ * @brief 一条结果
+ */
+struct BenchResult {
+    std::string name;
+    cv::Size size;
+    int threads = 1;
+    int iterations = 0;
+    double seconds = 0;  // 每次的中位数
+    double items = 0;
+    double bytes = 0;
+    double speedup = 1;  // 相对于单线程
+};
+
+/**
+ * @brief 运行参数
+ */
+struct BenchOptions {
+    std::string filter = ".*";
+    std::vector<cv::Size> sizes = {{128, 128}, {512, 512}, {2048, 2048}, {7680, 4320}};
+    std::vector<int> threads = {1, 0};  // 0 表示全部核心；单线程的基准总是会运行
+    double min_time = 0.2;              // 每个组合至少运行的时间（秒）
+    int min_iterations = 3;
+    int max_side = 0;  // 覆盖各测试的尺寸上限，0 表示使用测试自己的
+};
+
+/**
+ * @brief 生成测试图像：平滑的渐变叠加确定性的噪声，避免分支预测和直方图过于理想
+ */
+inline cv::Mat bench_image(cv::Size size, int type) {
+    cv::Mat img(size.height, size.width, type);
+    int cn = img.channels();
+    uint32_t state = 0x9E3779B9u;
+    for (int y = 0; y < size.height; ++y) {
+        uint8_t* row = img.ptr<uint8_t>(y);
+        for (int x = 0; x < size.width * cn; ++x) {
+            state = state * 1664525u + 1013904223u;
+            int base = (x / cn) * 255 / std::max(1, size.width - 1) / 2 + y * 255 / std::max(1, size.height - 1) / 2;
+            row[x] = (uint8_t)std::min(255, base * 3 / 4 + (int)(state >> 27) * 2);
+        }
+    }
+    return img;
+}
+
+/**
+ * @brief 按最少时间和最少次数重复运行，返回每次耗时的中位数
+ */
+inline double bench_measure(const std::function<void()>& fn, double min_time, int min_iterations, int* iterations) {
+    typedef std::chrono::steady_clock Clock;
+    fn();  // 预热
+    std::vector<double> times;
+    double total = 0;
+    while ((int)times.size() < min_iterations || total < min_time) {
+        Clock::time_point t0 = Clock::now();
+        fn();
+        double t = std::chrono::duration<double>(Clock::now() - t0).count();
+        times.push_back(t);
+        total += t;
+    }
+    *iterations = (int)times.size();
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+/**
+ * @brief 运行所有匹配的测试，逐条输出到终端
+ */
+inline std::vector<BenchResult> bench_run(const std::vector<BenchCase>& cases, const BenchOptions& opt) {
+    std::regex filter(opt.filter);
+    std::vector<BenchResult> results;
+    int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%-36s %11s %7s %6s %12s %10s %8s %8s\n", "benchmark", "size", "threads", "iters", "time(ms)",
+                "MP/s", "B/px", "speedup");
+    for (const BenchCase& c : cases) {
+        if (!std::regex_search(c.name, filter)) {
+            continue;
+        }
+        std::vector<cv::Size> sizes = c.fixed.area() > 0 ? std::vector<cv::Size>{c.fixed} : opt.sizes;
+        int max_side = opt.max_side > 0 ? opt.max_side : c.max_side;
+        for (cv::Size size : sizes) {
+            if (c.fixed.area() == 0 && max_side > 0 && std::max(size.width, size.height) > max_side) {
+                continue;
+            }
+            BenchRun run = c.setup(size);
+            // 单线程总是最先运行，作为加速比的基准（即使 --threads 中没有 1）
+            std::vector<int> counts = {1};
+            for (int t : c.threaded ? opt.threads : std::vector<int>()) {
+                int threads = t > 0 ? std::min(t, cores) : cores;
+                if (std::find(counts.begin(), counts.end(), threads) == counts.end()) {
+                    counts.push_back(threads);
+                }
+            }
+            double single = 0;
+            for (int threads : counts) {
+                parallel_thread_limit() = threads;
+
+                BenchResult r;
+                r.name = c.name;
+                r.size = size;
+                r.threads = threads;
+                r.items = run.items;
+                r.bytes = run.bytes;
+                r.seconds = bench_measure(run.fn, opt.min_time, opt.min_iterations, &r.iterations);
+                if (threads == 1) {
+                    single = r.seconds;
+                }
+                r.speedup = single / r.seconds;
+                results.push_back(r);
+
+                char dim[32];
+                std::snprintf(dim, sizeof(dim), "%dx%d", size.width, size.height);
+                std::printf("%-36s %11s %7d %6d %12.3f %10.1f %8.2f %8.2f\n", c.name.c_str(), dim, threads,
+                            r.iterations, r.seconds * 1e3, r.items / r.seconds / 1e6, r.bytes / r.items, r.speedup);
+                std::fflush(stdout);
+            }
+            parallel_thread_limit() = 0;
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief 以 JSON 输出结果（字段参照 Google Benchmark 的 --benchmark_format=json）
+ *
+ * @return 是否写入成功
+ */
+inline bool bench_write_json(const std::string& path, const std::vector<BenchResult>& results,
+                             const std::string& executable) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        return false;
+    }
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::fprintf(f, "    \"date\": \"%s\",\n", date);
+    std::fprintf(f, "    \"executable\": \"%s\",\n", executable.c_str());
+    std::fprintf(f, "    \"num_cpus\": %u,\n", std::max(1u, std::thread::hardware_concurrency()));
+#if defined(NDEBUG)
+    std::fprintf(f, "    \"library_build_type\": \"release\"\n");
+#else
+    std::fprintf(f, "    \"library_build_type\": \"debug\"\n");
+#endif
+    std::fprintf(f, "  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(f, "    {\n");
+        std::fprintf(f, "      \"name\": \"%s/%dx%d/threads:%d\",\n", r.name.c_str(), r.size.width, r.size.height,
+                     r.threads);
+        std::fprintf(f, "      \"run_name\": \"%s\",\n", r.name.c_str());
+        std::fprintf(f, "      \"width\": %d,\n      \"height\": %d,\n", r.size.width, r.size.height);
+        std::fprintf(f, "      \"threads\": %d,\n      \"iterations\": %d,\n", r.threads, r.iterations);
+        std::fprintf(f, "      \"real_time\": %.6f,\n      \"time_unit\": \"ms\",\n", r.seconds * 1e3);
+        std::fprintf(f, "      \"items_per_second\": %.1f,\n", r.items / r.seconds);
+        std::fprintf(f, "      \"megapixels_per_second\": %.3f,\n", r.items / r.seconds / 1e6);
+        std::fprintf(f, "      \"bytes_per_second\": %.1f,\n", r.bytes / r.seconds);
+        std::fprintf(f, "      \"bytes_per_pixel\": %.3f,\n", r.bytes / r.items);
+        std::fprintf(f, "      \"speedup\": %.3f,\n", r.speedup);
+        std::fprintf(f, "      \"efficiency\": %.3f\n", r.speedup / r.threads);
+        std::fprintf(f, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+    return true;
+}
@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# 编译 build/libimgproc.a：内核按 SSE2、SSE4.2、AVX2、AVX-512 各编译一份，运行时按 cpuid 选择
+# 用法：./build_lib.sh，之后 compile_and_run.sh 会自动链接该库
+
+set -e
+
+root="$(cd "$(dirname "$0")" && pwd)"
+obj_dir="$root/build/lib"
+library="$root/build/libimgproc.a"
+mkdir -p "$obj_dir"
+
+cxx="${CXX:-g++}"
+# 关闭 FMA 合并，保证各指令集版本的浮点结果逐位一致
+flags="-std=c++17 -g -O2 -pthread -fPIC -ffp-contract=off -I$root/include -I/usr/local/include/opencv4"
+
+compile() {
+    echo "Compiling $2..."
+    $cxx $flags $3 -c "$root/src/$1" -o "$obj_dir/$2"
+}
+
+compile imgproc.cpp imgproc.o ""
+compile imgproc_kernels.cpp kernels_baseline.o "-DIMGPROC_ISA=baseline"
+objects="$obj_dir/imgproc.o $obj_dir/kernels_baseline.o"
+
+case "$(uname -m)" in
+    x86_64 | i?86)
+        compile imgproc_kernels.cpp kernels_sse42.o "-DIMGPROC_ISA=sse42 -msse4.2"
+        compile imgproc_kernels.cpp kernels_avx2.o "-DIMGPROC_ISA=avx2 -mavx2"
+        compile imgproc_kernels.cpp kernels_avx512.o \
+            "-DIMGPROC_ISA=avx512 -mavx2 -mavx512f -mavx512bw -mavx512vl -mavx512vbmi"
+        objects="$objects $obj_dir/kernels_sse42.o $obj_dir/kernels_avx2.o $obj_dir/kernels_avx512.o"
+        ;;
+esac
+
+rm -f "$library"
+ar rcs "$library" $objects
+echo "Built $library"
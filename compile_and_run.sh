@@ -17,7 +17,10 @@ rm -rf output_file
 # 编译源文件
 echo "Compiling $source_file..."
 #g++ "$source_file" -g -o "$output_file" `pkg-config --cflags --libs opencv4`
-g++ "$source_file" -g -O2 -o "$output_file" -I/usr/local/include/opencv4 -L/usr/local/lib -lopencv_core -lopencv_highgui -lopencv_imgcodecs -lopencv_imgproc
+# build_lib.sh 编译过 libimgproc.a 时一起链接（使用 imgproc.hpp 的程序需要）
+library="$(dirname "$0")/build/libimgproc.a"
+[ -f "$library" ] || library=""
+g++ "$source_file" $library -g -O2 -pthread -o "$output_file" -I"$(dirname "$0")/include" -I/usr/local/include/opencv4 -L/usr/local/lib -lopencv_core -lopencv_highgui -lopencv_imgcodecs -lopencv_imgproc
 
 
 # 检查编译是否成功
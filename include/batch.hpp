@@ -0,0 +1,522 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "clahe.hpp"
+#include "convolve.hpp"
+#include "gradient.hpp"
+#include "histogram.hpp"
+#include "hough.hpp"
+#include "lut.hpp"
+#include "mapped_image.hpp"
+#include "morphology.hpp"
+#include "otsu.hpp"
+#include "parallel.hpp"
+#include "pipeline.hpp"
+#include "resize.hpp"
+#include "stream.hpp"
+
+/**
+ * @brief 由文字描述构造的处理链，例如 "gray,gauss:1.3:3,canny:50:20"
+ *
+ * 运算之间用逗号分隔，参数用冒号分隔，省略的参数取默认值（见 usage()）。
+ * 连续的逐行运算（灰度、查表、滤波、形态学）合并成一个 Pipeline 按行融合计算，
+ * 需要整幅图像的运算（Canny、Hough、大津法、均衡化、CLAHE、缩放）单独成为一步。
+ * run() 是 const 的，可以在多个线程上同时处理不同的图像。
+ */
+class OperatorChain {
+   public:
+    /**
+     * @brief 可用的运算及参数说明
+     */
+    static std::string usage() {
+        return "  gray                   BGR 转灰度（answer_2）\n"
+               "  gauss[:sigma[:k]]      高斯滤波，默认 1.4、5\n"
+               "  mean[:k]               均值滤波，默认 3\n"
+               "  sobel[:h|v]            Sobel 滤波，默认 h\n"
+               "  laplacian              拉普拉斯滤波\n"
+               "  threshold[:t]          二值化，默认 128\n"
+               "  gamma[:g]              伽马校正，默认 2.2\n"
+               "  quantize[:n]           减色为 n 级，默认 4\n"
+               "  dilate|erode|open|close[:n]  形态学，重复 n 次，默认 1\n"
+               "  canny[:high[:low]]     Canny（输入灰度图），默认 50、20\n"
+               "  hough[:n]              Hough 直线检测（输入边缘图），票数最多的 n（≥ 2）条画成红线，默认 30\n"
+               "  otsu                   大津法二值化（输入灰度图）\n"
+               "  equalize               直方图均衡化\n"
+               "  clahe[:clip[:tiles]]   CLAHE，默认 2.0、8\n"
+               "  resize:w:h             缩放到 w × h（面积 / 双三次）\n"
+               "  scale:f                按比例缩放\n";
+    }
+
+    /**
+     * @brief 解析处理链，失败时输出错误信息并返回 false
+     */
+    bool parse(const std::string& spec) {
+        stages_.clear();
+        names_.clear();
+        pipeline_.reset();
+        std::stringstream ss(spec);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            std::vector<std::string> args;
+            std::stringstream is(item);
+            std::string arg;
+            while (std::getline(is, arg, ':')) {
+                args.push_back(arg);
+            }
+            if (args.empty() || args[0].empty()) {
+                std::cerr << "处理链中有空的运算: " << spec << std::endl;
+                return false;
+            }
+            std::string name = args[0];
+            args.erase(args.begin());
+            if (!add(name, args)) {
+                std::cerr << "无法解析运算: " << item << "\n可用的运算:\n" << usage();
+                return false;
+            }
+        }
+        flush();
+        if (stages_.empty()) {
+            std::cerr << "处理链为空" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 依次执行各步
+     */
+    cv::Mat run(const cv::Mat& src) const {
+        cv::Mat img = src;
+        for (const auto& stage : stages_) {
+            img = stage(img);
+        }
+        return img;
+    }
+
+    /**
+     * @brief 各步的名字，融合的运算用 + 连接
+     */
+    std::string describe() const {
+        std::string s;
+        for (size_t i = 0; i < names_.size(); ++i) {
+            s += (i ? " -> " : "") + names_[i];
+        }
+        return s;
+    }
+
+   private:
+    std::vector<std::function<cv::Mat(const cv::Mat&)>> stages_;
+    std::vector<std::string> names_;
+    // 正在累积的逐行运算
+    std::shared_ptr<Pipeline> pipeline_;
+    PipelineNode node_;
+    std::string fused_;
+
+    // 参数 i 转为数值，缺省时取 def，格式错误时返回 false
+    static bool number(const std::vector<std::string>& args, size_t i, double def, double& v) {
+        if (i >= args.size() || args[i].empty()) {
+            v = def;
+            return true;
+        }
+        char* end = nullptr;
+        v = std::strtod(args[i].c_str(), &end);
+        return *end == '\0';
+    }
+
+    // 逐行运算：接到当前的 Pipeline 上
+    PipelineNode& stream(const std::string& name) {
+        if (!pipeline_) {
+            pipeline_ = std::make_shared<Pipeline>();
+            node_ = pipeline_->input();
+            fused_.clear();
+        }
+        fused_ += (fused_.empty() ? "" : "+") + name;
+        return node_;
+    }
+
+    // 整幅图像的运算：先结束当前的 Pipeline
+    void whole(const std::string& name, std::function<cv::Mat(const cv::Mat&)> fn) {
+        flush();
+        stages_.push_back(std::move(fn));
+        names_.push_back(name);
+    }
+
+    void flush() {
+        if (!pipeline_) {
+            return;
+        }
+        std::shared_ptr<Pipeline> p = pipeline_;
+        PipelineNode out = node_;
+        stages_.push_back([p, out](const cv::Mat& m) { return p->run(m, out); });
+        names_.push_back(fused_);
+        pipeline_.reset();
+    }
+
+    bool add(const std::string& name, const std::vector<std::string>& args) {
+        double a = 0, b = 0;
+        if (name == "gray" && args.empty()) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->gray(n);
+        } else if (name == "gauss" && args.size() <= 2 && number(args, 0, 1.4, a) && number(args, 1, 5, b) &&
+                   a > 0 && b >= 1 && (int)b % 2 == 1) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->convolve(n, kernel_gaussian((int)b, a));
+        } else if (name == "mean" && args.size() <= 1 && number(args, 0, 3, a) && a >= 1 && (int)a % 2 == 1) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->convolve(n, kernel_mean((int)a));
+        } else if (name == "sobel" && args.size() <= 1 && (args.empty() || args[0] == "h" || args[0] == "v")) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->convolve(n, kernel_sobel(args.empty() || args[0] == "h"));
+        } else if (name == "laplacian" && args.empty()) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->convolve(n, kernel_laplacian());
+        } else if (name == "threshold" && args.size() <= 1 && number(args, 0, 128, a)) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->lut(n, lut_threshold((int)a));
+        } else if (name == "gamma" && args.size() <= 1 && number(args, 0, 2.2, a) && a > 0) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->lut(n, lut_gamma(1, a));
+        } else if (name == "quantize" && args.size() <= 1 && number(args, 0, 4, a) && a >= 1) {
+            PipelineNode& n = stream(name);
+            n = pipeline_->lut(n, lut_quantize((int)a));
+        } else if ((name == "dilate" || name == "erode" || name == "open" || name == "close") && args.size() <= 1 &&
+                   number(args, 0, 1, a) && a >= 1) {
+            MorphologyOp op = name == "dilate"  ? MORPHOLOGY_DILATE
+                              : name == "erode" ? MORPHOLOGY_ERODE
+                              : name == "open"  ? MORPHOLOGY_OPEN
+                                                : MORPHOLOGY_CLOSE;
+            PipelineNode& n = stream(name);
+            n = pipeline_->morphology(n, op, (int)a);
+        } else if (name == "canny" && args.size() <= 2 && number(args, 0, 50, a) && number(args, 1, 20, b)) {
+            int high = (int)a, low = (int)b;
+            whole(name, [high, low](const cv::Mat& m) { return canny(m, high, low); });
+        } else if (name == "hough" && args.size() <= 1 && number(args, 0, 30, a) && a >= 2) {
+            // 与 answer_46 相同：投票、非极大值抑制，画在输入（转为 BGR）的拷贝上
+            int n = (int)a;
+            whole(name, [n](const cv::Mat& m) {
+                HoughSpace space;
+                hough_vote(m, space);
+                cv::Mat out(m.rows, m.cols, CV_8UC3);
+                for (int y = 0; y < m.rows; ++y) {
+                    const uint8_t* src = m.ptr<uint8_t>(y);
+                    uint8_t* dst = out.ptr<uint8_t>(y);
+                    for (int x = 0; x < m.cols; ++x) {
+                        dst[3 * x] = dst[3 * x + 1] = dst[3 * x + 2] = src[x];
+                    }
+                }
+                hough_draw(out, hough_peaks(space, n));
+                return out;
+            });
+        } else if (name == "otsu" && args.empty()) {
+            whole(name, [](const cv::Mat& m) { return otsu_binarize(m); });
+        } else if (name == "equalize" && args.empty()) {
+            whole(name, [](const cv::Mat& m) { return equalize_hist(m); });
+        } else if (name == "clahe" && args.size() <= 2 && number(args, 0, 2.0, a) && number(args, 1, 8, b) && b >= 1) {
+            ClaheConfig cfg;
+            cfg.clip_limit = a;
+            cfg.tiles_x = cfg.tiles_y = (int)b;
+            whole(name, [cfg](const cv::Mat& m) { return clahe(m, cfg); });
+        } else if (name == "resize" && args.size() == 2 && number(args, 0, 0, a) && number(args, 1, 0, b) && a >= 1 &&
+                   b >= 1) {
+            cv::Size size((int)a, (int)b);
+            whole(name, [size](const cv::Mat& m) {
+                bool shrink = size.width < m.cols && size.height < m.rows;
+                return resample(m, size, shrink ? RESAMPLE_AREA : RESAMPLE_BICUBIC);
+            });
+        } else if (name == "scale" && args.size() == 1 && number(args, 0, 0, a) && a > 0) {
+            whole(name, [a](const cv::Mat& m) {
+                cv::Size size(std::max((int)std::lround(m.cols * a), 1), std::max((int)std::lround(m.rows * a), 1));
+                return resample(m, size, a < 1 ? RESAMPLE_AREA : RESAMPLE_BICUBIC);
+            });
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 批处理的参数
+ */
+struct BatchConfig {
+    std::string output_dir = "out";  // 输出目录（不存在时创建）
+    std::string format;              // 输出的扩展名（png、jpg、cimg、ppm ...），为空时与输入相同
+    int workers = 0;                 // 同时处理的文件数，0 为线程数
+    int prefetch = 8;                // 预读的文件数上限（已读入、还没有处理线程取走），不含正在处理的文件
+};
+
+/**
+ * @brief 批处理的统计
+ */
+struct BatchStats {
+    StreamStageStats read, decode, process, encode;  // read 在预读线程上，其余在处理线程上
+    int files = 0;                                   // 成功处理的文件数
+    int failed = 0;                                  // 读入、处理或写出失败的文件数
+    double megapixels = 0;                           // 输入的总像素数（百万）
+    double elapsed_ms = 0;                           // 总耗时
+
+    /**
+     * @brief 每个阶段一行的文字报告，最后一行为吞吐量
+     */
+    std::string report() const {
+        std::string s;
+        char buf[128];
+        const struct {
+            const char* name;
+            const StreamStageStats& st;
+        } stages[] = {{"read", read}, {"decode", decode}, {"process", process}, {"encode", encode}};
+        for (const auto& st : stages) {
+            std::snprintf(buf, sizeof(buf), "%-8s %6d files  mean %8.3f ms  max %8.3f ms\n", st.name, st.st.frames,
+                          st.st.mean_ms(), st.st.max_ms);
+            s += buf;
+        }
+        double sec = elapsed_ms / 1000;
+        std::snprintf(buf, sizeof(buf), "%d files, %d failed, %.1f s, %.1f files/s, %.2f MP/s\n", files, failed, sec,
+                      sec > 0 ? files / sec : 0.0, sec > 0 ? megapixels / sec : 0.0);
+        return s + buf;
+    }
+};
+
+/**
+ * @brief 可以零拷贝映射的格式（.cimg、.ppm、.pgm），不经过 imdecode
+ */
+inline bool batch_mapped_format(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".cimg" || ext == ".ppm" || ext == ".pgm";
+}
+
+/**
+ * @brief 展开输入：目录取其中的图像文件（不递归，按文件名排序），.txt / .lst 每行一个路径，其余作为图像文件
+ *
+ * @return 成功返回 true，路径不存在时输出错误信息并返回 false
+ */
+inline bool batch_inputs(const std::string& path, std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        std::vector<std::string> found;
+        for (const fs::directory_entry& e : fs::directory_iterator(path, ec)) {
+            std::string ext = e.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (e.is_regular_file(ec) && (batch_mapped_format(e.path().string()) || ext == ".jpg" || ext == ".jpeg" ||
+                                          ext == ".png" || ext == ".bmp" || ext == ".tif" || ext == ".tiff")) {
+                found.push_back(e.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+        return true;
+    }
+    if (!fs::is_regular_file(path, ec)) {
+        std::cerr << "输入不存在: " << path << std::endl;
+        return false;
+    }
+    std::string ext = fs::path(path).extension().string();
+    if (ext == ".txt" || ext == ".lst") {
+        std::ifstream list(path);
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line[0] != '#') {
+                files.push_back(line);
+            }
+        }
+        return true;
+    }
+    files.push_back(path);
+    return true;
+}
+
+/**
+ * @brief 按扩展名保存：.cimg 用 save_mapped_image，.ppm / .pgm 用 save_pnm，其余用 cv::imwrite
+ */
+inline bool batch_save(const std::string& path, const cv::Mat& img) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".cimg") {
+        return save_mapped_image(path, img);
+    }
+    if (ext == ".ppm" || ext == ".pgm") {
+        return save_pnm(path, img);
+    }
+    return cv::imwrite(path, img);
+}
+
+/**
+ * @brief 用处理链并行处理一批文件
+ *
+ * 一个预读线程按顺序读入文件（编码的图像读入字节，.cimg / PNM 直接映射），放进预读槽；
+ * cfg.workers 个处理线程各取一个文件，解码、执行处理链、写出。映射的文件在写出之前一直被使用，
+ * 处理线程要占用槽直到写出完成，所以槽共有 cfg.prefetch + workers 个：所有处理线程都在工作时，
+ * 最多还有 cfg.prefetch 个文件已读入、等待处理，内存占用与文件总数无关。
+ * 处理链内部的并行照常使用线程池（嵌套）。单个文件失败时输出错误信息并计入 failed，不影响其他文件。
+ * 输出文件名为输入的文件名（不含目录），扩展名按 cfg.format 替换；不同目录下的同名文件会写到同一个输出，
+ * 除第一个以外都不处理，作为失败计入 failed。
+ *
+ * @param files 输入文件
+ * @param chain 处理链
+ * @param cfg 参数
+ */
+inline BatchStats batch_process(const std::vector<std::string>& files, const OperatorChain& chain,
+                                const BatchConfig& cfg = BatchConfig()) {
+    typedef std::chrono::steady_clock Clock;
+    auto since = [](Clock::time_point t) { return std::chrono::duration<double, std::milli>(Clock::now() - t).count(); };
+    CV_Assert(cfg.prefetch >= 1);
+    namespace fs = std::filesystem;
+    BatchStats stats;
+    std::error_code ec;
+    fs::create_directories(cfg.output_dir, ec);
+
+    // 输出路径：与前面的文件重名时为空
+    std::vector<std::string> outputs(files.size());
+    std::map<std::string, int> owners;
+    for (int i = 0; i < (int)files.size(); ++i) {
+        fs::path name = fs::path(files[i]).filename();
+        if (!cfg.format.empty()) {
+            name.replace_extension("." + cfg.format);
+        }
+        std::string out = (fs::path(cfg.output_dir) / name).string();
+        auto inserted = owners.emplace(out, i);
+        if (inserted.second) {
+            outputs[i] = out;
+        } else {
+            std::cerr << "输出文件重名: " << files[i] << " 与 " << files[inserted.first->second] << " 都写到 " << out
+                      << std::endl;
+        }
+    }
+
+    // 预读槽：编码的字节或映射，在两个队列之间循环
+    struct Slot {
+        int file = -1;
+        bool ok = false;
+        std::vector<uchar> bytes;
+        MappedImage mapped;
+    };
+    int n = std::max(1, std::min(cfg.workers > 0 ? cfg.workers : parallel_threads(), (int)files.size()));
+    int capacity = cfg.prefetch + n;
+    std::vector<Slot> slots(capacity);
+    StreamQueue free_slots(capacity), ready(capacity);
+    for (int s = 0; s < capacity; ++s) {
+        free_slots.push(s);
+    }
+    std::mutex mutex;  // 保护 stats
+    Clock::time_point start = Clock::now();
+
+    std::thread reader([&] {
+        int s;
+        for (int i = 0; i < (int)files.size() && free_slots.pop(s); ++i) {
+            Clock::time_point t = Clock::now();
+            Slot& slot = slots[s];
+            slot.file = i;
+            if (outputs[i].empty()) {
+                // 输出重名，不读入，由处理线程计入 failed
+                slot.ok = false;
+                ready.push(s);
+                continue;
+            }
+            if (batch_mapped_format(files[i])) {
+                slot.ok = slot.mapped.open(files[i]);
+            } else {
+                std::ifstream in(files[i], std::ios::binary);
+                slot.bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                slot.ok = in.good() || in.eof();
+                if (!slot.ok || slot.bytes.empty()) {
+                    std::cerr << "无法读取: " << files[i] << std::endl;
+                    slot.ok = false;
+                }
+            }
+            double ms = since(t);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.read.add(ms);
+            }
+            ready.push(s);
+        }
+        ready.close();
+    });
+
+    auto worker = [&] {
+        int s;
+        while (ready.pop(s)) {
+            Slot& slot = slots[s];
+            const std::string& path = files[slot.file];
+            StreamStageStats decode, process, encode;
+            bool ok = slot.ok;
+            double mp = 0;
+            try {
+                if (ok) {
+                    Clock::time_point t = Clock::now();
+                    cv::Mat img = batch_mapped_format(path) ? slot.mapped.bgr() : cv::imdecode(slot.bytes, cv::IMREAD_COLOR);
+                    decode.add(since(t));
+                    if (img.empty()) {
+                        std::cerr << "无法解码: " << path << std::endl;
+                        ok = false;
+                    } else {
+                        mp = img.rows * (double)img.cols / 1e6;
+                        t = Clock::now();
+                        cv::Mat out = chain.run(img);
+                        process.add(since(t));
+
+                        t = Clock::now();
+                        ok = batch_save(outputs[slot.file], out);
+                        encode.add(since(t));
+                        if (!ok) {
+                            std::cerr << "无法写入: " << outputs[slot.file] << std::endl;
+                        }
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "处理失败: " << path << ": " << e.what() << std::endl;
+                ok = false;
+            }
+            slot.mapped.close();
+            slot.bytes.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (decode.frames) {
+                    stats.decode.add(decode.total_ms);
+                }
+                if (process.frames) {
+                    stats.process.add(process.total_ms);
+                }
+                if (encode.frames) {
+                    stats.encode.add(encode.total_ms);
+                }
+                (ok ? stats.files : stats.failed) += 1;
+                stats.megapixels += ok ? mp : 0;
+            }
+            free_slots.push(s);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < n; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    reader.join();
+    stats.elapsed_ms = since(start);
+    return stats;
+}
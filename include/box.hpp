@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+
+/**
+ * @brief 矩形框 [x1, y1, x2, y2]
+ */
+struct Box {
+    double x1, y1, x2, y2;
+};
+
+/**
+ * @brief 计算两个矩形的 IoU 值
+ *
+ * 与 answer_ml.cpp 中的 iou 相同，但直接使用 Box，不需要构造 xarray。
+ *
+ * @param a 矩形 a
+ * @param b 矩形 b
+ *
+ * @return 两个矩形的 IoU 值
+ */
+inline double iou_box(const Box& a, const Box& b) {
+    double area_a = (a.x2 - a.x1) * (a.y2 - a.y1);
+    double area_b = (b.x2 - b.x1) * (b.y2 - b.y1);
+
+    double iou_w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    double iou_h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    if (iou_w < 0 || iou_h < 0) {
+        return 0.0;
+    }
+
+    double area_iou = iou_w * iou_h;
+    return area_iou / (area_a + area_b - area_iou);
+}
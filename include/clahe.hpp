@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "histogram.hpp"
+#include "parallel.hpp"
+
+/**
+ * @brief CLAHE 的处理方式
+ */
+enum ClaheMode {
+    CLAHE_PER_CHANNEL,  // 每个通道分别均衡化
+    CLAHE_LUMINANCE,    // 只均衡化亮度，色度不变
+};
+
+/**
+ * @brief CLAHE 参数
+ */
+struct ClaheConfig {
+    int tiles_x = 8;                   // 水平方向的块数
+    int tiles_y = 8;                   // 垂直方向的块数
+    double clip_limit = 2.0;           // 每个 bin 的上限（相对于平均计数），<= 0 时不截断
+    ClaheMode mode = CLAHE_LUMINANCE;  // 多通道图像的处理方式
+};
+
+/**
+ * @brief 计算每个块截断后的均衡化查找表
+ *
+ * 块 (i, j) 覆盖 [w * i / tiles_x, w * (i + 1) / tiles_x) × [h * j / tiles_y, h * (j + 1) / tiles_y)。
+ * 超过上限的计数平均分回所有 bin，余数按等间隔分配。各块在不同线程上计算。
+ *
+ * @param src 数据起始地址
+ * @param stride 行跨度（字节）
+ * @param step 相邻像素的间隔（通道数）
+ * @param w 宽
+ * @param h 高
+ * @param cfg 参数
+ * @param luts 输出，tiles_y × tiles_x 个 256 项查找表
+ */
+inline void clahe_tile_luts(const uint8_t* src, size_t stride, int step, int w, int h, const ClaheConfig& cfg,
+                            uint8_t* luts) {
+    int tx = cfg.tiles_x, ty = cfg.tiles_y;
+    parallel_for(0, tx * ty, [&](int t) {
+        int i = t % tx, j = t / tx;
+        int x0 = (int)((int64_t)w * i / tx), x1 = (int)((int64_t)w * (i + 1) / tx);
+        int y0 = (int)((int64_t)h * j / ty), y1 = (int)((int64_t)h * (j + 1) / ty);
+        int area = (x1 - x0) * (y1 - y0);
+
+        uint32_t bank[HIST_BANKS][256];
+        std::memset(bank, 0, sizeof(bank));
+        for (int y = y0; y < y1; ++y) {
+            histogram_count_u8(src + (size_t)y * stride + (size_t)x0 * step, x1 - x0, step, bank);
+        }
+        int hist[256];
+        for (int v = 0; v < 256; ++v) {
+            hist[v] = (int)(bank[0][v] + bank[1][v] + bank[2][v] + bank[3][v]);
+        }
+
+        if (cfg.clip_limit > 0) {
+            int limit = std::max(1, (int)(cfg.clip_limit * area / 256));
+            int excess = 0;
+            for (int v = 0; v < 256; ++v) {
+                if (hist[v] > limit) {
+                    excess += hist[v] - limit;
+                    hist[v] = limit;
+                }
+            }
+            int spread = excess / 256, residual = excess % 256;
+            for (int v = 0; v < 256; ++v) {
+                hist[v] += spread;
+            }
+            if (residual > 0) {
+                int interval = std::max(256 / residual, 1);
+                for (int v = 0; v < 256 && residual > 0; v += interval, --residual) {
+                    ++hist[v];
+                }
+            }
+        }
+
+        uint8_t* lut = luts + (size_t)t * 256;
+        float scale = 255.f / area;
+        int sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += hist[v];
+            lut[v] = (uint8_t)std::min(255, (int)(sum * scale + 0.5f));
+        }
+    });
+}
+
+/**
+ * @brief 用相邻 4 个块的查找表做双线性插值，得到输出
+ *
+ * 每一行先把上下两排块的查找表按垂直权重混合成一排 Q7 的 int16 表，
+ * 每个像素只需再在左右两张表中各查一次，水平混合用 SSE2 的 pmaddwd 一次处理 8 个像素。
+ * 权重都是 7 bit 定点数，结果为 Q14。
+ */
+inline void clahe_interpolate(const uint8_t* src, size_t sstride, uint8_t* dst, size_t dstride, int step, int w,
+                              int h, const ClaheConfig& cfg, const uint8_t* luts) {
+    int tx = cfg.tiles_x, ty = cfg.tiles_y;
+
+    // 块中心；相邻两个块中心之间的列共用同一对左右查找表，记为一段
+    auto center = [](int len, int tiles, int i) {
+        return ((int64_t)len * i / tiles + (int64_t)len * (i + 1) / tiles - 1) / 2.0;
+    };
+    struct Segment {
+        int x0, x1, a, b;
+    };
+    std::vector<Segment> segments;
+    std::vector<int32_t> col_w(w);
+    for (int i = -1; i < tx; ++i) {
+        int a = std::max(i, 0), b = std::min(i + 1, tx - 1);
+        int x0 = i < 0 ? 0 : (int)std::ceil(center(w, tx, i));
+        int x1 = i + 1 >= tx ? w : (int)std::ceil(center(w, tx, i + 1));
+        x1 = std::max(x0, x1);
+        for (int x = x0; x < x1; ++x) {
+            int wx = a == b ? 0 : (int)((x - center(w, tx, a)) / (center(w, tx, b) - center(w, tx, a)) * 128 + 0.5);
+            col_w[x] = (128 - wx) | (wx << 16);
+        }
+        segments.push_back({x0, x1, a * 256, b * 256});
+    }
+
+    parallel_for_rows(h, 0, [&](const ParallelRange& band) {
+        std::vector<int16_t> row(tx * 256);
+        for (int y = band.begin; y < band.end; ++y) {
+            // 上下两排块以及垂直权重
+            int j = 0;
+            while (j + 1 < ty && center(h, ty, j + 1) <= y) {
+                ++j;
+            }
+            double c0 = center(h, ty, j);
+            int k = (y < c0 || j + 1 >= ty) ? j : j + 1;
+            int wy = k == j ? 0 : (int)((y - c0) / (center(h, ty, k) - c0) * 128 + 0.5);
+
+            const uint8_t* top = luts + (size_t)j * tx * 256;
+            const uint8_t* bottom = luts + (size_t)k * tx * 256;
+            for (int i = 0; i < tx * 256; ++i) {
+                row[i] = (int16_t)(top[i] * (128 - wy) + bottom[i] * wy);
+            }
+
+            const uint8_t* s = src + (size_t)y * sstride;
+            uint8_t* d = dst + (size_t)y * dstride;
+            for (const Segment& seg : segments) {
+                const int16_t* ra = row.data() + seg.a;
+                const int16_t* rb = row.data() + seg.b;
+                int x = seg.x0;
+#if defined(__SSE2__)
+                const __m128i round = _mm_set1_epi32(1 << 13);
+                for (; x + 8 <= seg.x1; x += 8) {
+                    alignas(16) int16_t ab[16];
+                    for (int q = 0; q < 8; ++q) {
+                        int v = s[(size_t)(x + q) * step];
+                        ab[2 * q] = ra[v];
+                        ab[2 * q + 1] = rb[v];
+                    }
+                    __m128i lo = _mm_madd_epi16(_mm_load_si128((const __m128i*)ab),
+                                                _mm_loadu_si128((const __m128i*)(col_w.data() + x)));
+                    __m128i hi = _mm_madd_epi16(_mm_load_si128((const __m128i*)(ab + 8)),
+                                                _mm_loadu_si128((const __m128i*)(col_w.data() + x + 4)));
+                    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 14);
+                    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 14);
+                    __m128i v16 = _mm_packs_epi32(lo, hi);
+                    __m128i v8 = _mm_packus_epi16(v16, v16);
+                    if (step == 1) {
+                        _mm_storel_epi64((__m128i*)(d + x), v8);
+                    } else {
+                        alignas(16) uint8_t out[16];
+                        _mm_store_si128((__m128i*)out, v8);
+                        for (int q = 0; q < 8; ++q) {
+                            d[(size_t)(x + q) * step] = out[q];
+                        }
+                    }
+                }
+#endif
+                for (; x < seg.x1; ++x) {
+                    int v = s[(size_t)x * step];
+                    int wx = col_w[x] >> 16;
+                    int value = ra[v] * (128 - wx) + rb[v] * wx;
+                    d[(size_t)x * step] = (uint8_t)((value + (1 << 13)) >> 14);
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief 对单个平面做 CLAHE（可以原地执行）
+ */
+inline void clahe_plane(const uint8_t* src, size_t sstride, uint8_t* dst, size_t dstride, int step, int w, int h,
+                        const ClaheConfig& cfg) {
+    std::vector<uint8_t> luts((size_t)cfg.tiles_x * cfg.tiles_y * 256);
+    clahe_tile_luts(src, sstride, step, w, h, cfg, luts.data());
+    clahe_interpolate(src, sstride, dst, dstride, step, w, h, cfg, luts.data());
+}
+
+/**
+ * @brief 限制对比度的自适应直方图均衡化（CLAHE）
+ *
+ * 图像被划分为 tiles_x × tiles_y 个块，每块的直方图截断后生成各自的均衡化查找表，
+ * 像素值由相邻 4 个块的查找表双线性插值得到，因此块与块之间没有接缝。
+ * 3/4 通道图像在 CLAHE_LUMINANCE 模式下只处理亮度 Y（与 BGR2GRAY 的系数相同），
+ * 再把亮度的变化量加回每个通道，相当于在 YCbCr 空间中保持色度不变。
+ *
+ * @param src CV_8U 图像，1~4 通道
+ * @param dst 输出
+ * @param cfg 参数
+ */
+inline void clahe(const cv::Mat& src, cv::Mat& dst, const ClaheConfig& cfg = ClaheConfig()) {
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4);
+    ClaheConfig c = cfg;
+    c.tiles_x = std::max(1, std::min(c.tiles_x, src.cols));
+    c.tiles_y = std::max(1, std::min(c.tiles_y, src.rows));
+    int cn = src.channels();
+
+    if (cn == 1 || c.mode == CLAHE_PER_CHANNEL) {
+        if (dst.data != src.data) {
+            dst.create(src.rows, src.cols, src.type());
+        }
+        for (int ch = 0; ch < cn; ++ch) {
+            clahe_plane(src.data + ch, src.step, dst.data + ch, dst.step, cn, src.cols, src.rows, c);
+        }
+        return;
+    }
+
+    // 亮度：Y = 0.114 B + 0.587 G + 0.299 R（Q8）
+    cv::Mat luma(src.rows, src.cols, CV_8UC1), equalized(src.rows, src.cols, CV_8UC1);
+    parallel_for_rows(src.rows, 0, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            const uint8_t* s = src.ptr<uint8_t>(y);
+            uint8_t* l = luma.ptr<uint8_t>(y);
+            for (int x = 0; x < src.cols; ++x, s += cn) {
+                l[x] = (uint8_t)((29 * s[0] + 150 * s[1] + 77 * s[2] + 128) >> 8);
+            }
+        }
+    });
+    clahe_plane(luma.data, luma.step, equalized.data, equalized.step, 1, src.cols, src.rows, c);
+
+    if (dst.data != src.data) {
+        dst.create(src.rows, src.cols, src.type());
+    }
+    parallel_for_rows(src.rows, 0, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            const uint8_t* s = src.ptr<uint8_t>(y);
+            const uint8_t* l = luma.ptr<uint8_t>(y);
+            const uint8_t* e = equalized.ptr<uint8_t>(y);
+            uint8_t* d = dst.ptr<uint8_t>(y);
+            for (int x = 0; x < src.cols; ++x, s += cn, d += cn) {
+                int delta = e[x] - l[x];
+                for (int ch = 0; ch < 3; ++ch) {
+                    d[ch] = (uint8_t)std::min(255, std::max(0, s[ch] + delta));
+                }
+                if (cn == 4) {
+                    d[3] = s[3];
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief CLAHE（返回新图像）
+ */
+inline cv::Mat clahe(const cv::Mat& src, const ClaheConfig& cfg = ClaheConfig()) {
+    cv::Mat dst;
+    clahe(src, dst, cfg);
+    return dst;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 一行 BGR 转灰度（与 answer_2 相同：0.2126 R + 0.7152 G + 0.0722 B，向零取整）
+ *
+ * 三个通道的乘积预先存成 double 表，按 answer_2 的顺序相加，结果与逐像素计算逐位一致。
+ * 可以原地执行（dst == src）。
+ */
+inline void bgr_to_gray_row(const uint8_t* src, int width, uint8_t* dst) {
+    struct Tables {
+        double b[256], g[256], r[256];
+        Tables() {
+            for (int v = 0; v < 256; ++v) {
+                b[v] = 0.0722 * (float)v;
+                g[v] = 0.7152 * (float)v;
+                r[v] = 0.2126 * (float)v;
+            }
+        }
+    };
+    static const Tables t;
+    for (int x = 0; x < width; ++x, src += 3) {
+        dst[x] = (uint8_t)(t.r[src[2]] + t.g[src[1]] + t.b[src[0]]);
+    }
+}
+
+/**
+ * @brief 一行交换 B、R 通道（answer_1），可以原地执行
+ */
+inline void channel_swap_row(const uint8_t* src, int width, uint8_t* dst) {
+    for (int x = 0; x < width; ++x, src += 3, dst += 3) {
+        uint8_t b = src[0], g = src[1], r = src[2];
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+    }
+}
+
+/**
+ * @brief 一行色相反转（answer_5）：BGR -> HSV，H 加 180°，再 HSV -> BGR，可以原地执行
+ *
+ * 按 answer_5 的顺序与精度逐像素计算（HSV 用 float，转回 BGR 时用 double），结果逐位相同。
+ */
+inline void inverse_hue_row(const uint8_t* src, int width, uint8_t* dst) {
+    for (int x = 0; x < width; ++x, src += 3, dst += 3) {
+        float r = (float)src[2] / 255, g = (float)src[1] / 255, b = (float)src[0] / 255;
+        float max = std::fmax(r, std::fmax(g, b)), min = std::fmin(r, std::fmin(g, b));
+        float h = 0;
+        if (max == min) {
+            h = 0;
+        } else if (min == b) {
+            h = 60 * (g - r) / (max - min) + 60;
+        } else if (min == r) {
+            h = 60 * (b - g) / (max - min) + 180;
+        } else {
+            h = 60 * (r - b) / (max - min) + 300;
+        }
+        h = (float)std::fmod((double)(h + 180), 360.0);
+
+        double c = max - min, hh = h / 60;
+        double xc = c * (1 - std::fabs(std::fmod(hh, 2.0) - 1));
+        double rr = max - c, gg = rr, bb = rr;
+        if (hh < 1) {
+            rr += c;
+            gg += xc;
+        } else if (hh < 2) {
+            rr += xc;
+            gg += c;
+        } else if (hh < 3) {
+            gg += c;
+            bb += xc;
+        } else if (hh < 4) {
+            gg += xc;
+            bb += c;
+        } else if (hh < 5) {
+            rr += xc;
+            bb += c;
+        } else if (hh < 6) {
+            rr += c;
+            bb += xc;
+        }
+        dst[0] = (uint8_t)(bb * 255);
+        dst[1] = (uint8_t)(gg * 255);
+        dst[2] = (uint8_t)(rr * 255);
+    }
+}
+
+/**
+ * @brief 对 CV_8UC3 图像逐行执行 row(src, width, dst)，各行并行
+ *
+ * @param src CV_8UC3 图像
+ * @param dst 输出，cn 个通道（已有的同尺寸、同类型的 dst 直接复用）
+ * @param cn 输出通道数
+ */
+template <typename F>
+void color_convert(const cv::Mat& src, cv::Mat& dst, int cn, F row) {
+    CV_Assert(src.type() == CV_8UC3);
+    dst.create(src.rows, src.cols, CV_8UC(cn));
+    parallel_for_rows(src.rows, 0, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            row(src.ptr<uint8_t>(y), src.cols, dst.ptr<uint8_t>(y));
+        }
+    });
+}
+
+/**
+ * @brief BGR 转灰度（answer_2），结果逐位相同
+ */
+inline cv::Mat bgr_to_gray(const cv::Mat& src) {
+    cv::Mat dst;
+    color_convert(src, dst, 1, bgr_to_gray_row);
+    return dst;
+}
+
+/**
+ * @brief 交换 B、R 通道（answer_1）
+ */
+inline cv::Mat channel_swap(const cv::Mat& src) {
+    cv::Mat dst;
+    color_convert(src, dst, 3, channel_swap_row);
+    return dst;
+}
+
+/**
+ * @brief 色相反转（answer_5），结果逐位相同
+ */
+inline cv::Mat inverse_hue(const cv::Mat& src) {
+    cv::Mat dst;
+    color_convert(src, dst, 3, inverse_hue_row);
+    return dst;
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "box.hpp"
+#include "hog.hpp"
+#include "nn_int8.hpp"
+#include "nn_kernels.hpp"
+#include "parallel.hpp"
+#include "resize.hpp"
+
+/**
+ * @brief 检测结果
+ */
+struct Detection {
+    Box box;       // 原图坐标
+    double score;  // 网络输出的分数
+};
+
+/**
+ * @brief 检测器参数
+ */
+struct DetectorConfig {
+    int window = 32;           // 窗口边长（像素），必须与训练样本的 canonical_size 相同
+    int min_object = 48;       // 最小目标边长（原图像素），决定金字塔的第一层缩放比
+    double scale_step = 1.25;  // 金字塔相邻两层的缩放比
+    int stride_cells = 1;      // 窗口滑动步长（cell）
+    double min_energy = 2.0;   // 窗口内平均梯度幅值低于该值时直接拒绝（平坦区域）
+    double reject_th = 0.2;    // int8 第一级分数低于该值时拒绝
+    double score_th = 0.5;     // 最终分数阈值
+    double nms_th = 0.3;       // NMS 的 IoU 阈值
+    int batch = 64;            // 送入网络的 batch 大小
+    int tile_rows = 4;         // 每个并行 tile 包含的窗口行数
+};
+
+/**
+ * @brief 非极大值抑制
+ *
+ * 按分数从高到低保留检测框，删除与已保留框 IoU 超过阈值的框。
+ *
+ * @param dets 检测结果
+ * @param th IoU 阈值
+ *
+ * @return 保留的检测结果
+ */
+inline std::vector<Detection> nms(std::vector<Detection> dets, double th) {
+    std::sort(dets.begin(), dets.end(), [](const Detection& a, const Detection& b) { return a.score > b.score; });
+
+    std::vector<Detection> keep;
+    for (const Detection& d : dets) {
+        bool suppressed = false;
+        for (const Detection& k : keep) {
+            if (iou_box(d.box, k.box) > th) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) {
+            keep.push_back(d);
+        }
+    }
+    return keep;
+}
+
+/**
+ * @brief 多尺度滑动窗口检测器
+ *
+ * 流程：构建图像金字塔 → 每层计算一次 HOG cell 直方图 → 窗口特征直接从 cell 直方图中取出
+ * → 级联打分 → NMS。级联分三级：
+ *   1. 梯度能量：由 cell 能量的积分图 O(1) 求出窗口平均梯度，平坦区域直接拒绝；
+ *   2. int8 网络（可选）：分数低于 reject_th 的窗口拒绝；
+ *   3. 浮点网络：剩余窗口按 batch 打分，保留不低于 score_th 的窗口。
+ * 每层按若干行窗口切成 tile，所有层的 tile 一起并行处理。
+ */
+class Detector {
+   public:
+    /**
+     * @brief 构造函数
+     *
+     * @param layers 浮点网络各层参数，输入维度必须为 (window / 8)^2 * 9，输出维度为 1
+     * @param config 检测参数
+     * @param first_stage 作为级联第一级的 int8 网络，为空时跳过这一级
+     */
+    Detector(const std::vector<DenseLayerView>& layers, const DetectorConfig& config,
+             const QuantizedNN* first_stage = nullptr)
+        : layers_(layers), config_(config), first_stage_(first_stage) {
+        int n = config.window / HOG_CELL;
+        CV_Assert(layers.front().in_dim == n * n * HOG_BINS && layers.back().out_dim == 1);
+    }
+
+    /**
+     * @brief 检测
+     *
+     * @param img CV_8UC1 或 CV_8UC3 图像
+     *
+     * @return NMS 之后的检测结果
+     */
+    std::vector<Detection> detect(const cv::Mat& img) const {
+        cv::Mat gray = to_gray(img);
+
+        // 金字塔各层的缩放比
+        std::vector<double> scales;
+        for (double s = (double)config_.window / config_.min_object;
+             gray.cols * s >= config_.window && gray.rows * s >= config_.window; s /= config_.scale_step) {
+            scales.push_back(s);
+        }
+
+        // 并行构建各层：缩放、cell 直方图、cell 能量积分图
+        std::vector<Level> levels(scales.size());
+        parallel_for(0, (int)levels.size(), [&](int i) {
+            Level& L = levels[i];
+            L.scale = scales[i];
+            cv::Size size((int)(gray.cols * L.scale), (int)(gray.rows * L.scale));
+            L.gray = Resampler(gray.size(), size, 1, RESAMPLE_BILINEAR).apply(gray);
+            hog_cells(L.gray.data, L.gray.cols, L.gray.rows, L.gray.step, L.cells);
+            build_energy(L);
+        });
+
+        // 切分 tile
+        int wc = config_.window / HOG_CELL;
+        std::vector<Tile> tiles;
+        for (int i = 0; i < (int)levels.size(); ++i) {
+            int win_rows = (levels[i].cells.rows - wc) / config_.stride_cells + 1;
+            for (int r = 0; r < win_rows; r += config_.tile_rows) {
+                tiles.push_back({i, r, std::min(r + config_.tile_rows, win_rows)});
+            }
+        }
+
+        // 并行扫描
+        std::vector<std::vector<Detection>> found(tiles.size());
+        parallel_for(0, (int)tiles.size(), [&](int i) { scan_tile(levels[tiles[i].level], tiles[i], found[i]); });
+
+        std::vector<Detection> dets;
+        for (const std::vector<Detection>& f : found) {
+            dets.insert(dets.end(), f.begin(), f.end());
+        }
+        return nms(dets, config_.nms_th);
+    }
+
+   private:
+    struct Level {
+        double scale;
+        cv::Mat gray;
+        HogCells cells;
+        std::vector<double> energy;  // cell 能量的积分图，(rows + 1) × (cols + 1)
+    };
+
+    struct Tile {
+        int level;
+        int row_begin;  // 窗口行（以 stride_cells 为单位）
+        int row_end;
+    };
+
+    std::vector<DenseLayerView> layers_;
+    DetectorConfig config_;
+    const QuantizedNN* first_stage_;
+
+    static cv::Mat to_gray(const cv::Mat& img) {
+        CV_Assert(img.type() == CV_8UC1 || img.type() == CV_8UC3);
+        if (img.channels() == 1) {
+            return img;
+        }
+
+        cv::Mat gray(img.rows, img.cols, CV_8UC1);
+        for (int y = 0; y < img.rows; ++y) {
+            const uint8_t* s = img.ptr<uint8_t>(y);
+            uint8_t* d = gray.ptr<uint8_t>(y);
+            for (int x = 0; x < img.cols; ++x) {
+                d[x] = (uint8_t)(0.0722f * s[3 * x] + 0.7152f * s[3 * x + 1] + 0.2126f * s[3 * x + 2]);
+            }
+        }
+        return gray;
+    }
+
+    static void build_energy(Level& L) {
+        int rows = L.cells.rows, cols = L.cells.cols;
+        L.energy.assign((size_t)(rows + 1) * (cols + 1), 0.0);
+        for (int y = 0; y < rows; ++y) {
+            double row_sum = 0;
+            for (int x = 0; x < cols; ++x) {
+                const float* h = L.cells.at(y, x);
+                for (int b = 0; b < HOG_BINS; ++b) {
+                    row_sum += h[b];
+                }
+                L.energy[(size_t)(y + 1) * (cols + 1) + x + 1] = L.energy[(size_t)y * (cols + 1) + x + 1] + row_sum;
+            }
+        }
+    }
+
+    void scan_tile(const Level& L, const Tile& tile, std::vector<Detection>& out) const {
+        int wc = config_.window / HOG_CELL;
+        int dim = wc * wc * HOG_BINS;
+        int stride = config_.stride_cells;
+        int win_cols = (L.cells.cols - wc) / stride + 1;
+        int ecols = L.cells.cols + 1;
+        double min_sum = config_.min_energy * config_.window * config_.window;
+
+        std::vector<double> feats((size_t)config_.batch * dim);
+        std::vector<double> scores(config_.batch), s0, s1;
+        std::vector<int> pos(config_.batch);  // 窗口的 cell 坐标，cy * cells.cols + cx
+        QuantizedNN::Scratch scratch;
+        int n = 0;
+
+        // 对已收集的窗口打分
+        auto flush = [&] {
+            if (first_stage_) {
+                first_stage_->forward(feats.data(), n, scores.data(), scratch);
+                int m = 0;
+                for (int i = 0; i < n; ++i) {
+                    if (scores[i] >= config_.reject_th) {
+                        if (m != i) {
+                            std::copy(&feats[(size_t)i * dim], &feats[(size_t)(i + 1) * dim], &feats[(size_t)m * dim]);
+                            pos[m] = pos[i];
+                        }
+                        ++m;
+                    }
+                }
+                n = m;
+            }
+            if (n > 0) {
+                mlp_forward(layers_, feats.data(), n, scores.data(), s0, s1);
+            }
+            for (int i = 0; i < n; ++i) {
+                if (scores[i] >= config_.score_th) {
+                    double x1 = (pos[i] % L.cells.cols) * HOG_CELL / L.scale;
+                    double y1 = (pos[i] / L.cells.cols) * HOG_CELL / L.scale;
+                    double side = config_.window / L.scale;
+                    out.push_back({{x1, y1, x1 + side, y1 + side}, scores[i]});
+                }
+            }
+            n = 0;
+        };
+
+        for (int r = tile.row_begin; r < tile.row_end; ++r) {
+            int cy = r * stride;
+            for (int c = 0; c < win_cols; ++c) {
+                int cx = c * stride;
+
+                // 第一级：梯度能量
+                double e = L.energy[(size_t)(cy + wc) * ecols + cx + wc] - L.energy[(size_t)cy * ecols + cx + wc] -
+                           L.energy[(size_t)(cy + wc) * ecols + cx] + L.energy[(size_t)cy * ecols + cx];
+                if (e < min_sum) {
+                    continue;
+                }
+
+                hog_window(L.cells, cy, cx, wc, wc, &feats[(size_t)n * dim]);
+                pos[n] = cy * L.cells.cols + cx;
+                if (++n == config_.batch) {
+                    flush();
+                }
+            }
+        }
+        if (n > 0) {
+            flush();
+        }
+    }
+};
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 梯度算子的差分方式
+ */
+enum GradientKernel {
+    GRAD_SOBEL,    // 3 × 3 Sobel（answer_15、answer_41）
+    GRAD_CENTRAL,  // 中心差分 [-1, 0, 1]（HOG）
+};
+
+/**
+ * @brief 梯度幅值的范数
+ */
+enum GradientNorm {
+    GRAD_L1,  // |gx| + |gy|
+    GRAD_L2,  // sqrt(gx² + gy²)，四舍五入
+};
+
+/**
+ * @brief 需要输出的结果，可按位组合
+ */
+enum GradientOutput {
+    GRAD_X = 1,
+    GRAD_Y = 2,
+    GRAD_MAGNITUDE = 4,
+    GRAD_ORIENTATION = 8,
+};
+
+/**
+ * @brief 梯度算子的参数
+ *
+ * 方向不区分正负，取 [0, π) 量化为 bins 个区间。
+ * centered 为 true 时区间以 k·π / bins 为中心（Canny：4 个方向 0°、45°、90°、135°），
+ * 否则从 0 开始（HOG：9 个 20° 的区间）。梯度为 0 的像素方向记为 0。
+ */
+struct GradientConfig {
+    GradientKernel kernel = GRAD_SOBEL;
+    GradientNorm norm = GRAD_L2;
+    bool reflect = false;  // 边界：false 为补 0（answer_41），true 为镜像 -1 -> 1（HOG）
+    int bins = 4;
+    bool centered = true;
+};
+
+/**
+ * @brief 梯度算子的输出，未请求的项为空
+ *
+ * gx、gy、magnitude 为 CV_16SC1，orientation 为方向区间编号（CV_8UC1）。
+ * gx = 右 - 左、gy = 下 - 上，与 answer_15 的 Sobel 核符号相反。
+ */
+struct GradientImages {
+    cv::Mat gx, gy, magnitude, orientation;
+};
+
+/**
+ * @brief 一次读入源图像，同时计算 gx、gy、幅值和方向区间
+ *
+ * 中间结果都是 int16，SSE2 一次处理 8 个像素：
+ * - L2 幅值把 (gx, gy) 交错后用 pmaddwd 求平方和，再转 float 开方；
+ * - 方向不调用 atan2：先把梯度翻转到上半平面，再与每条区间边界 φ 的法向量
+ *   (cos φ, -sin φ) 做内积，统计越过的边界数即为区间编号。
+ *   法向量取 Q20，拆成高、低 16 位各做一次 pmaddwd 再合并，在 int32 上精确求值（|g| ≤ 1443），
+ *   只有与边界的夹角小于约 1e-4° 的梯度才可能被分到相邻区间。
+ * 标量版本使用完全相同的整数运算，结果与 SIMD 一致。
+ */
+class GradientOperator {
+   public:
+    explicit GradientOperator(const GradientConfig& config = GradientConfig()) : cfg_(config) {
+        CV_Assert(cfg_.bins >= 1 && cfg_.bins <= 64);
+        // 区间边界：centered 时为 (k + 0.5)·π / bins，k = 0 .. bins - 1；否则为 k·π / bins，k = 1 .. bins - 1
+        for (int k = cfg_.centered ? 0 : 1; k < cfg_.bins; ++k) {
+            double phi = (k + (cfg_.centered ? 0.5 : 0.0)) * M_PI / cfg_.bins;
+            cos_.push_back((int32_t)std::lround(std::cos(phi) * (1 << 20)));
+            sin_.push_back((int32_t)std::lround(std::sin(phi) * (1 << 20)));
+        }
+    }
+
+    const GradientConfig& config() const { return cfg_; }
+
+    /**
+     * @brief 计算一行
+     *
+     * 图像外的行由调用者按边界方式给出（全 0 行或镜像行），行内的左右边界在这里处理。
+     * 不需要的输出传 nullptr。
+     *
+     * @param up 上一行
+     * @param mid 当前行
+     * @param down 下一行
+     * @param width 宽度
+     * @param gx 水平梯度
+     * @param gy 垂直梯度
+     * @param mag 幅值
+     * @param bin 方向区间编号
+     */
+    void row(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width, int16_t* gx, int16_t* gy,
+             int16_t* mag, uint8_t* bin) const {
+        int x = 0;
+        if (width >= 10) {
+            pixel(up, mid, down, width, 0, gx, gy, mag, bin);
+            x = 1;
+#if defined(__SSE2__)
+            for (; x + 9 <= width; x += 8) {
+                simd8(up, mid, down, x, gx, gy, mag, bin);
+            }
+#endif
+        }
+        for (; x < width; ++x) {
+            pixel(up, mid, down, width, x, gx, gy, mag, bin);
+        }
+    }
+
+    /**
+     * @brief 计算整幅图像
+     *
+     * @param gray CV_8UC1 灰度图
+     * @param out 输出，只分配 outputs 中请求的项
+     * @param outputs GradientOutput 的组合
+     */
+    void apply(const cv::Mat& gray, GradientImages& out, int outputs) const {
+        CV_Assert(gray.type() == CV_8UC1);
+        int h = gray.rows, w = gray.cols;
+        auto prepare = [&](cv::Mat& m, int flag, int type) {
+            if (outputs & flag) {
+                m.create(h, w, type);
+            } else {
+                m.release();
+            }
+        };
+        prepare(out.gx, GRAD_X, CV_16SC1);
+        prepare(out.gy, GRAD_Y, CV_16SC1);
+        prepare(out.magnitude, GRAD_MAGNITUDE, CV_16SC1);
+        prepare(out.orientation, GRAD_ORIENTATION, CV_8UC1);
+
+        std::vector<uint8_t> zero(w, 0);
+        auto line = [&](int y) -> const uint8_t* {
+            if (y >= 0 && y < h) {
+                return gray.ptr<uint8_t>(y);
+            }
+            if (!cfg_.reflect) {
+                return zero.data();
+            }
+            return gray.ptr<uint8_t>(y < 0 ? std::min(1, h - 1) : std::max(h - 2, 0));
+        };
+        parallel_for_rows(h, 1, [&](const ParallelRange& band) {
+            for (int y = band.begin; y < band.end; ++y) {
+                row(line(y - 1), line(y), line(y + 1), w, out.gx.empty() ? nullptr : out.gx.ptr<int16_t>(y),
+                    out.gy.empty() ? nullptr : out.gy.ptr<int16_t>(y),
+                    out.magnitude.empty() ? nullptr : out.magnitude.ptr<int16_t>(y),
+                    out.orientation.empty() ? nullptr : out.orientation.ptr<uint8_t>(y));
+            }
+        });
+    }
+
+    GradientImages apply(const cv::Mat& gray, int outputs) const {
+        GradientImages out;
+        apply(gray, out, outputs);
+        return out;
+    }
+
+   private:
+    GradientConfig cfg_;
+    std::vector<int32_t> cos_, sin_;  // 区间边界的法向量（Q20）
+
+    void pixel(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width, int x, int16_t* gx,
+               int16_t* gy, int16_t* mag, uint8_t* bin) const {
+        // 行内越界：补 0 或镜像
+        auto at = [&](const uint8_t* r, int i) -> int {
+            if (i >= 0 && i < width) {
+                return r[i];
+            }
+            if (!cfg_.reflect) {
+                return 0;
+            }
+            return r[i < 0 ? std::min(1, width - 1) : std::max(width - 2, 0)];
+        };
+        int dx, dy;
+        if (cfg_.kernel == GRAD_SOBEL) {
+            dx = (at(up, x + 1) - at(up, x - 1)) + 2 * (at(mid, x + 1) - at(mid, x - 1)) +
+                 (at(down, x + 1) - at(down, x - 1));
+            dy = (at(down, x - 1) + 2 * at(down, x) + at(down, x + 1)) - (at(up, x - 1) + 2 * at(up, x) + at(up, x + 1));
+        } else {
+            dx = at(mid, x + 1) - at(mid, x - 1);
+            dy = at(down, x) - at(up, x);
+        }
+        if (gx) {
+            gx[x] = (int16_t)dx;
+        }
+        if (gy) {
+            gy[x] = (int16_t)dy;
+        }
+        if (mag) {
+            mag[x] = cfg_.norm == GRAD_L1 ? (int16_t)(std::abs(dx) + std::abs(dy))
+                                          : (int16_t)std::lrint(std::sqrt((float)(dx * dx + dy * dy)));
+        }
+        if (bin) {
+            int count = 0;
+            if (dx != 0 || dy != 0) {
+                if (dy < 0) {
+                    dx = -dx;
+                    dy = -dy;
+                }
+                for (size_t k = 0; k < cos_.size(); ++k) {
+                    count += (int64_t)dy * cos_[k] - (int64_t)dx * sin_[k] >= 0;
+                }
+                if (count == cfg_.bins) {
+                    count = 0;
+                }
+            }
+            bin[x] = (uint8_t)count;
+        }
+    }
+
+#if defined(__SSE2__)
+    void simd8(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int x, int16_t* gx, int16_t* gy,
+               int16_t* mag, uint8_t* bin) const {
+        const __m128i z = _mm_setzero_si128();
+        auto load = [&](const uint8_t* p) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), z); };
+        __m128i m_l = load(mid + x - 1), m_r = load(mid + x + 1);
+        __m128i dx, dy;
+        if (cfg_.kernel == GRAD_SOBEL) {
+            __m128i u_l = load(up + x - 1), u_c = load(up + x), u_r = load(up + x + 1);
+            __m128i d_l = load(down + x - 1), d_c = load(down + x), d_r = load(down + x + 1);
+            __m128i m = _mm_sub_epi16(m_r, m_l);
+            dx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(u_r, u_l), _mm_sub_epi16(d_r, d_l)), _mm_add_epi16(m, m));
+            __m128i u = _mm_add_epi16(_mm_add_epi16(u_l, u_r), _mm_add_epi16(u_c, u_c));
+            __m128i d = _mm_add_epi16(_mm_add_epi16(d_l, d_r), _mm_add_epi16(d_c, d_c));
+            dy = _mm_sub_epi16(d, u);
+        } else {
+            dx = _mm_sub_epi16(m_r, m_l);
+            dy = _mm_sub_epi16(load(down + x), load(up + x));
+        }
+        if (gx) {
+            _mm_storeu_si128((__m128i*)(gx + x), dx);
+        }
+        if (gy) {
+            _mm_storeu_si128((__m128i*)(gy + x), dy);
+        }
+        if (mag) {
+            __m128i v;
+            if (cfg_.norm == GRAD_L1) {
+                v = _mm_add_epi16(_mm_max_epi16(dx, _mm_sub_epi16(z, dx)), _mm_max_epi16(dy, _mm_sub_epi16(z, dy)));
+            } else {
+                // (gx, gy) 交错后 pmaddwd 自乘得到 gx² + gy²
+                __m128i lo = _mm_unpacklo_epi16(dx, dy), hi = _mm_unpackhi_epi16(dx, dy);
+                __m128 s_lo = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo)));
+                __m128 s_hi = _mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi)));
+                v = _mm_packs_epi32(_mm_cvtps_epi32(s_lo), _mm_cvtps_epi32(s_hi));
+            }
+            _mm_storeu_si128((__m128i*)(mag + x), v);
+        }
+        if (bin) {
+            // gy < 0 时整体取反，翻转到上半平面
+            __m128i neg = _mm_cmplt_epi16(dy, z);
+            __m128i fx = _mm_sub_epi16(_mm_xor_si128(dx, neg), neg);
+            __m128i fy = _mm_sub_epi16(_mm_xor_si128(dy, neg), neg);
+            __m128i lo = _mm_unpacklo_epi16(fy, fx), hi = _mm_unpackhi_epi16(fy, fx);
+            __m128i c_lo = z, c_hi = z, minus1 = _mm_set1_epi32(-1);
+            for (size_t k = 0; k < cos_.size(); ++k) {
+                // 每个 32 位元素为 (cos φ, -sin φ)，pmaddwd 得到 gy·cos φ - gx·sin φ；
+                // 系数 = 高位 × 65536 + 低位（有符号），真实结果在 int32 范围内，移位时的回绕不影响结果
+                int32_t c = cos_[k], s = -sin_[k];
+                int16_t c_low = (int16_t)(c & 0xFFFF), s_low = (int16_t)(s & 0xFFFF);
+                int16_t c_high = (int16_t)((c - c_low) >> 16), s_high = (int16_t)((s - s_low) >> 16);
+                __m128i w_low = _mm_set1_epi32((int)(uint16_t)c_low | ((int)(uint16_t)s_low << 16));
+                __m128i w_high = _mm_set1_epi32((int)(uint16_t)c_high | ((int)(uint16_t)s_high << 16));
+                __m128i d_lo = _mm_add_epi32(_mm_slli_epi32(_mm_madd_epi16(lo, w_high), 16), _mm_madd_epi16(lo, w_low));
+                __m128i d_hi = _mm_add_epi32(_mm_slli_epi32(_mm_madd_epi16(hi, w_high), 16), _mm_madd_epi16(hi, w_low));
+                c_lo = _mm_sub_epi32(c_lo, _mm_cmpgt_epi32(d_lo, minus1));
+                c_hi = _mm_sub_epi32(c_hi, _mm_cmpgt_epi32(d_hi, minus1));
+            }
+            __m128i count = _mm_packs_epi32(c_lo, c_hi);
+            // count == bins（centered 时越过全部边界）回到 0；零梯度记为 0
+            __m128i wrap = _mm_cmpeq_epi16(count, _mm_set1_epi16((int16_t)cfg_.bins));
+            __m128i flat = _mm_cmpeq_epi16(_mm_or_si128(dx, dy), z);
+            count = _mm_andnot_si128(_mm_or_si128(wrap, flat), count);
+            _mm_storel_epi64((__m128i*)(bin + x), _mm_packus_epi16(count, count));
+        }
+    }
+#endif
+};
+
+/**
+ * @brief 计算梯度（返回新图像）
+ */
+inline GradientImages gradient(const cv::Mat& gray, int outputs, const GradientConfig& config = GradientConfig()) {
+    return GradientOperator(config).apply(gray, outputs);
+}
+
+/**
+ * @brief Canny 的后半部分（answer_43）：Sobel 梯度、非极大值抑制、双阈值
+ *
+ * 输入一般已经过高斯模糊。幅值保留 int16（不像 answer_43 截断到 uint8），方向用梯度的 4 个区间：
+ * 沿梯度方向的两个邻居都不大于自身时保留，图像外的邻居不参与比较。
+ * 双阈值与 answer_43 相同只看一层邻域：幅值 ≥ high 为边缘，low < 幅值 < high 且 8 邻域内有 ≥ high 的像素也为边缘。
+ *
+ * @param gray 灰度图像（CV_8UC1）
+ * @param high 高阈值
+ * @param low 低阈值
+ *
+ * @return 边缘为 255、其余为 0 的 CV_8UC1 图像
+ */
+inline cv::Mat canny(const cv::Mat& gray, int high = 50, int low = 20) {
+    GradientImages g = gradient(gray, GRAD_MAGNITUDE | GRAD_ORIENTATION);
+    int h = gray.rows, w = gray.cols;
+    // 区间 0 ~ 3（0°、45°、90°、135°，gy 向下为正）对应的邻居偏移
+    static const int DX[4] = {1, 1, 0, -1}, DY[4] = {0, 1, 1, 1};
+    cv::Mat thin(h, w, CV_16SC1);
+    parallel_for_rows(h, 1, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            const int16_t* mag = g.magnitude.ptr<int16_t>(y);
+            const uint8_t* bin = g.orientation.ptr<uint8_t>(y);
+            int16_t* out = thin.ptr<int16_t>(y);
+            for (int x = 0; x < w; ++x) {
+                int dx = DX[bin[x]], dy = DY[bin[x]], m = mag[x];
+                bool keep = true;
+                for (int s = -1; s <= 1 && keep; s += 2) {
+                    int nx = x + s * dx, ny = y + s * dy;
+                    if (nx >= 0 && nx < w && ny >= 0 && ny < h) {
+                        keep = g.magnitude.ptr<int16_t>(ny)[nx] <= m;
+                    }
+                }
+                out[x] = keep ? (int16_t)m : 0;
+            }
+        }
+    });
+
+    cv::Mat edge(h, w, CV_8UC1);
+    parallel_for_rows(h, 1, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            const int16_t* m = thin.ptr<int16_t>(y);
+            uint8_t* out = edge.ptr<uint8_t>(y);
+            for (int x = 0; x < w; ++x) {
+                bool strong = m[x] >= high;
+                if (!strong && m[x] > low) {
+                    for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, h - 1) && !strong; ++ny) {
+                        const int16_t* n = thin.ptr<int16_t>(ny);
+                        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, w - 1); ++nx) {
+                            strong = strong || n[nx] >= high;
+                        }
+                    }
+                }
+                out[x] = strong ? 255 : 0;
+            }
+        }
+    });
+    return edge;
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "lut.hpp"
+#include "parallel.hpp"
+
+/**
+ * @brief 8 bit 直方图计数的 bank 数
+ *
+ * 相邻像素常常取相同的值，只用一个计数数组时，连续的 count[v]++ 会因为
+ * 同一地址的读后写相互等待。把相邻像素分散到 4 个独立的计数数组，最后再合并。
+ */
+const int HIST_BANKS = 4;
+
+/**
+ * @brief 统计一段 8 bit 数据，累加到 bank 中
+ *
+ * @param p 数据起始地址
+ * @param n 统计的元素个数
+ * @param step 相邻元素的间隔（多通道图像取单个通道时为通道数）
+ * @param bank HIST_BANKS 个 256 项计数数组
+ */
+inline void histogram_count_u8(const uint8_t* p, int n, int step, uint32_t (*bank)[256]) {
+    int i = 0;
+    if (step == 1) {
+        // 一次读 8 个字节，按字节拆开分给各个 bank
+        for (; i + 8 <= n; i += 8) {
+            uint64_t v;
+            std::memcpy(&v, p + i, 8);
+            ++bank[0][v & 0xFF];
+            ++bank[1][(v >> 8) & 0xFF];
+            ++bank[2][(v >> 16) & 0xFF];
+            ++bank[3][(v >> 24) & 0xFF];
+            ++bank[0][(v >> 32) & 0xFF];
+            ++bank[1][(v >> 40) & 0xFF];
+            ++bank[2][(v >> 48) & 0xFF];
+            ++bank[3][v >> 56];
+        }
+    } else {
+        for (; i + 4 <= n; i += 4) {
+            ++bank[0][p[(size_t)i * step]];
+            ++bank[1][p[(size_t)(i + 1) * step]];
+            ++bank[2][p[(size_t)(i + 2) * step]];
+            ++bank[3][p[(size_t)(i + 3) * step]];
+        }
+    }
+    for (; i < n; ++i) {
+        ++bank[0][p[(size_t)i * step]];
+    }
+}
+
+/**
+ * @brief 8 bit 图像的直方图
+ *
+ * 统计时按行分块，每个线程使用自己的局部直方图，最后归并。
+ * 累积分布（CDF）在第一次使用时计算并缓存，直方图被修改后失效。
+ */
+class Histogram {
+   public:
+    Histogram() { clear(); }
+
+    /**
+     * @brief 统计图像的直方图
+     *
+     * @param img CV_8U 图像
+     * @param channel 统计的通道，-1 表示所有通道合在一起统计（与 answer_23 相同）
+     */
+    explicit Histogram(const cv::Mat& img, int channel = -1) {
+        clear();
+        add(img, channel);
+    }
+
+    void clear() {
+        count_.fill(0);
+        total_ = 0;
+        cdf_valid_ = false;
+    }
+
+    /**
+     * @brief 把图像的像素累加到直方图中
+     */
+    void add(const cv::Mat& img, int channel = -1) {
+        CV_Assert(img.depth() == CV_8U && channel < img.channels());
+        int cn = img.channels();
+        const uint8_t* base = img.data + (channel < 0 ? 0 : channel);
+        int n = channel < 0 ? img.cols * cn : img.cols;
+        int step = channel < 0 ? 1 : cn;
+
+        // 每个分块一份局部直方图，分块数取线程数的几倍以便负载均衡
+        int bands = std::min(img.rows, parallel_threads() * 4);
+        std::vector<std::array<uint64_t, 256>> partial(std::max(bands, 0));
+        parallel_for(0, bands, [&](int b) {
+            uint32_t bank[HIST_BANKS][256];
+            std::memset(bank, 0, sizeof(bank));
+            ParallelRange band = parallel_split(img.rows, bands, b, 0);
+            for (int y = band.begin; y < band.end; ++y) {
+                histogram_count_u8(base + (size_t)y * img.step, n, step, bank);
+            }
+            for (int v = 0; v < 256; ++v) {
+                partial[b][v] = (uint64_t)bank[0][v] + bank[1][v] + bank[2][v] + bank[3][v];
+            }
+        });
+
+        for (const std::array<uint64_t, 256>& p : partial) {
+            for (int v = 0; v < 256; ++v) {
+                count_[v] += p[v];
+            }
+        }
+        total_ += (uint64_t)img.rows * n;
+        cdf_valid_ = false;
+    }
+
+    uint64_t operator[](int v) const { return count_[v]; }
+    const std::array<uint64_t, 256>& counts() const { return count_; }
+    uint64_t total() const { return total_; }
+
+    /**
+     * @brief 累积分布：cdf()[v] 为不大于 v 的像素个数
+     */
+    const std::array<uint64_t, 256>& cdf() const {
+        if (!cdf_valid_) {
+            uint64_t sum = 0;
+            for (int v = 0; v < 256; ++v) {
+                sum += count_[v];
+                cdf_[v] = sum;
+            }
+            cdf_valid_ = true;
+        }
+        return cdf_;
+    }
+
+    /**
+     * @brief 最小、最大像素值（空直方图返回 0 / -1）
+     */
+    int min_value() const {
+        int v = 0;
+        while (v < 256 && count_[v] == 0) {
+            ++v;
+        }
+        return v < 256 ? v : 0;
+    }
+
+    int max_value() const {
+        int v = 255;
+        while (v >= 0 && count_[v] == 0) {
+            --v;
+        }
+        return v;
+    }
+
+    /**
+     * @brief 均值与标准差，直接由直方图计算，不再遍历图像
+     */
+    double mean() const {
+        double sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += (double)v * count_[v];
+        }
+        return total_ ? sum / total_ : 0;
+    }
+
+    double stddev() const {
+        if (!total_) {
+            return 0;
+        }
+        double m = mean(), sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += (v - m) * (v - m) * count_[v];
+        }
+        return std::sqrt(sum / total_);
+    }
+
+    /**
+     * @brief 累积比例首次达到 p（0~1）的像素值
+     */
+    int percentile(double p) const {
+        const std::array<uint64_t, 256>& c = cdf();
+        double target = p * total_;
+        for (int v = 0; v < 256; ++v) {
+            if (c[v] >= target) {
+                return v;
+            }
+        }
+        return 255;
+    }
+
+   private:
+    std::array<uint64_t, 256> count_;
+    uint64_t total_;
+    mutable std::array<uint64_t, 256> cdf_;
+    mutable bool cdf_valid_;
+};
+
+/**
+ * @brief 直方图均衡化的查找表
+ *
+ * 与 answer_23 相同：out = Zmax / S * (小于当前值的像素个数)。
+ *
+ * @param hist 直方图
+ * @param zmax 输出的最大值
+ */
+inline Lut equalize_lut(const Histogram& hist, double zmax = 255) {
+    const std::array<uint64_t, 256>& cdf = hist.cdf();
+    double scale = hist.total() ? zmax / hist.total() : 0;
+    Lut lut;
+    lut[0] = 0;
+    for (int v = 1; v < 256; ++v) {
+        lut[v] = (uint8_t)(scale * cdf[v - 1]);
+    }
+    return lut;
+}
+
+/**
+ * @brief 直方图归一化的查找表：把实际的 [min, max] 拉伸到 [a, b]
+ */
+inline Lut normalize_lut(const Histogram& hist, int a, int b) {
+    return lut_normalize(hist.min_value(), hist.max_value(), a, b);
+}
+
+/**
+ * @brief 直方图变换的查找表：把均值、标准差变为 m0、s0
+ */
+inline Lut transform_lut(const Histogram& hist, double m0, double s0) {
+    return lut_transform(hist.mean(), hist.stddev(), m0, s0);
+}
+
+/**
+ * @brief 直方图均衡化
+ *
+ * 统计一次直方图，由 CDF 生成查找表，再对整幅图像查表一次。
+ * 所有通道共用一个直方图（与 answer_23 相同）。
+ *
+ * @param img CV_8U 图像
+ *
+ * @return 均衡化后的图像
+ */
+inline cv::Mat equalize_hist(const cv::Mat& img) { return apply_lut(img, equalize_lut(Histogram(img))); }
+
+/**
+ * @brief 直方图归一化（answer_21），统计和变换各遍历一次图像
+ */
+inline cv::Mat normalize_hist(const cv::Mat& img, int a, int b) {
+    return apply_lut(img, normalize_lut(Histogram(img), a, b));
+}
+
+/**
+ * @brief 直方图变换（answer_22），统计和变换各遍历一次图像
+ */
+inline cv::Mat transform_hist(const cv::Mat& img, double m0, double s0) {
+    return apply_lut(img, transform_lut(Histogram(img), m0, s0));
+}
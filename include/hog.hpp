@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "gradient.hpp"
+
+static const int HOG_CELL = 8;  // 每个 cell 的边长（像素）
+static const int HOG_BINS = 9;  // 方向直方图的 bin 数，覆盖 [0, π)
+
+/**
+ * @brief 整幅图像的 HOG cell 直方图
+ *
+ * hist 按 (cy, cx, bin) 行主序存放未归一化的梯度直方图。
+ * 检测时整幅图只计算一次 cell 直方图，各个窗口的特征直接从这里取，不再重复计算梯度。
+ */
+struct HogCells {
+    int rows = 0;  // cell 行数
+    int cols = 0;  // cell 列数
+    std::vector<float> hist;
+    GradientImages grad;  // 逐行计算梯度用的 1 行缓冲区（gx、gy、orientation），宽度不变时跨调用复用
+
+    float* at(int cy, int cx) { return &hist[((size_t)cy * cols + cx) * HOG_BINS]; }
+    const float* at(int cy, int cx) const { return &hist[((size_t)cy * cols + cx) * HOG_BINS]; }
+};
+
+/**
+ * @brief 计算 HOG cell 直方图
+ *
+ * 梯度用中心差分（边界镜像），梯度方向映射到 [0, π) 后量化为 9 个 bin（见 GradientOperator），
+ * 每个像素的梯度幅值累加到所在 cell 的对应 bin。不足一个 cell 的边缘部分被丢弃。
+ * out 的内存（包括梯度的行缓冲区）会被复用，形状不变时不再分配。
+ *
+ * @param gray 灰度图数据
+ * @param width 宽度
+ * @param height 高度
+ * @param stride 每行字节数
+ * @param out 输出的 cell 直方图
+ */
+inline void hog_cells(const uint8_t* gray, int width, int height, size_t stride, HogCells& out) {
+    out.rows = height / HOG_CELL;
+    out.cols = width / HOG_CELL;
+    out.hist.assign((size_t)out.rows * out.cols * HOG_BINS, 0.f);
+
+    int h = out.rows * HOG_CELL;
+    int w = out.cols * HOG_CELL;
+
+    // 梯度与方向区间由 GradientOperator 在一次扫描中算出，幅值在累加时由整数梯度开方
+    GradientConfig config;
+    config.kernel = GRAD_CENTRAL;
+    config.reflect = true;
+    config.bins = HOG_BINS;
+    config.centered = false;
+    static const GradientOperator op(config);
+    out.grad.gx.create(1, width, CV_16SC1);
+    out.grad.gy.create(1, width, CV_16SC1);
+    out.grad.orientation.create(1, width, CV_8UC1);
+    int16_t* gx = out.grad.gx.ptr<int16_t>(0);
+    int16_t* gy = out.grad.gy.ptr<int16_t>(0);
+    uint8_t* bins = out.grad.orientation.ptr<uint8_t>(0);
+
+    // 镜像边界：-1 -> 1，n -> n - 2
+    auto reflect = [](int i, int n) { return i < 0 ? std::min(1, n - 1) : (i >= n ? std::max(n - 2, 0) : i); };
+
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* row = gray + (size_t)y * stride;
+        const uint8_t* up = gray + (size_t)reflect(y - 1, height) * stride;
+        const uint8_t* down = gray + (size_t)reflect(y + 1, height) * stride;
+        float* cell_row = out.at(y / HOG_CELL, 0);
+        op.row(up, row, down, width, gx, gy, nullptr, bins);
+
+        for (int x = 0; x < w; ++x) {
+            float mag = std::sqrt((float)(gx[x] * gx[x] + gy[x] * gy[x]));
+            cell_row[(x / HOG_CELL) * HOG_BINS + bins[x]] += mag;
+        }
+    }
+}
+
+/**
+ * @brief 计算 HOG cell 直方图（cv::Mat 版本）
+ *
+ * @param gray CV_8UC1 灰度图
+ *
+ * @return cell 直方图
+ */
+inline HogCells hog_cells(const cv::Mat& gray) {
+    CV_Assert(gray.type() == CV_8UC1);
+    HogCells cells;
+    hog_cells(gray.data, gray.cols, gray.rows, gray.step, cells);
+    return cells;
+}
+
+/**
+ * @brief 从 cell 直方图中取出一个窗口的 HOG 特征
+ *
+ * 每个 cell 的直方图除以窗口内 3×3 邻域 cell 的 L2 范数（eps = 1）。
+ * 邻域只取窗口内的 cell，因此从整幅图取出的窗口特征与把窗口裁剪出来单独计算的特征一致。
+ *
+ * @param cells cell 直方图
+ * @param cy 窗口左上角所在的 cell 行
+ * @param cx 窗口左上角所在的 cell 列
+ * @param win_rows 窗口的 cell 行数
+ * @param win_cols 窗口的 cell 列数
+ * @param out 输出特征，长度 win_rows * win_cols * HOG_BINS
+ */
+template <typename T>
+void hog_window(const HogCells& cells, int cy, int cx, int win_rows, int win_cols, T* out) {
+    const float eps = 1;
+
+    for (int y = 0; y < win_rows; ++y) {
+        for (int x = 0; x < win_cols; ++x) {
+            // 3×3 邻域的平方和
+            float norm = eps;
+            for (int ny = std::max(y - 1, 0); ny < std::min(y + 2, win_rows); ++ny) {
+                for (int nx = std::max(x - 1, 0); nx < std::min(x + 2, win_cols); ++nx) {
+                    const float* h = cells.at(cy + ny, cx + nx);
+                    for (int b = 0; b < HOG_BINS; ++b) {
+                        norm += h[b] * h[b];
+                    }
+                }
+            }
+            norm = 1.f / std::sqrt(norm);
+
+            const float* h = cells.at(cy + y, cx + x);
+            T* o = out + ((size_t)y * win_cols + x) * HOG_BINS;
+            for (int b = 0; b < HOG_BINS; ++b) {
+                o[b] = (T)(h[b] * norm);
+            }
+        }
+    }
+}
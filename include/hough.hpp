@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "gradient.hpp"
+#include "parallel.hpp"
+
+static const int HOUGH_ANGLES = 180;  // θ 取 0° ~ 179°，步长 1°
+
+/**
+ * @brief 一条直线 x cos θ + y sin θ = rho
+ */
+struct HoughLine {
+    int rho;    // 像素，可以为负
+    int theta;  // 度
+    int votes;
+};
+
+/**
+ * @brief Hough 投票空间
+ *
+ * votes 按 (θ, rho + rho_max) 行主序存放：投票时每个线程负责一段 θ，写入的是连续的行。
+ */
+struct HoughSpace {
+    int rho_max = 0;  // rho 的范围为 [-rho_max, rho_max)
+    std::vector<int> votes;
+
+    int rhos() const { return 2 * rho_max; }
+    int at(int rho, int theta) const { return votes[(size_t)theta * rhos() + rho + rho_max]; }
+};
+
+/**
+ * @brief cos θ、sin θ 表，与 answer_44 的 M_PI / 180 * t 逐位相同
+ */
+struct HoughTrigTable {
+    double cos[HOUGH_ANGLES], sin[HOUGH_ANGLES];
+
+    HoughTrigTable() {
+        for (int t = 0; t < HOUGH_ANGLES; ++t) {
+            double angle = M_PI / 180 * t;
+            cos[t] = std::cos(angle);
+            sin[t] = std::sin(angle);
+        }
+    }
+};
+
+inline const HoughTrigTable& hough_trig_table() {
+    static const HoughTrigTable table;
+    return table;
+}
+
+/**
+ * @brief Hough 投票（answer_44）
+ *
+ * 先收集一次边缘点，再按 θ 分段并行：每个线程只写自己负责的行，不需要加锁或合并。
+ * rho 与 answer_44 一样由 double 计算后向零取整，结果逐位相同。
+ * out 的内存会被复用，尺寸不变时不再分配。
+ *
+ * @param edge CV_8UC1 边缘图像，值为 255 的像素参与投票
+ * @param out 投票空间
+ * @param rho_max rho 的范围，0 表示取对角线长度 + 1（answer_44 固定为 320）
+ */
+inline void hough_vote(const cv::Mat& edge, HoughSpace& out, int rho_max = 0) {
+    CV_Assert(edge.type() == CV_8UC1);
+    if (rho_max <= 0) {
+        rho_max = (int)std::ceil(std::hypot((double)edge.cols, (double)edge.rows)) + 1;
+    }
+    CV_Assert(rho_max > std::hypot((double)edge.cols, (double)edge.rows));
+    out.rho_max = rho_max;
+    out.votes.assign((size_t)HOUGH_ANGLES * out.rhos(), 0);
+
+    std::vector<int> xs, ys;
+    for (int y = 0; y < edge.rows; ++y) {
+        const uint8_t* row = edge.ptr<uint8_t>(y);
+        for (int x = 0; x < edge.cols; ++x) {
+            if (row[x] == 255) {
+                xs.push_back(x);
+                ys.push_back(y);
+            }
+        }
+    }
+
+    const HoughTrigTable& trig = hough_trig_table();
+    parallel_for_rows(HOUGH_ANGLES, 0, [&](const ParallelRange& band) {
+        for (int t = band.begin; t < band.end; ++t) {
+            int* acc = &out.votes[(size_t)t * out.rhos() + rho_max];
+            double c = trig.cos[t], s = trig.sin[t];
+            for (size_t i = 0; i < xs.size(); ++i) {
+                ++acc[(int)(xs[i] * c + ys[i] * s)];
+            }
+        }
+    });
+}
+
+/**
+ * @brief 非极大值抑制后取票数最多的 n 条直线（answer_45）
+ *
+ * 与 answer_45 相同：票数为 0 的格子跳过，8 邻域内有更大票数的格子被抑制；
+ * 留下的格子按 (rho, θ) 扫描顺序插入长度为 n 的有序表，插在第一条票数不大于它的直线之前，
+ * 所以票数相同时扫描顺序靠后的排在前面。插入位置恰好是最后一格时这条直线被丢弃
+ * （answer_46 的移位循环只到倒数第二格，随后把原值写回最后一格），最后一格只能由前面的直线后移填入。
+ *
+ * @param space 投票空间
+ * @param n 最多返回的直线数，不小于 2
+ *
+ * @return 按票数从大到小排列的直线
+ */
+inline std::vector<HoughLine> hough_peaks(const HoughSpace& space, int n = 30) {
+    CV_Assert(n >= 2);
+    std::vector<HoughLine> peaks;
+    peaks.reserve(n + 1);
+    int R = space.rho_max;
+    for (int rho = -R; rho < R; ++rho) {
+        for (int t = 0; t < HOUGH_ANGLES; ++t) {
+            int v = space.at(rho, t);
+            if (v == 0) {
+                continue;
+            }
+            bool keep = true;
+            for (int dr = -1; dr <= 1 && keep; ++dr) {
+                for (int dt = -1; dt <= 1 && keep; ++dt) {
+                    int r = rho + dr, a = t + dt;
+                    if ((dr || dt) && r >= -R && r < R && a >= 0 && a < HOUGH_ANGLES) {
+                        keep = space.at(r, a) <= v;
+                    }
+                }
+            }
+            if (!keep) {
+                continue;
+            }
+            int pos = 0;
+            while (pos < (int)peaks.size() && peaks[pos].votes > v) {
+                ++pos;
+            }
+            if (pos < n - 1) {
+                peaks.insert(peaks.begin() + pos, HoughLine{rho, t, v});
+                if ((int)peaks.size() > n) {
+                    peaks.pop_back();
+                }
+            }
+        }
+    }
+    return peaks;
+}
+
+/**
+ * @brief 把直线画到图像上（answer_46 的逆变换）
+ *
+ * 与 answer_46 相同：对每一列求 y、对每一行求 x 并向零取整；θ 为 0° 的直线被跳过。
+ *
+ * @param img CV_8UC3 图像，原地绘制
+ * @param lines 直线
+ * @param color 颜色，默认为红色
+ */
+inline void hough_draw(cv::Mat& img, const std::vector<HoughLine>& lines, cv::Vec3b color = cv::Vec3b(0, 0, 255)) {
+    CV_Assert(img.type() == CV_8UC3);
+    for (const HoughLine& line : lines) {
+        double c = std::cos(line.theta * M_PI / 180), s = std::sin(line.theta * M_PI / 180);
+        if (s == 0 || c == 0) {
+            continue;
+        }
+        for (int x = 0; x < img.cols; ++x) {
+            int y = (int)(-c / s * x + line.rho / s);
+            if (y >= 0 && y < img.rows) {
+                img.at<cv::Vec3b>(y, x) = color;
+            }
+        }
+        for (int y = 0; y < img.rows; ++y) {
+            int x = (int)(-s / c * y + line.rho / c);
+            if (x >= 0 && x < img.cols) {
+                img.at<cv::Vec3b>(y, x) = color;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Hough 直线检测（answer_46）：canny、投票、非极大值抑制
+ *
+ * @param gray 灰度图像（CV_8UC1），一般已经过高斯模糊
+ * @param n 最多返回的直线数
+ * @param high canny 的高阈值
+ * @param low canny 的低阈值
+ *
+ * @return 按票数从大到小排列的直线
+ */
+inline std::vector<HoughLine> hough_lines(const cv::Mat& gray, int n = 30, int high = 50, int low = 20) {
+    HoughSpace space;
+    hough_vote(canny(gray, high, low), space);
+    return hough_peaks(space, n);
+}
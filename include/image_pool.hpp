@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 图像缓冲池的计数
+ */
+struct ImagePoolStats {
+    size_t allocations = 0;  // 池新申请缓冲区的次数，不含内核内部的分配（稳定后每帧应为 0）
+    size_t reuses = 0;       // 复用已有缓冲区的次数
+    size_t bytes = 0;        // 池持有的总字节数
+    size_t in_use = 0;       // 本帧借出的缓冲区数
+};
+
+/**
+ * @brief 按帧回收的图像缓冲池
+ *
+ * 处理一帧时用 acquire 借出中间图像，帧结束时调用 next_frame 一次性归还，下一帧借出同样大小的图像时
+ * 直接复用，处理尺寸不变的视频流时稳定后不再申请内存。借出的 cv::Mat 只是指向池内存的头，
+ * 对它调用 create（例如作为 convolve、apply_lut 等函数的 dst）时尺寸、类型不变就不会重新分配。
+ * acquire 不清零，只在不是每个像素都会被写入时使用 acquire_zeros。
+ *
+ * 借出的图像在 next_frame、clear 之后失效，需要保留的结果要 clone。池本身不是线程安全的，
+ * 应由处理帧的线程使用（图像内部的并行不受影响）。
+ */
+class ImagePool {
+   public:
+    /**
+     * @brief 借出一幅图像，内容未初始化
+     */
+    cv::Mat acquire(int rows, int cols, int type) {
+        size_t step = (size_t)cols * CV_ELEM_SIZE(type), size = step * rows;
+        Block* block = nullptr;
+        for (Block& b : blocks_) {
+            if (!b.used && b.data.size() == size) {
+                block = &b;
+                break;
+            }
+        }
+        if (block) {
+            ++stats_.reuses;
+        } else {
+            blocks_.emplace_back();
+            block = &blocks_.back();
+            block->data.resize(size);
+            ++stats_.allocations;
+            stats_.bytes += size;
+        }
+        block->used = true;
+        ++stats_.in_use;
+        return cv::Mat(rows, cols, type, block->data.data(), step);
+    }
+
+    cv::Mat acquire(cv::Size size, int type) { return acquire(size.height, size.width, type); }
+
+    /**
+     * @brief 借出一幅全 0 的图像（等价于 cv::Mat::zeros）
+     */
+    cv::Mat acquire_zeros(int rows, int cols, int type) {
+        cv::Mat m = acquire(rows, cols, type);
+        std::memset(m.data, 0, m.step * rows);
+        return m;
+    }
+
+    /**
+     * @brief 归还本帧借出的全部图像
+     */
+    void next_frame() {
+        for (Block& b : blocks_) {
+            b.used = false;
+        }
+        stats_.in_use = 0;
+    }
+
+    /**
+     * @brief 释放所有缓冲区（计数保留）
+     */
+    void clear() {
+        blocks_.clear();
+        stats_.bytes = 0;
+        stats_.in_use = 0;
+    }
+
+    const ImagePoolStats& stats() const { return stats_; }
+
+   private:
+    // 块在 blocks_ 扩容时随之移动，但 std::vector 的移动不改变数据的地址，借出的图像仍然有效
+    struct Block {
+        std::vector<uint8_t> data;
+        bool used = false;
+    };
+
+    std::vector<Block> blocks_;
+    ImagePoolStats stats_;
+};
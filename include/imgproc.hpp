@@ -0,0 +1,78 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "clahe.hpp"
+#include "convolve.hpp"
+#include "gradient.hpp"
+#include "lut.hpp"
+#include "otsu.hpp"
+#include "pool.hpp"
+#include "remap.hpp"
+#include "resize.hpp"
+#include "warp.hpp"
+
+/**
+ * @brief libimgproc 的接口（build_lib.sh 编译，链接 build/libimgproc.a）
+ *
+ * 与直接包含各个头文件相比，库中的每个内核都按 SSE2、SSE4.2、AVX2、AVX-512 编译了多份，
+ * 第一次调用时根据 cpuid 选择当前 CPU 支持的最高版本，同一个二进制文件可以在不同的机器上运行。
+ * 参数与结果与同名的头文件函数相同；各版本的结果逐位一致（编译时关闭了 FMA 合并）。
+ */
+namespace imgproc {
+
+/**
+ * @brief 内核的指令集版本
+ */
+enum CpuLevel {
+    CPU_BASELINE,  // SSE2（非 x86 平台为编译器默认）
+    CPU_SSE42,     // SSE4.2 + SSSE3
+    CPU_AVX2,      // AVX2
+    CPU_AVX512,    // AVX-512 F/BW/VL/VBMI（Ice Lake、Zen 4 及以后）
+};
+
+/**
+ * @brief 当前 CPU 支持的最高版本
+ */
+CpuLevel cpu_detect();
+
+/**
+ * @brief 正在使用的版本
+ *
+ * 默认为 cpu_detect()，环境变量 IMGPROC_CPU（baseline / sse42 / avx2 / avx512）可以指定上限。
+ */
+CpuLevel cpu_level();
+
+/**
+ * @brief 指定使用的版本，超过 cpu_detect() 时取 cpu_detect()
+ *
+ * @return 实际使用的版本
+ */
+CpuLevel set_cpu_level(CpuLevel level);
+
+const char* cpu_level_name(CpuLevel level);
+
+/**
+ * @brief 库中内核的线程数上限，0 表示不限制
+ *
+ * 每个指令集版本有自己的线程池和 parallel_thread_limit()，与调用方包含的 parallel.hpp 互不影响；
+ * 这里同时设置所有可用的版本，之后 set_cpu_level 切换版本时上限不变。
+ */
+void set_thread_limit(int limit);
+
+void apply_lut(const cv::Mat& src, cv::Mat& dst, const Lut& lut);
+void apply_lut(const cv::Mat& src, cv::Mat& dst, const ChannelLut& lut);
+void equalize_hist(const cv::Mat& src, cv::Mat& dst);
+void clahe(const cv::Mat& src, cv::Mat& dst, const ClaheConfig& cfg = ClaheConfig());
+void convolve(const cv::Mat& src, cv::Mat& dst, const Kernel& kernel);
+void gradient(const cv::Mat& gray, GradientImages& out, int outputs, const GradientConfig& cfg = GradientConfig());
+void pool(const cv::Mat& src, cv::Mat& dst, const PoolConfig& cfg = PoolConfig());
+void resample(const cv::Mat& src, cv::Mat& dst, cv::Size size, ResampleFilter filter, bool antialias = true);
+void warp_affine(const cv::Mat& src, cv::Mat& dst, const AffineMatrix& m, cv::Size dsize,
+                 WarpInterp interp = WARP_BILINEAR, uint8_t border = 0);
+void warp_perspective(const cv::Mat& src, cv::Mat& dst, const Homography& H, cv::Size dsize,
+                      WarpInterp interp = WARP_BILINEAR, uint8_t border = 0);
+void remap(const cv::Mat& src, cv::Mat& dst, const RemapTable& table, uint8_t border = 0);
+void sauvola_binarize(const cv::Mat& gray, cv::Mat& dst, const SauvolaConfig& cfg = SauvolaConfig());
+
+}  // namespace imgproc
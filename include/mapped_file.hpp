@@ -0,0 +1,129 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief 不溢出的 a * b，溢出时返回 false
+ *
+ * 文件头中的尺寸来自文件本身，相乘、相加前都要检查，否则构造的文件头可以让结果回绕，绕过长度检查。
+ */
+inline bool checked_mul(uint64_t a, uint64_t b, uint64_t& out) { return !__builtin_mul_overflow(a, b, &out); }
+
+/**
+ * @brief 不溢出的 a + b，溢出时返回 false
+ */
+inline bool checked_add(uint64_t a, uint64_t b, uint64_t& out) { return !__builtin_add_overflow(a, b, &out); }
+
+/**
+ * @brief 以 MAP_SHARED 方式映射的整个文件，供各种文件格式（.cimg、分块图像、模型）共用
+ *
+ * 只负责建立、打开、映射文件和检查魔数，格式校验由使用者完成。
+ * 出错时向 std::cerr 输出“无法打开<what>: path”这样的信息，what 为文件的种类。
+ */
+class MappedFile {
+   public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    /**
+     * @brief 新建（覆盖）文件，大小为 size（用 ftruncate 建立，内容为 0），写入文件头后以可写方式映射
+     *
+     * @param path 文件路径
+     * @param size 文件大小
+     * @param header 文件头，写在偏移 0 处
+     * @param header_bytes 文件头的字节数
+     * @param what 文件的种类，用于错误信息
+     *
+     * @return 成功返回 true
+     */
+    bool create(const std::string& path, uint64_t size, const void* header, size_t header_bytes, const char* what) {
+        close();
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "无法创建" << what << ": " << path << std::endl;
+            return false;
+        }
+        if (size < header_bytes || size > (uint64_t)INT64_MAX || ftruncate(fd, (off_t)size) != 0 ||
+            pwrite(fd, header, header_bytes, 0) != (ssize_t)header_bytes) {
+            std::cerr << "无法写入" << what << ": " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        return map(fd, (size_t)size, true, path);
+    }
+
+    /**
+     * @brief 映射已有的文件
+     *
+     * @param path 文件路径
+     * @param writable 是否可写（修改直接写回文件）
+     * @param min_size 文件的最小字节数，更小的文件视为格式错误
+     * @param what 文件的种类，用于错误信息
+     *
+     * @return 成功返回 true
+     */
+    bool open(const std::string& path, bool writable, size_t min_size, const char* what) {
+        close();
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "无法打开" << what << ": " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < min_size || st.st_size == 0) {
+            std::cerr << what << "过小: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        return map(fd, (size_t)st.st_size, writable, path);
+    }
+
+    /**
+     * @brief 解除映射（已写入的内容由系统写回文件）
+     */
+    void close() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        writable_ = false;
+    }
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool writable() const { return writable_; }
+
+    /**
+     * @brief 文件是否以 n 字节的魔数开头
+     */
+    bool has_magic(const char* magic, size_t n) const { return size_ >= n && std::memcmp(data_, magic, n) == 0; }
+
+   private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool writable_ = false;
+
+    bool map(int fd, size_t size, bool writable, const std::string& path) {
+        void* p = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "mmap 失败: " << path << std::endl;
+            return false;
+        }
+        data_ = (uint8_t*)p;
+        size_ = size;
+        writable_ = writable;
+        return true;
+    }
+};
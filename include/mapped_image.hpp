@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "mapped_file.hpp"
+#include "stream.hpp"
+
+/*
+ * 未压缩图像文件格式（.cimg，小端序）
+ *
+ *   MappedImageHeader                  64 字节
+ *   平面 0、1 ...                      从 data_offset（4096）开始，每个平面 height 行，每行 stride 字节
+ *
+ * 交错存储时只有一个平面，元素类型为图像类型；平面存储时每个通道一个单通道平面。
+ * 行跨度对齐到 64 字节、平面对齐到 4096 字节，映射后的每一行都可以直接用于 SIMD 内核。
+ * 进程之间交接中间结果时，读取方只需要一次 mmap，内容来自页缓存，不需要解码或拷贝。
+ */
+
+static const char MAPPED_IMAGE_MAGIC[8] = {'C', 'E', 'D', 'A', 'R', 'I', 'M', 'G'};
+static const uint32_t MAPPED_IMAGE_VERSION = 1;
+static const size_t MAPPED_IMAGE_ROW_ALIGN = 64;
+static const size_t MAPPED_IMAGE_PAGE = 4096;
+
+struct MappedImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t type;  // 图像类型，例如 CV_8UC3
+    uint32_t width;
+    uint32_t height;
+    uint32_t planes;  // 1 为交错存储，否则等于通道数
+    uint32_t reserved0;
+    uint64_t stride;       // 每行字节数
+    uint64_t plane_bytes;  // 每个平面占用的字节数
+    uint64_t data_offset;  // 第一个平面的偏移
+    uint8_t reserved[8];
+};
+
+static_assert(sizeof(MappedImageHeader) == 64, "MappedImageHeader must be 64 bytes");
+
+/**
+ * @brief 通过 mmap 访问的图像（.cimg，或二进制的 PPM / PGM）
+ *
+ * image()、plane() 返回直接指向映射内存的 cv::Mat，在 close 或析构之前有效。
+ * 用 create 新建的文件可写，内核可以把结果直接写进映射（作为 dst 传入时尺寸、类型一致，不会重新分配）。
+ * 注意 PPM 的像素按 RGB 排列，零拷贝的 image() 也是 RGB，需要 BGR 时用 bgr()。
+ */
+class MappedImage {
+   public:
+    MappedImage() {}
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+    ~MappedImage() { close(); }
+
+    /**
+     * @brief 新建（覆盖）.cimg 文件并以可写方式映射，内容为 0
+     *
+     * @param path 文件路径
+     * @param rows 高度
+     * @param cols 宽度
+     * @param type 图像类型
+     * @param planar 是否按通道分平面存储
+     *
+     * @return 成功返回 true
+     */
+    bool create(const std::string& path, int rows, int cols, int type, bool planar = false) {
+        CV_Assert(rows > 0 && cols > 0);
+        close();
+        int cn = CV_MAT_CN(type), planes = planar ? cn : 1;
+        size_t elem = planar ? CV_ELEM_SIZE(type) / cn : CV_ELEM_SIZE(type);
+        MappedImageHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAPPED_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = MAPPED_IMAGE_VERSION;
+        header.type = (uint32_t)type;
+        header.width = (uint32_t)cols;
+        header.height = (uint32_t)rows;
+        header.planes = (uint32_t)planes;
+        header.stride = align(elem * cols, MAPPED_IMAGE_ROW_ALIGN);
+        header.plane_bytes = align(header.stride * rows, MAPPED_IMAGE_PAGE);
+        header.data_offset = MAPPED_IMAGE_PAGE;
+        uint64_t size = header.data_offset + header.plane_bytes * planes;
+        return file_.create(path, size, &header, sizeof(header), "图像文件") && parse(path);
+    }
+
+    /**
+     * @brief 映射已有的 .cimg、PPM（P6）或 PGM（P5）文件
+     *
+     * @param path 文件路径
+     * @param writable 是否可写（修改直接写回文件）
+     *
+     * @return 成功返回 true，文件不存在或格式不支持时返回 false
+     */
+    bool open(const std::string& path, bool writable = false) {
+        close();
+        return file_.open(path, writable, 8, "图像文件") && parse(path);
+    }
+
+    /**
+     * @brief 解除映射
+     */
+    void close() { file_.close(); }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int type() const { return type_; }
+    bool planar() const { return planes_ > 1; }
+    bool rgb() const { return rgb_; }  // PPM 文件，通道按 RGB 排列
+
+    /**
+     * @brief 交错存储的整幅图像（零拷贝），平面存储的文件不能调用
+     */
+    cv::Mat image() const {
+        CV_Assert(file_.data() && !planar());
+        return cv::Mat(rows_, cols_, type_, data_, stride_);
+    }
+
+    /**
+     * @brief 第 i 个通道的平面（零拷贝），只用于平面存储的文件
+     */
+    cv::Mat plane(int i) const {
+        CV_Assert(file_.data() && planar() && i >= 0 && i < planes_);
+        return cv::Mat(rows_, cols_, CV_MAKETYPE(CV_MAT_DEPTH(type_), 1), data_ + plane_bytes_ * i, stride_);
+    }
+
+    /**
+     * @brief BGR 交错排列的图像：.cimg 的交错存储、PGM 直接返回视图，PPM 与平面存储时转换为新图像
+     */
+    cv::Mat bgr() const {
+        if (!planar() && !rgb_) {
+            return image();
+        }
+        cv::Mat out(rows_, cols_, type_);
+        int cn = CV_MAT_CN(type_);
+        size_t es = CV_ELEM_SIZE(type_) / cn;
+        for (int y = 0; y < rows_; ++y) {
+            uint8_t* dst = out.ptr<uint8_t>(y);
+            for (int c = 0; c < cn; ++c) {
+                // PPM 的 R、B 对调；平面存储时逐通道交错
+                int from = rgb_ && cn == 3 ? 2 - c : c;
+                const uint8_t* src = planar() ? data_ + plane_bytes_ * from + stride_ * y
+                                              : data_ + stride_ * y + es * from;
+                size_t step = planar() ? es : es * cn;
+                for (int x = 0; x < cols_; ++x) {
+                    std::memcpy(dst + (x * cn + c) * es, src + x * step, es);
+                }
+            }
+        }
+        return out;
+    }
+
+   private:
+    MappedFile file_;
+    uint8_t* data_ = nullptr;
+    size_t stride_ = 0, plane_bytes_ = 0;
+    int rows_ = 0, cols_ = 0, type_ = 0, planes_ = 1;
+    bool rgb_ = false;
+
+    static size_t align(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+    bool parse(const std::string& path) {
+        bool ok = file_.data()[0] == 'P' ? parse_pnm() : parse_cimg();
+        if (!ok) {
+            std::cerr << "图像格式错误或不支持: " << path << std::endl;
+            close();
+        }
+        return ok;
+    }
+
+    bool parse_cimg() {
+        const MappedImageHeader* h = (const MappedImageHeader*)file_.data();
+        if (file_.size() < sizeof(MappedImageHeader) || !file_.has_magic(MAPPED_IMAGE_MAGIC, sizeof(h->magic)) ||
+            h->version != MAPPED_IMAGE_VERSION || h->width == 0 || h->height == 0 || h->width > INT32_MAX ||
+            h->height > INT32_MAX) {
+            return false;
+        }
+        int cn = CV_MAT_CN((int)h->type);
+        if (h->planes != 1 && h->planes != (uint32_t)cn) {
+            return false;
+        }
+        // 各项尺寸都来自文件头，相乘、相加时检查溢出，回绕的结果会绕过文件大小的检查
+        uint64_t elem = h->planes > 1 ? CV_ELEM_SIZE((int)h->type) / cn : CV_ELEM_SIZE((int)h->type);
+        uint64_t row_bytes, image_bytes, data_bytes, end;
+        if (!checked_mul(elem, h->width, row_bytes) || !checked_mul(h->stride, h->height, image_bytes) ||
+            !checked_mul(h->plane_bytes, h->planes, data_bytes) || !checked_add(h->data_offset, data_bytes, end) ||
+            h->stride < row_bytes || h->plane_bytes < image_bytes || file_.size() < end) {
+            return false;
+        }
+        rows_ = (int)h->height;
+        cols_ = (int)h->width;
+        type_ = (int)h->type;
+        planes_ = (int)h->planes;
+        stride_ = (size_t)h->stride;
+        plane_bytes_ = (size_t)h->plane_bytes;
+        data_ = file_.data() + h->data_offset;
+        rgb_ = false;
+        return true;
+    }
+
+    // 二进制 PNM：P5 / P6，maxval 为 255，数据紧跟在文件头的最后一个空白字符之后
+    bool parse_pnm() {
+        const uint8_t* base = file_.data();
+        size_t size = file_.size();
+        if (base[1] != '5' && base[1] != '6') {
+            return false;
+        }
+        size_t pos = 2;
+        int values[3];
+        for (int& v : values) {
+            while (pos < size && (std::isspace(base[pos]) || base[pos] == '#')) {
+                if (base[pos] == '#') {
+                    while (pos < size && base[pos] != '\n') {
+                        ++pos;
+                    }
+                } else {
+                    ++pos;
+                }
+            }
+            if (pos >= size || !std::isdigit(base[pos])) {
+                return false;
+            }
+            // 超过 int 范围的数值视为格式错误，不能让累加溢出
+            v = 0;
+            while (pos < size && std::isdigit(base[pos])) {
+                int digit = base[pos++] - '0';
+                if (v > (INT32_MAX - digit) / 10) {
+                    return false;
+                }
+                v = v * 10 + digit;
+            }
+        }
+        if (pos >= size || !std::isspace(base[pos]) || values[0] <= 0 || values[1] <= 0 || values[2] != 255) {
+            return false;
+        }
+        int cn = base[1] == '6' ? 3 : 1;
+        cols_ = values[0];
+        rows_ = values[1];
+        type_ = CV_8UC(cn);
+        planes_ = 1;
+        stride_ = (size_t)cols_ * cn;
+        plane_bytes_ = stride_ * rows_;
+        data_ = file_.data() + pos + 1;
+        rgb_ = cn == 3;
+        return size - (pos + 1) >= plane_bytes_;
+    }
+};
+
+/**
+ * @brief 保存为 .cimg
+ *
+ * @param path 文件路径
+ * @param img 图像
+ * @param planar 是否按通道分平面存储
+ *
+ * @return 成功返回 true
+ */
+inline bool save_mapped_image(const std::string& path, const cv::Mat& img, bool planar = false) {
+    MappedImage out;
+    if (!out.create(path, img.rows, img.cols, img.type(), planar)) {
+        return false;
+    }
+    if (!planar) {
+        cv::Mat view = out.image();
+        img.copyTo(view);
+        return true;
+    }
+    int cn = img.channels();
+    size_t es = img.elemSize1();
+    for (int c = 0; c < cn; ++c) {
+        cv::Mat p = out.plane(c);
+        for (int y = 0; y < img.rows; ++y) {
+            const uint8_t* src = img.ptr<uint8_t>(y) + c * es;
+            uint8_t* dst = p.ptr<uint8_t>(y);
+            for (int x = 0; x < img.cols; ++x) {
+                std::memcpy(dst + x * es, src + x * cn * es, es);
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 保存为二进制 PPM（CV_8UC3，按 BGR 解释）或 PGM（CV_8UC1）
+ */
+inline bool save_pnm(const std::string& path, const cv::Mat& img) {
+    FrameWriter writer;
+    return writer.open(path, STREAM_PNM) && writer.write(img);
+}
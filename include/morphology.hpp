@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 形态学运算
+ *
+ * 注意 answer_47 ~ answer_50 中函数名与运算相反：Morphology_Erode 实际是膨胀（白色扩张），
+ * Morphology_Dilate 实际是腐蚀，但开、闭运算的顺序是正确的。
+ */
+enum MorphologyOp {
+    MORPHOLOGY_DILATE,  // 膨胀：邻域最大值（answer_47 的 Morphology_Erode）
+    MORPHOLOGY_ERODE,   // 腐蚀：邻域最小值（answer_48 的 Morphology_Dilate）
+    MORPHOLOGY_OPEN,    // 开运算：先腐蚀 iterations 次再膨胀 iterations 次（answer_49）
+    MORPHOLOGY_CLOSE,   // 闭运算：先膨胀 iterations 次再腐蚀 iterations 次（answer_50）
+};
+
+/**
+ * @brief 形态学参数
+ */
+struct MorphologyConfig {
+    MorphologyOp op = MORPHOLOGY_DILATE;
+    int iterations = 1;   // 膨胀、腐蚀各重复的次数
+    bool square = false;  // false 为 3 × 3 十字形（四邻域，与 answer 相同），true 为 3 × 3 方形
+};
+
+/**
+ * @brief 一次并行遍历最多连续执行的膨胀、腐蚀次数，即块的 halo 上限
+ */
+static const int MORPHOLOGY_MAX_STEPS = 16;
+
+template <bool MAX>
+inline uint8_t morphology_pick(uint8_t a, uint8_t b) {
+    return MAX ? std::max(a, b) : std::min(a, b);
+}
+
+#if defined(__SSE2__)
+template <bool MAX>
+inline __m128i morphology_pick(__m128i a, __m128i b) {
+    return MAX ? _mm_max_epu8(a, b) : _mm_min_epu8(a, b);
+}
+#endif
+
+/**
+ * @brief 逐元素三行取最大（最小）值：out[i] = pick(a[i], b[i], c[i])，out 可以与 b 相同
+ */
+template <bool MAX>
+inline void morphology_vertical(const uint8_t* a, const uint8_t* b, const uint8_t* c, int n, uint8_t* out) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = morphology_pick<MAX>(_mm_loadu_si128((const __m128i*)(a + i)),
+                                         _mm_loadu_si128((const __m128i*)(b + i)));
+        v = morphology_pick<MAX>(v, _mm_loadu_si128((const __m128i*)(c + i)));
+        _mm_storeu_si128((__m128i*)(out + i), v);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = morphology_pick<MAX>(morphology_pick<MAX>(a[i], b[i]), c[i]);
+    }
+}
+
+/**
+ * @brief 一行内左右相邻像素取最大（最小）值，图像外的像素不参与（out 不能与 src 相同）
+ *
+ * @param src 源行
+ * @param width 像素数
+ * @param cn 通道数
+ * @param out 结果
+ */
+template <bool MAX>
+inline void morphology_horizontal(const uint8_t* src, int width, int cn, uint8_t* out) {
+    int n = width * cn;
+    if (width == 1) {
+        std::memcpy(out, src, cn);
+        return;
+    }
+    for (int i = 0; i < cn; ++i) {
+        out[i] = morphology_pick<MAX>(src[i], src[i + cn]);
+        out[n - cn + i] = morphology_pick<MAX>(src[n - cn + i], src[n - 2 * cn + i]);
+    }
+    int i = cn;
+#if defined(__SSE2__)
+    for (; i + cn + 16 <= n; i += 16) {
+        __m128i v = morphology_pick<MAX>(_mm_loadu_si128((const __m128i*)(src + i - cn)),
+                                         _mm_loadu_si128((const __m128i*)(src + i)));
+        v = morphology_pick<MAX>(v, _mm_loadu_si128((const __m128i*)(src + i + cn)));
+        _mm_storeu_si128((__m128i*)(out + i), v);
+    }
+#endif
+    for (; i < n - cn; ++i) {
+        out[i] = morphology_pick<MAX>(morphology_pick<MAX>(src[i - cn], src[i]), src[i + cn]);
+    }
+}
+
+/**
+ * @brief 对一块缓冲区做一次膨胀（MAX）或腐蚀，缓冲区外的像素视为不存在
+ *
+ * 缓冲区的边缘不是图像边缘时，边缘一圈的结果是错误的，每做一次向内扩散一个像素，由块的 halo 吸收。
+ */
+template <bool MAX>
+inline void morphology_block(const uint8_t* src, int width, int height, int cn, bool square, uint8_t* tmp,
+                             uint8_t* dst) {
+    size_t row = (size_t)width * cn;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* mid = src + y * row;
+        const uint8_t* up = y > 0 ? mid - row : mid;
+        const uint8_t* down = y + 1 < height ? mid + row : mid;
+        uint8_t* out = dst + y * row;
+        if (square) {
+            morphology_vertical<MAX>(up, mid, down, (int)row, tmp);
+            morphology_horizontal<MAX>(tmp, width, cn, out);
+        } else {
+            morphology_horizontal<MAX>(mid, width, cn, out);
+            morphology_vertical<MAX>(up, out, down, (int)row, out);
+        }
+    }
+}
+
+/**
+ * @brief 一次并行遍历：对 src 依次执行 steps[0..n) 次膨胀（非 0）或腐蚀（0），写入 dst
+ *
+ * 图像分成 128 × 128 的块，每块连同 n 个像素的 halo 复制到局部缓冲区中连续做完 n 次，
+ * 块之间不需要同步，中间结果也不写回图像。局部缓冲区由 ParallelSlots 复用，稳定后不再申请内存。
+ */
+inline void morphology_pass(const cv::Mat& src, cv::Mat& dst, const uint8_t* steps, int n, bool square) {
+    struct Buffers {
+        std::vector<uint8_t> a, b, tmp;
+    };
+    const int TILE = 128;
+    int cn = src.channels();
+    size_t max_row = (size_t)std::min(TILE + 2 * n, src.cols) * cn, max_rows = std::min(TILE + 2 * n, src.rows);
+    // 任务中通过引用访问发起线程的状态
+    thread_local ParallelSlots<Buffers> local_slots;
+    ParallelSlots<Buffers>& slots = local_slots;
+    slots.prepare(parallel_threads(), [&](Buffers& buf) {
+        if (buf.a.size() < max_row * max_rows) {
+            buf.a.resize(max_row * max_rows);
+            buf.b.resize(max_row * max_rows);
+        }
+        if (buf.tmp.size() < max_row) {
+            buf.tmp.resize(max_row);
+        }
+    });
+    parallel_for_tiles(src.cols, src.rows, TILE, TILE, n, [&](const ParallelTile& t) {
+        slots.use([&](Buffers& buf) {
+            int bw = t.x.halo_end - t.x.halo_begin, bh = t.y.halo_end - t.y.halo_begin;
+            size_t row = (size_t)bw * cn;
+            uint8_t *a = buf.a.data(), *b = buf.b.data(), *tmp = buf.tmp.data();
+            for (int y = 0; y < bh; ++y) {
+                std::memcpy(a + y * row, src.ptr<uint8_t>(t.y.halo_begin + y) + (size_t)t.x.halo_begin * cn, row);
+            }
+            for (int s = 0; s < n; ++s) {
+                if (steps[s]) {
+                    morphology_block<true>(a, bw, bh, cn, square, tmp, b);
+                } else {
+                    morphology_block<false>(a, bw, bh, cn, square, tmp, b);
+                }
+                std::swap(a, b);
+            }
+            size_t offset = (size_t)(t.x.begin - t.x.halo_begin) * cn, len = (size_t)(t.x.end - t.x.begin) * cn;
+            for (int y = t.y.begin; y < t.y.end; ++y) {
+                std::memcpy(dst.ptr<uint8_t>(y) + (size_t)t.x.begin * cn, a + (y - t.y.halo_begin) * row + offset, len);
+            }
+        });
+    });
+}
+
+/**
+ * @brief 形态学运算（灰度形态学，对二值图像与 answer_47 ~ answer_50 的结果相同）
+ *
+ * 膨胀、腐蚀展开为逐次的邻域最大、最小值，每 MORPHOLOGY_MAX_STEPS 次为一次并行遍历。
+ * 多通道图像各通道独立处理。可以原地执行（dst 与 src 相同）。
+ *
+ * @param src CV_8U 图像
+ * @param dst 结果
+ * @param cfg 参数
+ */
+inline void morphology(const cv::Mat& src, cv::Mat& dst, const MorphologyConfig& cfg = MorphologyConfig()) {
+    CV_Assert(src.depth() == CV_8U && cfg.iterations >= 0);
+    bool dilate_first = cfg.op == MORPHOLOGY_DILATE || cfg.op == MORPHOLOGY_CLOSE;
+    bool twice = cfg.op == MORPHOLOGY_OPEN || cfg.op == MORPHOLOGY_CLOSE;
+    int total = cfg.iterations * (twice ? 2 : 1);
+
+    bool alias = dst.data == src.data;
+    cv::Mat cur = src;
+    for (int i = 0; i < total; i += MORPHOLOGY_MAX_STEPS) {
+        int n = std::min(total - i, MORPHOLOGY_MAX_STEPS);
+        // 第 s 次为膨胀（1）或腐蚀（0）：前 iterations 次与后 iterations 次相反
+        uint8_t steps[MORPHOLOGY_MAX_STEPS];
+        for (int j = 0; j < n; ++j) {
+            steps[j] = (i + j < cfg.iterations) == dilate_first;
+        }
+        cv::Mat out;
+        if (i + n == total && !alias) {
+            dst.create(src.rows, src.cols, src.type());
+            out = dst;
+        } else {
+            out.create(src.rows, src.cols, src.type());
+        }
+        morphology_pass(cur, out, steps, n, cfg.square);
+        cur = out;
+    }
+    if (cur.data != dst.data) {
+        cur.copyTo(dst);
+    }
+}
+
+/**
+ * @brief 形态学运算（返回新图像）
+ */
+inline cv::Mat morphology(const cv::Mat& src, const MorphologyConfig& cfg = MorphologyConfig()) {
+    cv::Mat dst;
+    morphology(src, dst, cfg);
+    return dst;
+}
+
+/**
+ * @brief 最大-最小滤波（answer_13）：kernel_size × kernel_size 邻域内的最大值减最小值
+ *
+ * 与 answer_13 一样只统计图像内的像素。方形邻域的最大（最小）值等于 kernel_size / 2 次 3 × 3 方形膨胀（腐蚀），
+ * 两者各用一次并行遍历（kernel_size / 2 不超过 MORPHOLOGY_MAX_STEPS 时）。多通道图像各通道独立处理。
+ *
+ * @param img CV_8U 图像
+ * @param kernel_size 邻域大小（奇数）
+ */
+inline cv::Mat max_min_filter(const cv::Mat& img, int kernel_size) {
+    CV_Assert(img.depth() == CV_8U && kernel_size >= 1);
+    MorphologyConfig cfg;
+    cfg.iterations = kernel_size / 2;
+    cfg.square = true;
+    cv::Mat hi = morphology(img, cfg);
+    cfg.op = MORPHOLOGY_ERODE;
+    cv::Mat lo = morphology(img, cfg);
+
+    int n = img.cols * img.channels();
+    parallel_for_rows(img.rows, 0, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            uint8_t* a = hi.ptr<uint8_t>(y);
+            const uint8_t* b = lo.ptr<uint8_t>(y);
+            int x = 0;
+#if defined(__SSE2__)
+            for (; x + 16 <= n; x += 16) {
+                __m128i va = _mm_loadu_si128((const __m128i*)(a + x));
+                __m128i vb = _mm_loadu_si128((const __m128i*)(b + x));
+                _mm_storeu_si128((__m128i*)(a + x), _mm_sub_epi8(va, vb));
+            }
+#endif
+            for (; x < n; ++x) {
+                a[x] = (uint8_t)(a[x] - b[x]);
+            }
+        }
+    });
+    return hi;
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief 9 个字节向量排序（奇偶换位排序，9 轮 36 次 pminub/pmaxub），v[0] 最小
+ */
+inline void median_sort9(__m128i* v) {
+    for (int round = 0; round < 9; ++round) {
+        for (int i = round & 1; i + 1 < 9; i += 2) {
+            __m128i lo = _mm_min_epu8(v[i], v[i + 1]);
+            v[i + 1] = _mm_max_epu8(v[i], v[i + 1]);
+            v[i] = lo;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief 中值滤波（answer_10）
+ *
+ * 与 answer_10 逐位相同：上、左边界外的像素不参与，右、下边界外的像素按 0 计
+ * （answer_10 在那里越界读取，见 verify 中的 with_zero_margin）；窗口内的 count 个值排序后取下标 count / 2 + 1，
+ * 所以窗口完整时取的是第 kernel_size² / 2 + 2 小的值，比严格的中位数大一位。
+ * 3 × 3 时，窗口完整的像素用 SSE2 排序网络一次处理 16 个字节；其余像素用 nth_element。
+ * 各行并行处理，多通道图像各通道独立。
+ *
+ * @param img CV_8U 图像
+ * @param kernel_size 邻域大小（不小于 3 的奇数）
+ */
+inline cv::Mat median_filter(const cv::Mat& img, int kernel_size) {
+    CV_Assert(img.depth() == CV_8U && kernel_size >= 3 && kernel_size % 2 == 1);
+    int r = kernel_size / 2, cn = img.channels(), width = img.cols, height = img.rows, n = width * cn;
+    cv::Mat out(height, width, img.type());
+
+    parallel_for_rows(height, 0, [&](const ParallelRange& band) {
+        std::vector<uint8_t> values((size_t)kernel_size * kernel_size);
+        auto pixel = [&](int y, int x, int c) {
+            int count = 0;
+            for (int yy = std::max(y - r, 0); yy <= y + r; ++yy) {
+                const uint8_t* row = yy < height ? img.ptr<uint8_t>(yy) : nullptr;
+                for (int xx = std::max(x - r, 0); xx <= x + r; ++xx) {
+                    values[count++] = row && xx < width ? row[xx * cn + c] : 0;
+                }
+            }
+            int k = count / 2 + 1;
+            std::nth_element(values.begin(), values.begin() + k, values.begin() + count);
+            return values[k];
+        };
+
+        // 3 × 3 的快速路径：三行各拷贝到右侧补 0 的缓冲中，第 i 个字节的左、中、右为 buf[i - cn]、buf[i]、buf[i + cn]
+        size_t pitch = n + cn + 16;
+        std::vector<uint8_t> padded(kernel_size == 3 ? 3 * pitch : 0, 0);
+        for (int y = band.begin; y < band.end; ++y) {
+            uint8_t* dst = out.ptr<uint8_t>(y);
+            int done = cn;  // [cn, done) 由快速路径算出
+#if defined(__SSE2__)
+            if (kernel_size == 3 && y > 0) {
+                for (int j = 0; j < 3; ++j) {
+                    if (y - 1 + j < height) {
+                        std::memcpy(&padded[j * pitch], img.ptr<uint8_t>(y - 1 + j), n);
+                    } else {
+                        std::memset(&padded[j * pitch], 0, n);
+                    }
+                }
+                for (; done + 16 <= n; done += 16) {
+                    __m128i v[9];
+                    for (int j = 0; j < 3; ++j) {
+                        const uint8_t* buf = &padded[j * pitch] + done;
+                        v[j * 3] = _mm_loadu_si128((const __m128i*)(buf - cn));
+                        v[j * 3 + 1] = _mm_loadu_si128((const __m128i*)buf);
+                        v[j * 3 + 2] = _mm_loadu_si128((const __m128i*)(buf + cn));
+                    }
+                    median_sort9(v);
+                    _mm_storeu_si128((__m128i*)(dst + done), v[5]);
+                }
+            }
+#endif
+            for (int i = 0; i < std::min(cn, n); ++i) {
+                dst[i] = pixel(y, i / cn, i % cn);
+            }
+            for (int i = done; i < n; ++i) {
+                dst[i] = pixel(y, i / cn, i % cn);
+            }
+        }
+    });
+    return out;
+}
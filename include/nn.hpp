@@ -0,0 +1,160 @@
+#pragma once
+
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "nn_kernels.hpp"
+
+class NN {
+   private:
+    xt::xarray<double> w1, b1, w2, b2, wout, bout;
+    xt::xarray<double> z2, z3, out;
+    double learning_rate;
+
+    /**
+     * @brief 融合的全连接层 + Sigmoid
+     *
+     * 调用 dense_sigmoid 直接把 sigmoid(x · w + b) 写入 y。y 的形状不变时复用已有缓冲区，不再分配内存。
+     * x 的列数必须等于 w 的行数，b 的长度必须等于 w 的列数，否则抛出 std::invalid_argument。
+     *
+     * @param x 输入，batch × in_dim
+     * @param w 权重，in_dim × out_dim
+     * @param b 偏置，out_dim
+     * @param y 输出，batch × out_dim
+     */
+    static void dense_forward(const xt::xarray<double>& x, const xt::xarray<double>& w, const xt::xarray<double>& b,
+                              xt::xarray<double>& y) {
+        if (x.dimension() != 2 || w.dimension() != 2 || x.shape()[1] != w.shape()[0] || b.size() != w.shape()[1]) {
+            throw std::invalid_argument("dense_forward: 形状不匹配");
+        }
+        size_t rows = x.shape()[0];
+        size_t in_dim = w.shape()[0];
+        size_t out_dim = w.shape()[1];
+
+        if (y.dimension() != 2 || y.shape()[0] != rows || y.shape()[1] != out_dim) {
+            y = xt::xarray<double>::from_shape({rows, out_dim});
+        }
+
+        dense_sigmoid(x.data(), (int)rows, (int)in_dim, w.data(), b.data(), (int)out_dim, y.data());
+    }
+
+   public:
+    /**
+     * @brief 构造函数，初始化神经网络
+     *
+     * 初始化神经网络的权重和偏置，包括输入层到隐藏层、隐藏层到隐藏层以及隐藏层到输出层的权重和偏置。
+     *
+     * @param input_dim 输入层维度，默认为2
+     * @param hidden_dim 第一个隐藏层维度，默认为64
+     * @param hidden_dim2 第二个隐藏层维度，默认为64
+     * @param output_dim 输出层维度，默认为1
+     * @param lr 学习率，默认为0.1
+     */
+    NN(int input_dim = 2, int hidden_dim = 64, int hidden_dim2 = 64, int output_dim = 1, double lr = 0.1) {
+        // 初始化权重和偏置
+        w1 = xt::random::randn<double>({input_dim, hidden_dim});
+        b1 = xt::random::randn<double>({hidden_dim});
+        w2 = xt::random::randn<double>({hidden_dim, hidden_dim2});
+        b2 = xt::random::randn<double>({hidden_dim2});
+        wout = xt::random::randn<double>({hidden_dim2, output_dim});
+        bout = xt::random::randn<double>({output_dim});
+        learning_rate = lr;
+    }
+
+    /**
+     * @brief 前向传播
+     *
+     * 根据给定的输入数组 x，执行前向传播计算并返回输出结果。
+     * 每一层都是一次融合的 dot + bias + sigmoid，中间结果直接写入 z2、z3、out。
+     *
+     * @param x 输入数组，batch × input_dim，行主序
+     *
+     * @return 输出结果数组
+     */
+    xt::xarray<double> forward(const xt::xarray<double>& x) {
+        // 前向传播
+        dense_forward(x, w1, b1, z2);
+        dense_forward(z2, w2, b2, z3);
+        dense_forward(z3, wout, bout, out);
+
+        return out;
+    }
+
+    /**
+     * @brief 获取各层参数的只读视图
+     *
+     * 按输入层到输出层的顺序返回。视图直接指向网络内部的参数，NN 析构后失效。
+     *
+     * @return 各层的 DenseLayerView
+     */
+    std::vector<DenseLayerView> layers() const {
+        return {{(int)w1.shape()[0], (int)w1.shape()[1], w1.data(), b1.data()},
+                {(int)w2.shape()[0], (int)w2.shape()[1], w2.data(), b2.data()},
+                {(int)wout.shape()[0], (int)wout.shape()[1], wout.data(), bout.data()}};
+    }
+
+    /**
+     * @brief 从参数视图加载权重和偏置
+     *
+     * 把外部的参数（例如 MappedNN 映射的模型文件）拷贝进网络，之后可以继续训练。
+     * 层数必须为 3，且相邻层的维度能够衔接。
+     *
+     * @param views 各层参数
+     *
+     * @return 成功返回 true
+     */
+    bool load_layers(const std::vector<DenseLayerView>& views) {
+        if (views.size() != 3 || views[0].out_dim != views[1].in_dim || views[1].out_dim != views[2].in_dim) {
+            return false;
+        }
+
+        xt::xarray<double>* ws[] = {&w1, &w2, &wout};
+        xt::xarray<double>* bs[] = {&b1, &b2, &bout};
+        for (int i = 0; i < 3; ++i) {
+            const DenseLayerView& v = views[i];
+            *ws[i] = xt::xarray<double>::from_shape({(size_t)v.in_dim, (size_t)v.out_dim});
+            *bs[i] = xt::xarray<double>::from_shape({(size_t)v.out_dim});
+            std::copy(v.w, v.w + (size_t)v.in_dim * v.out_dim, ws[i]->data());
+            std::copy(v.b, v.b + v.out_dim, bs[i]->data());
+        }
+        return true;
+    }
+
+    /**
+     * @brief 训练函数
+     *
+     * 使用给定的输入和目标进行训练，更新权重和偏置。
+     *
+     * @param x 输入数据
+     * @param t 目标数据
+     */
+    void train(const xt::xarray<double>& x, const xt::xarray<double>& t) {
+        // 训练
+
+        forward(x);
+        xt::xarray<double> En = (out - t) * out * (1 - out);
+
+        // 更新输出层权重和偏置
+        wout -= learning_rate * xt::linalg::dot(xt::transpose(z3), En);
+        bout -= learning_rate * xt::sum(En, {0});
+
+        // 计算误差传播到第二层的梯度
+        xt::xarray<double> grad_u2 = xt::linalg::dot(En, xt::transpose(wout)) * z3 * (1 - z3);
+
+        // 更新第二层权重和偏置
+        w2 -= learning_rate * xt::linalg::dot(xt::transpose(z2), grad_u2);
+        b2 -= learning_rate * xt::sum(grad_u2, {0});
+
+        // 计算误差传播到第一层的梯度
+        xt::xarray<double> grad_u1 = xt::linalg::dot(grad_u2, xt::transpose(w2)) * z2 * (1 - z2);
+
+        // 更新第一层权重和偏置
+        w1 -= learning_rate * xt::linalg::dot(xt::transpose(x), grad_u1);
+        b1 -= learning_rate * xt::sum(grad_u1, {0});
+    }
+};
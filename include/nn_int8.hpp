@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "nn_kernels.hpp"
+
+/*
+ * u8 × s8 点积：a 为无符号激活值（0~127），b 为有符号权重（-127~127），n 必须是 64 的倍数。
+ * 激活值限制在 7 bit，保证 pmaddubsw 的相邻两项之和不会在 int16 上饱和，
+ * 这样 VNNI、AVX2、SSSE3 和标量路径的结果完全一致。
+ *
+ * 各 SIMD 版本用 target 属性单独编译，不需要 -mavx2 等编译选项（compile_and_run.sh 只用 -O2）；
+ * 第一次调用 dot_u8s8 时按 cpuid 选择，与 libimgproc 相同，环境变量 IMGPROC_CPU 可以指定上限。
+ */
+
+inline int32_t dot_u8s8_scalar(const uint8_t* a, const int8_t* b, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc += (int32_t)a[i] * (int32_t)b[i];
+    }
+    return acc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("ssse3"))) inline int32_t dot_u8s8_ssse3(const uint8_t* a, const int8_t* b, int n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i p16 = _mm_maddubs_epi16(va, vb);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(p16, ones));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+}
+
+__attribute__((target("avx2"))) inline int32_t dot_u8s8_avx2(const uint8_t* a, const int8_t* b, int n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        // u8 × s8 -> 相邻两项相加得到 int16，再与 1 做 madd 扩展为 int32
+        __m256i p16 = _mm256_maddubs_epi16(va, vb);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(p16, ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) inline int32_t dot_u8s8_vnni(const uint8_t* a,
+                                                                                    const int8_t* b, int n) {
+    __m512i acc = _mm512_setzero_si512();
+    for (int i = 0; i < n; i += 64) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        acc = _mm512_dpbusd_epi32(acc, va, vb);
+    }
+    // 手工归约：GCC 12 的 _mm512_reduce_add_epi32、_mm512_extracti64x4_epi64 和 _mm512_castsi512_si256
+    // 以未初始化的寄存器作为掩码的源，会触发 -Wuninitialized；两半都用全选掩码的 maskz 版本取出
+    __m256i lo = _mm512_maskz_extracti64x4_epi64(0xFF, acc, 0), hi = _mm512_maskz_extracti64x4_epi64(0xFF, acc, 1);
+    __m256i h = _mm256_add_epi32(lo, hi);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+typedef int32_t (*DotU8S8Fn)(const uint8_t* a, const int8_t* b, int n);
+
+/**
+ * @brief 当前 CPU 支持的最快的点积版本
+ *
+ * @param name 不为空时输出版本名（scalar / ssse3 / avx2 / vnni）
+ */
+inline DotU8S8Fn dot_u8s8_select(const char** name = nullptr) {
+    const char* use = "scalar";
+    DotU8S8Fn fn = dot_u8s8_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+    // IMGPROC_CPU 的取值与 libimgproc 相同：baseline < sse42 < avx2 < avx512
+    int cap = 3;
+    if (const char* env = std::getenv("IMGPROC_CPU")) {
+        const char* levels[] = {"baseline", "sse42", "avx2", "avx512"};
+        for (int i = 0; i < 4; ++i) {
+            if (std::strcmp(env, levels[i]) == 0) {
+                cap = i;
+            }
+        }
+    }
+    __builtin_cpu_init();
+    if (cap >= 3 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vnni")) {
+        use = "vnni";
+        fn = dot_u8s8_vnni;
+    } else if (cap >= 2 && __builtin_cpu_supports("avx2")) {
+        use = "avx2";
+        fn = dot_u8s8_avx2;
+    } else if (cap >= 1 && __builtin_cpu_supports("ssse3")) {
+        use = "ssse3";
+        fn = dot_u8s8_ssse3;
+    }
+#endif
+    if (name) {
+        *name = use;
+    }
+    return fn;
+}
+
+/**
+ * @brief u8 × s8 点积，累加到 int32（运行时选择的版本）
+ *
+ * @param a 激活值
+ * @param b 权重
+ * @param n 长度
+ *
+ * @return 点积
+ */
+inline int32_t dot_u8s8(const uint8_t* a, const int8_t* b, int n) {
+    static const DotU8S8Fn fn = dot_u8s8_select();
+    return fn(a, b, n);
+}
+
+/**
+ * @brief 量化后的全连接层
+ *
+ * 输入按 x ≈ in_scale * (q - in_zero) 量化为 0~127，
+ * 权重按输出通道对称量化为 -127~127，转置后每个输出通道连续存放并补零到 64 的倍数。
+ */
+struct QuantizedLayer {
+    int in_dim;
+    int out_dim;
+    int in_pad;                  // in_dim 向上对齐到 64
+    float in_scale;              // 输入 scale
+    int in_zero;                 // 输入零点
+    std::vector<int8_t> w;       // out_dim × in_pad
+    std::vector<float> w_scale;  // 每个输出通道的权重 scale
+    std::vector<int32_t> w_sum;  // 每个输出通道的权重和，用于扣除输入零点
+    std::vector<float> bias;
+    float lut_range;             // Sigmoid 查找表覆盖 [-lut_range, lut_range]
+    std::vector<uint8_t> lut;    // Sigmoid 查找表，输出 0~127
+};
+
+/**
+ * @brief int8 推理网络
+ *
+ * 由训练好的浮点网络经训练后量化（post-training quantization）得到。
+ * 隐藏层的 Sigmoid 输出天然落在 [0, 1]，固定用 1/127 的 scale；
+ * 第一层输入和各层 Sigmoid 查找表的定义域由校准样本统计得到。
+ */
+class QuantizedNN {
+   public:
+    static const int LUT_SIZE = 1024;
+
+    /**
+     * @brief 用校准样本量化网络
+     *
+     * 用浮点路径跑一遍校准样本，统计输入的取值范围和每层激活前的最大绝对值，
+     * 据此确定输入的 scale/零点和 Sigmoid 查找表的定义域；权重按输出通道取最大绝对值量化。
+     *
+     * @param layers 浮点网络各层参数
+     * @param samples 校准样本，n × layers[0].in_dim，行主序
+     * @param n 样本个数
+     */
+    QuantizedNN(const std::vector<DenseLayerView>& layers, const double* samples, int n) {
+        // 统计输入范围，范围必须包含 0，保证零点可以精确表示
+        double in_min = 0, in_max = 0;
+        int in_dim = layers[0].in_dim;
+        for (int i = 0; i < n * in_dim; ++i) {
+            in_min = std::min(in_min, samples[i]);
+            in_max = std::max(in_max, samples[i]);
+        }
+
+        // 浮点前向，统计每层激活前的最大绝对值
+        std::vector<double> z_absmax(layers.size(), 0);
+        std::vector<double> h, z;
+        for (int s = 0; s < n; ++s) {
+            h.assign(samples + (size_t)s * in_dim, samples + (size_t)(s + 1) * in_dim);
+            for (size_t l = 0; l < layers.size(); ++l) {
+                const DenseLayerView& L = layers[l];
+                z.assign(L.b, L.b + L.out_dim);
+                for (int k = 0; k < L.in_dim; ++k) {
+                    for (int j = 0; j < L.out_dim; ++j) {
+                        z[j] += h[k] * L.w[(size_t)k * L.out_dim + j];
+                    }
+                }
+                for (int j = 0; j < L.out_dim; ++j) {
+                    z_absmax[l] = std::max(z_absmax[l], std::fabs(z[j]));
+                    z[j] = fast_sigmoid(z[j]);
+                }
+                h.swap(z);
+            }
+        }
+
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const DenseLayerView& L = layers[l];
+            QuantizedLayer q;
+            q.in_dim = L.in_dim;
+            q.out_dim = L.out_dim;
+            q.in_pad = (L.in_dim + 63) / 64 * 64;
+
+            // 输入量化参数：第一层来自校准，其余层是 Sigmoid 输出
+            if (l == 0) {
+                q.in_scale = (float)std::max((in_max - in_min) / 127.0, 1e-12);
+                q.in_zero = (int)std::lround(-in_min / q.in_scale);
+            } else {
+                q.in_scale = 1.0f / 127.0f;
+                q.in_zero = 0;
+            }
+
+            // 权重按输出通道对称量化并转置
+            q.w.assign((size_t)q.out_dim * q.in_pad, 0);
+            q.w_scale.resize(q.out_dim);
+            q.w_sum.resize(q.out_dim);
+            q.bias.resize(q.out_dim);
+            for (int j = 0; j < q.out_dim; ++j) {
+                double absmax = 1e-12;
+                for (int k = 0; k < q.in_dim; ++k) {
+                    absmax = std::max(absmax, std::fabs(L.w[(size_t)k * q.out_dim + j]));
+                }
+                q.w_scale[j] = (float)(absmax / 127.0);
+
+                int32_t sum = 0;
+                for (int k = 0; k < q.in_dim; ++k) {
+                    long v = std::lround(L.w[(size_t)k * q.out_dim + j] / q.w_scale[j]);
+                    v = std::min(127L, std::max(-127L, v));
+                    q.w[(size_t)j * q.in_pad + k] = (int8_t)v;
+                    sum += (int32_t)v;
+                }
+                q.w_sum[j] = sum;
+                q.bias[j] = (float)L.b[j];
+            }
+
+            // Sigmoid 查找表，超出定义域的部分已经饱和
+            q.lut_range = (float)std::min(std::max(z_absmax[l], 1.0), 16.0);
+            q.lut.resize(LUT_SIZE);
+            for (int i = 0; i < LUT_SIZE; ++i) {
+                double zi = -q.lut_range + 2.0 * q.lut_range * i / (LUT_SIZE - 1);
+                q.lut[i] = (uint8_t)std::lround(127.0 * fast_sigmoid(zi));
+            }
+
+            max_pad_ = std::max(max_pad_, std::max(q.in_pad, (q.out_dim + 63) / 64 * 64));
+            layers_.push_back(q);
+        }
+    }
+
+    /**
+     * @brief 前向传播的激活值缓冲，大小不变时不再分配内存
+     */
+    struct Scratch {
+        std::vector<uint8_t> cur, next;
+    };
+
+    /**
+     * @brief int8 前向传播
+     *
+     * 隐藏层全程使用 u8 激活值和 int32 累加，只有输出层用浮点 Sigmoid 给出概率。
+     * 激活值写在调用方提供的 scratch 中，多个线程可以各用自己的 scratch 同时调用。
+     *
+     * @param x 输入，rows × in_dim，行主序
+     * @param rows 行数
+     * @param out 输出，rows × out_dim
+     * @param scratch 激活值缓冲
+     */
+    void forward(const double* x, int rows, double* out, Scratch& scratch) const {
+        std::vector<uint8_t>& cur = scratch.cur;
+        std::vector<uint8_t>& next = scratch.next;
+        cur.resize(max_pad_);
+        next.resize(max_pad_);
+
+        const QuantizedLayer& first = layers_.front();
+        const QuantizedLayer& last = layers_.back();
+
+        for (int r = 0; r < rows; ++r) {
+            // 量化输入
+            const double* xr = x + (size_t)r * first.in_dim;
+            std::fill(cur.begin(), cur.end(), 0);
+            for (int k = 0; k < first.in_dim; ++k) {
+                long v = std::lround(xr[k] / first.in_scale) + first.in_zero;
+                cur[k] = (uint8_t)std::min(127L, std::max(0L, v));
+            }
+
+            for (size_t l = 0; l < layers_.size(); ++l) {
+                const QuantizedLayer& q = layers_[l];
+                float lut_step = (LUT_SIZE - 1) / (2.0f * q.lut_range);
+                std::fill(next.begin(), next.end(), 0);
+
+                for (int j = 0; j < q.out_dim; ++j) {
+                    int32_t acc = dot_u8s8(cur.data(), &q.w[(size_t)j * q.in_pad], q.in_pad);
+                    float z = q.in_scale * q.w_scale[j] * (float)(acc - q.in_zero * q.w_sum[j]) + q.bias[j];
+
+                    if (&q == &last) {
+                        out[(size_t)r * q.out_dim + j] = fast_sigmoid(z);
+                    } else {
+                        // 查表得到下一层的 u8 激活值
+                        int idx = (int)((z + q.lut_range) * lut_step + 0.5f);
+                        idx = std::min(LUT_SIZE - 1, std::max(0, idx));
+                        next[j] = q.lut[idx];
+                    }
+                }
+                cur.swap(next);
+            }
+        }
+    }
+
+    /**
+     * @brief int8 前向传播，使用本实例的缓冲（同一个实例不能在多个线程上同时调用）
+     */
+    void forward(const double* x, int rows, double* out) { forward(x, rows, out, scratch_); }
+
+    const std::vector<QuantizedLayer>& layers() const { return layers_; }
+
+   private:
+    std::vector<QuantizedLayer> layers_;
+    int max_pad_ = 0;  // 各层输入、输出补齐后的最大长度
+    Scratch scratch_;
+};
+
+/**
+ * @brief 量化误差报告
+ */
+struct QuantizationReport {
+    double max_abs_diff;   // 输出的最大绝对误差
+    double mean_abs_diff;  // 输出的平均绝对误差
+    double float_acc;      // 浮点路径的准确率
+    double int8_acc;       // int8 路径的准确率
+    double agreement;      // 两条路径判定结果一致的比例
+};
+
+/**
+ * @brief 比较 int8 路径与浮点路径
+ *
+ * 两条路径在同一批样本上分别推理，输出按阈值 th 二值化后与标签比较。
+ *
+ * @param layers 浮点网络各层参数
+ * @param qnn 量化网络
+ * @param x 样本，n × in_dim
+ * @param t 标签，n × out_dim
+ * @param n 样本个数
+ * @param th 判定阈值，默认为 0.5
+ *
+ * @return 误差报告
+ */
+inline QuantizationReport compare_quantized(const std::vector<DenseLayerView>& layers, const QuantizedNN& qnn,
+                                            const double* x, const double* t, int n, double th = 0.5) {
+    // 浮点参考
+    int out_dim = layers.back().out_dim;
+    std::vector<double> a((size_t)n * out_dim), s0, s1;
+    mlp_forward(layers, x, n, a.data(), s0, s1);
+
+    std::vector<double> q((size_t)n * out_dim);
+    QuantizedNN::Scratch scratch;
+    qnn.forward(x, n, q.data(), scratch);
+
+    QuantizationReport rep = {0, 0, 0, 0, 0};
+    int total = n * out_dim;
+    for (int i = 0; i < total; ++i) {
+        double d = std::fabs(a[i] - q[i]);
+        rep.max_abs_diff = std::max(rep.max_abs_diff, d);
+        rep.mean_abs_diff += d;
+
+        bool pf = a[i] >= th, pq = q[i] >= th, gt = t[i] >= th;
+        rep.float_acc += (pf == gt);
+        rep.int8_acc += (pq == gt);
+        rep.agreement += (pf == pq);
+    }
+    rep.mean_abs_diff /= total;
+    rep.float_acc /= total;
+    rep.int8_acc /= total;
+    rep.agreement /= total;
+
+    return rep;
+}
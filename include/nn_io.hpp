@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "nn_kernels.hpp"
+
+/*
+ * 模型文件格式（小端序）
+ *
+ *   NNFileHeader                       64 字节
+ *   NNFileLayer × num_layers           每项 32 字节
+ *   权重块、偏置块                      每块起始位置对齐到 64 字节
+ *
+ * 权重为行主序的 in_dim × out_dim，偏置为 out_dim，均为 float64。
+ * 文件映射到内存后可以直接作为 DenseLayerView 使用，不需要任何拷贝。
+ */
+
+static const char NN_FILE_MAGIC[8] = {'C', 'E', 'D', 'A', 'R', 'N', 'N', '\0'};
+static const uint32_t NN_FILE_VERSION = 1;
+static const uint32_t NN_FILE_BYTE_ORDER = 0x01020304;
+static const uint32_t NN_DTYPE_F64 = 1;
+static const size_t NN_FILE_ALIGN = 64;
+
+struct NNFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t dtype;
+    uint32_t num_layers;
+    uint64_t file_size;
+    uint8_t reserved[32];
+};
+
+struct NNFileLayer {
+    uint32_t in_dim;
+    uint32_t out_dim;
+    uint64_t w_offset;
+    uint64_t b_offset;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(NNFileHeader) == 64, "NNFileHeader must be 64 bytes");
+static_assert(sizeof(NNFileLayer) == 32, "NNFileLayer must be 32 bytes");
+
+/**
+ * @brief 保存模型
+ *
+ * 把各层参数写成上面描述的二进制格式。
+ *
+ * @param path 文件路径
+ * @param layers 各层参数
+ *
+ * @return 成功返回 true
+ */
+inline bool save_nn(const std::string& path, const std::vector<DenseLayerView>& layers) {
+    auto align = [](uint64_t v) { return (v + NN_FILE_ALIGN - 1) / NN_FILE_ALIGN * NN_FILE_ALIGN; };
+
+    // 计算各块的偏移
+    std::vector<NNFileLayer> entries(layers.size());
+    uint64_t offset = align(sizeof(NNFileHeader) + sizeof(NNFileLayer) * layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        std::memset(&entries[i], 0, sizeof(NNFileLayer));
+        entries[i].in_dim = (uint32_t)layers[i].in_dim;
+        entries[i].out_dim = (uint32_t)layers[i].out_dim;
+        entries[i].w_offset = offset;
+        offset = align(offset + sizeof(double) * layers[i].in_dim * layers[i].out_dim);
+        entries[i].b_offset = offset;
+        offset = align(offset + sizeof(double) * layers[i].out_dim);
+    }
+
+    NNFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, NN_FILE_MAGIC, sizeof(header.magic));
+    header.version = NN_FILE_VERSION;
+    header.byte_order = NN_FILE_BYTE_ORDER;
+    header.dtype = NN_DTYPE_F64;
+    header.num_layers = (uint32_t)layers.size();
+    header.file_size = offset;
+
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        std::cerr << "无法写入模型: " << path << std::endl;
+        return false;
+    }
+
+    // 写入时用 0 填充对齐间隙
+    uint64_t pos = 0;
+    auto write_at = [&](uint64_t at, const void* data, size_t size) {
+        static const char zeros[NN_FILE_ALIGN] = {0};
+        while (pos < at) {
+            size_t n = (size_t)std::min<uint64_t>(at - pos, NN_FILE_ALIGN);
+            ofs.write(zeros, n);
+            pos += n;
+        }
+        ofs.write((const char*)data, size);
+        pos += size;
+    };
+
+    write_at(0, &header, sizeof(header));
+    write_at(pos, entries.data(), sizeof(NNFileLayer) * entries.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        write_at(entries[i].w_offset, layers[i].w, sizeof(double) * layers[i].in_dim * layers[i].out_dim);
+        write_at(entries[i].b_offset, layers[i].b, sizeof(double) * layers[i].out_dim);
+    }
+    write_at(offset, nullptr, 0);
+
+    return (bool)ofs;
+}
+
+/**
+ * @brief 通过 mmap 只读加载的模型
+ *
+ * 文件以 MAP_SHARED 方式映射，多个进程加载同一个模型时共享同一份物理页，
+ * 加载只需要一次 mmap 和格式校验，不读取、不拷贝权重。
+ */
+class MappedNN {
+   public:
+    MappedNN() {}
+    MappedNN(const MappedNN&) = delete;
+    MappedNN& operator=(const MappedNN&) = delete;
+    ~MappedNN() { close(); }
+
+    /**
+     * @brief 映射模型文件
+     *
+     * @param path 文件路径
+     *
+     * @return 成功返回 true，文件不存在或格式不正确时返回 false
+     */
+    bool open(const std::string& path) {
+        close();
+        if (!file_.open(path, false, sizeof(NNFileHeader), "模型文件")) {
+            return false;
+        }
+        if (!parse()) {
+            std::cerr << "模型格式错误: " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 解除映射
+     */
+    void close() {
+        file_.close();
+        layers_.clear();
+    }
+
+    /**
+     * @brief 各层参数，直接指向映射的内存
+     */
+    const std::vector<DenseLayerView>& layers() const { return layers_; }
+
+    /**
+     * @brief 调用方持有的中间结果缓冲区，复用时不再分配
+     */
+    struct Scratch {
+        std::vector<double> a, b;
+    };
+
+    /**
+     * @brief 前向传播
+     *
+     * 中间结果写在调用方提供的 scratch 中，多个线程可以各用自己的 scratch 同时调用。
+     *
+     * @param x 输入，rows × in_dim，行主序
+     * @param rows 行数
+     * @param out 输出，rows × out_dim
+     * @param scratch 中间结果缓冲区
+     */
+    void forward(const double* x, int rows, double* out, Scratch& scratch) const {
+        mlp_forward(layers_, x, rows, out, scratch.a, scratch.b);
+    }
+
+    /**
+     * @brief 前向传播，使用本实例的缓冲（同一个实例不能在多个线程上同时调用）
+     */
+    void forward(const double* x, int rows, double* out) { forward(x, rows, out, scratch_); }
+
+   private:
+    MappedFile file_;
+    std::vector<DenseLayerView> layers_;
+    Scratch scratch_;
+
+    // 校验文件头并建立各层视图
+    bool parse() {
+        const uint8_t* base = file_.data();
+        size_t size = file_.size();
+        const NNFileHeader* h = (const NNFileHeader*)base;
+        if (!file_.has_magic(NN_FILE_MAGIC, sizeof(h->magic)) || h->version != NN_FILE_VERSION ||
+            h->byte_order != NN_FILE_BYTE_ORDER || h->dtype != NN_DTYPE_F64 || h->file_size > size ||
+            h->num_layers == 0 || sizeof(NNFileHeader) + sizeof(NNFileLayer) * (uint64_t)h->num_layers > size) {
+            return false;
+        }
+
+        const NNFileLayer* entries = (const NNFileLayer*)(base + sizeof(NNFileHeader));
+        for (uint32_t i = 0; i < h->num_layers; ++i) {
+            const NNFileLayer& e = entries[i];
+            // 先比较偏移再比较元素个数，offset + count * 8 在构造的文件头上可能溢出
+            auto fits = [&](uint64_t offset, uint64_t count) {
+                return offset <= size && count <= (size - offset) / sizeof(double);
+            };
+            if (e.in_dim == 0 || e.out_dim == 0 || e.w_offset % NN_FILE_ALIGN || e.b_offset % NN_FILE_ALIGN ||
+                !fits(e.w_offset, (uint64_t)e.in_dim * e.out_dim) || !fits(e.b_offset, e.out_dim)) {
+                return false;
+            }
+            // 相邻两层的维度必须衔接
+            if (i > 0 && (int)e.in_dim != layers_.back().out_dim) {
+                return false;
+            }
+            layers_.push_back({(int)e.in_dim, (int)e.out_dim, (const double*)(base + e.w_offset),
+                               (const double*)(base + e.b_offset)});
+        }
+        return true;
+    }
+};
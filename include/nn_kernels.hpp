@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief 全连接层的只读视图
+ *
+ * 指向行主序的权重 (in_dim × out_dim) 和偏置 (out_dim)，本身不持有内存，
+ * 量化、序列化等只需要读取参数的地方都通过它访问一层。
+ */
+struct DenseLayerView {
+    int in_dim;
+    int out_dim;
+    const double* w;
+    const double* b;
+};
+
+/**
+ * @brief 快速指数函数
+ *
+ * 将 x 拆成 n * ln2 + r（|r| <= ln2 / 2），exp(r) 用 11 阶多项式逼近，2^n 直接拼接指数位。
+ * 全程无分支、无查表，编译器可以把调用它的循环自动向量化。相对误差约 1e-15。
+ *
+ * @param x 输入值，超出 [-708, 708] 的部分会被截断
+ *
+ * @return exp(x) 的近似值
+ */
+inline double fast_exp(double x) {
+    // 截断输入，保证 2^n 不上溢/下溢
+    x = x < -708.0 ? -708.0 : x;
+    x = x > 708.0 ? 708.0 : x;
+
+    // 加上 1.5 * 2^52 后，尾数的低位就是 round(x / ln2)
+    const double shifter = 6755399441055744.0;
+    double t = x * 1.4426950408889634 + shifter;
+    double n = t - shifter;
+
+    // r = x - n * ln2，ln2 拆成高低两部分以减小舍入误差
+    double r = x - n * 6.93147180369123816490e-01;
+    r = r - n * 1.90821492927058770002e-10;
+
+    // exp(r) 的泰勒展开（Horner 形式）
+    double p = 2.50521083854417187751e-08;
+    p = p * r + 2.75573192239858906526e-07;
+    p = p * r + 2.75573192239858906526e-06;
+    p = p * r + 2.48015873015873015873e-05;
+    p = p * r + 1.98412698412698412698e-04;
+    p = p * r + 1.38888888888888888889e-03;
+    p = p * r + 8.33333333333333333333e-03;
+    p = p * r + 4.16666666666666666667e-02;
+    p = p * r + 1.66666666666666666667e-01;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    // 2^n：把 n + 1023 放进指数位
+    uint64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    bits = (bits + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return p * scale;
+}
+
+/**
+ * @brief 快速 Sigmoid 函数
+ *
+ * @param x 输入值
+ *
+ * @return 1 / (1 + exp(-x))
+ */
+inline double fast_sigmoid(double x) { return 1.0 / (1.0 + fast_exp(-x)); }
+
+/**
+ * @brief 原地计算 Sigmoid
+ *
+ * @param v 数据指针
+ * @param n 元素个数
+ */
+inline void sigmoid_inplace(double* v, int n) {
+    for (int i = 0; i < n; ++i) {
+        v[i] = fast_sigmoid(v[i]);
+    }
+}
+
+/**
+ * @brief 融合的全连接层：out = sigmoid(x · w + b)
+ *
+ * 偏置作为累加器初值，Sigmoid 在每行结果仍在 L1 缓存中时原地完成，
+ * 不产生 dot、加偏置、激活三个中间数组。每次处理 4 行输入，权重的每一行只读一次。
+ * 所有矩阵均为行主序且连续存储。
+ *
+ * @param x 输入矩阵，rows × in_dim
+ * @param rows 输入行数（batch 大小）
+ * @param in_dim 输入维度
+ * @param w 权重矩阵，in_dim × out_dim
+ * @param b 偏置，长度 out_dim
+ * @param out_dim 输出维度
+ * @param out 输出矩阵，rows × out_dim，不能与 x 重叠
+ */
+inline void dense_sigmoid(const double* x, int rows, int in_dim, const double* w, const double* b, int out_dim,
+                          double* out) {
+    int i = 0;
+
+    // 4 行一组，共享同一行权重
+    for (; i + 4 <= rows; i += 4) {
+        const double* x0 = x + (size_t)i * in_dim;
+        const double* x1 = x0 + in_dim;
+        const double* x2 = x1 + in_dim;
+        const double* x3 = x2 + in_dim;
+        double* o0 = out + (size_t)i * out_dim;
+        double* o1 = o0 + out_dim;
+        double* o2 = o1 + out_dim;
+        double* o3 = o2 + out_dim;
+
+        // 偏置作为累加初值
+        for (int j = 0; j < out_dim; ++j) {
+            o0[j] = b[j];
+            o1[j] = b[j];
+            o2[j] = b[j];
+            o3[j] = b[j];
+        }
+
+        for (int k = 0; k < in_dim; ++k) {
+            const double* wk = w + (size_t)k * out_dim;
+            double a0 = x0[k], a1 = x1[k], a2 = x2[k], a3 = x3[k];
+            for (int j = 0; j < out_dim; ++j) {
+                double wv = wk[j];
+                o0[j] += a0 * wv;
+                o1[j] += a1 * wv;
+                o2[j] += a2 * wv;
+                o3[j] += a3 * wv;
+            }
+        }
+
+        // 激活函数作为收尾
+        sigmoid_inplace(o0, out_dim * 4);
+    }
+
+    // 剩余的行
+    for (; i < rows; ++i) {
+        const double* xi = x + (size_t)i * in_dim;
+        double* oi = out + (size_t)i * out_dim;
+
+        for (int j = 0; j < out_dim; ++j) {
+            oi[j] = b[j];
+        }
+        for (int k = 0; k < in_dim; ++k) {
+            const double* wk = w + (size_t)k * out_dim;
+            double a = xi[k];
+            for (int j = 0; j < out_dim; ++j) {
+                oi[j] += a * wk[j];
+            }
+        }
+        sigmoid_inplace(oi, out_dim);
+    }
+}
+
+/**
+ * @brief 多层全连接网络的前向传播
+ *
+ * 逐层调用 dense_sigmoid，中间结果在 a、b 两个缓冲区之间交替，调用方复用这两个缓冲区时不会重复分配。
+ *
+ * @param layers 各层参数
+ * @param x 输入，rows × layers[0].in_dim
+ * @param rows 行数
+ * @param out 输出，rows × layers.back().out_dim
+ * @param a 中间结果缓冲区
+ * @param b 中间结果缓冲区
+ */
+inline void mlp_forward(const std::vector<DenseLayerView>& layers, const double* x, int rows, double* out,
+                        std::vector<double>& a, std::vector<double>& b) {
+    const double* in = x;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const DenseLayerView& L = layers[i];
+        double* dst = out;
+        if (i + 1 < layers.size()) {
+            std::vector<double>& buf = (i % 2 == 0) ? a : b;
+            buf.resize((size_t)rows * L.out_dim);
+            dst = buf.data();
+        }
+        dense_sigmoid(in, rows, L.in_dim, L.w, L.b, L.out_dim, dst);
+        in = dst;
+    }
+}
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "histogram.hpp"
+#include "lut.hpp"
+#include "parallel.hpp"
+
+/**
+ * @brief 大津法求阈值
+ *
+ * 与 answer_4 相同：候选阈值 t ∈ [0, 255)，像素值 < t 为类 0，其余为类 1，
+ * 取类间方差 w0 * w1 * (m0 - m1)^2 最大的 t（相同时取最小的 t）。
+ * 类的像素个数与灰度和用前缀和递推，整个搜索只遍历 256 个 bin 一次。
+ *
+ * @param hist 灰度直方图
+ *
+ * @return 阈值，二值化时像素值 > 阈值为 255
+ */
+inline int otsu_threshold(const Histogram& hist) {
+    double total = (double)hist.total();
+    double sum_all = 0;
+    for (int v = 0; v < 256; ++v) {
+        sum_all += (double)v * hist[v];
+    }
+
+    double n0 = 0, sum0 = 0, max_sb = 0;
+    int th = 0;
+    for (int t = 1; t < 255; ++t) {
+        n0 += (double)hist[t - 1];
+        sum0 += (double)(t - 1) * hist[t - 1];
+        double n1 = total - n0;
+        if (n0 == 0 || n1 == 0) {
+            continue;
+        }
+        double d = sum0 / n0 - (sum_all - sum0) / n1;
+        double sb = n0 / total * (n1 / total) * d * d;
+        if (sb > max_sb) {
+            max_sb = sb;
+            th = t;
+        }
+    }
+    return th;
+}
+
+/**
+ * @brief 多阈值大津法
+ *
+ * 把灰度分成 levels - 1 个阈值划分出的 levels 类，使类间方差最大。
+ * 类间方差最大等价于 Σ S_c^2 / N_c 最大（N_c、S_c 为第 c 类的像素个数与灰度和），
+ * 它对各类可以分开求和，所以用动态规划：best[c][v] 为前 c 类恰好覆盖 [0, v) 时的最大值，
+ * 复杂度 O(levels × 256^2)，与图像大小无关。
+ *
+ * @param hist 灰度直方图
+ * @param levels 类数，2 ~ 5（即 1 ~ 4 个阈值）
+ *
+ * @return levels - 1 个递增的阈值 t，第 c 类为 [t[c - 1], t[c])
+ */
+inline std::vector<int> otsu_thresholds(const Histogram& hist, int levels) {
+    CV_Assert(levels >= 2 && levels <= 5);
+    double n[257] = {0}, s[257] = {0};
+    for (int v = 0; v < 256; ++v) {
+        n[v + 1] = n[v] + (double)hist[v];
+        s[v + 1] = s[v] + (double)v * hist[v];
+    }
+    // 区间 [a, b) 的贡献，空区间为 0
+    auto score = [&](int a, int b) {
+        double cnt = n[b] - n[a], sum = s[b] - s[a];
+        return cnt > 0 ? sum * sum / cnt : 0.0;
+    };
+
+    std::vector<std::vector<double>> best(levels + 1, std::vector<double>(257, -1));
+    std::vector<std::vector<int>> from(levels + 1, std::vector<int>(257, 0));
+    for (int v = 1; v <= 256; ++v) {
+        best[1][v] = score(0, v);
+    }
+    for (int c = 2; c <= levels; ++c) {
+        for (int v = c; v <= 256; ++v) {
+            for (int u = c - 1; u < v; ++u) {
+                double value = best[c - 1][u] + score(u, v);
+                if (value > best[c][v]) {
+                    best[c][v] = value;
+                    from[c][v] = u;
+                }
+            }
+        }
+    }
+
+    std::vector<int> thresholds(levels - 1);
+    for (int c = levels, v = 256; c > 1; --c) {
+        v = from[c][v];
+        thresholds[c - 2] = v;
+    }
+    return thresholds;
+}
+
+/**
+ * @brief 多阈值量化的查找表：第 c 类映射为 255 * c / (类数 - 1)
+ */
+inline Lut otsu_levels_lut(const std::vector<int>& thresholds) {
+    int classes = (int)thresholds.size() + 1;
+    Lut lut;
+    for (int v = 0, c = 0; v < 256; ++v) {
+        while (c < (int)thresholds.size() && v >= thresholds[c]) {
+            ++c;
+        }
+        lut[v] = (uint8_t)(255 * c / (classes - 1));
+    }
+    return lut;
+}
+
+/**
+ * @brief 大津法二值化
+ *
+ * 直方图统计一遍、查表一遍，与 answer_4 的结果相同。
+ *
+ * @param gray CV_8UC1 灰度图
+ * @param threshold 不为空时输出使用的阈值
+ *
+ * @return 二值图像
+ */
+inline cv::Mat otsu_binarize(const cv::Mat& gray, int* threshold = nullptr) {
+    CV_Assert(gray.type() == CV_8UC1);
+    int th = otsu_threshold(Histogram(gray));
+    if (threshold) {
+        *threshold = th;
+    }
+    return apply_lut(gray, lut_threshold(th));
+}
+
+/**
+ * @brief 多阈值大津法量化
+ *
+ * @param gray CV_8UC1 灰度图
+ * @param levels 类数，2 ~ 5
+ *
+ * @return 量化为 levels 个灰度级的图像
+ */
+inline cv::Mat otsu_multilevel(const cv::Mat& gray, int levels) {
+    CV_Assert(gray.type() == CV_8UC1);
+    return apply_lut(gray, otsu_levels_lut(otsu_thresholds(Histogram(gray), levels)));
+}
+
+/**
+ * @brief Sauvola 局部阈值参数
+ */
+struct SauvolaConfig {
+    int window = 31;  // 窗口边长（奇数，不超过 257）
+    double k = 0.34;  // 标准差的权重
+    double r = 128;   // 标准差的动态范围
+};
+
+/**
+ * @brief 灰度和与平方和的积分图，只保留最近的若干行
+ *
+ * 第 j 行为输入 [y_begin, y_begin + j) 行的累加结果，存放在 rows 行的环形缓冲中，
+ * 所以既可以从任意一行开始，也只占用窗口大小的内存，适合逐行扫描的局部统计。
+ * 用 uint32 存储并允许溢出回绕：窗口内的和只要小于 2^32，四个角相减的结果就是精确的，
+ * 窗口边长不超过 257 时平方和也满足这个条件。
+ */
+class RollingIntegral {
+   public:
+    RollingIntegral(const cv::Mat& gray, int y_begin, int rows)
+        : gray_(gray), y_begin_(y_begin), rows_(rows), stride_((size_t)gray.cols + 1), computed_(1) {
+        sum_.assign(stride_ * rows, 0);
+        sqsum_.assign(stride_ * rows, 0);
+    }
+
+    /**
+     * @brief 第 j 行（灰度和、平方和），需要时向下计算；j 不能早于已计算的最后一行 rows - 1 行以上
+     */
+    const uint32_t* sum(int j) {
+        advance(j);
+        return &sum_[(j % rows_) * stride_];
+    }
+
+    const uint32_t* sqsum(int j) {
+        advance(j);
+        return &sqsum_[(j % rows_) * stride_];
+    }
+
+   private:
+    const cv::Mat& gray_;
+    int y_begin_, rows_;
+    size_t stride_;
+    int computed_;  // 已计算的行数
+    std::vector<uint32_t> sum_, sqsum_;
+
+    void advance(int j) {
+        for (; computed_ <= j; ++computed_) {
+            const uint8_t* p = gray_.ptr<uint8_t>(y_begin_ + computed_ - 1);
+            const uint32_t* ps = &sum_[((computed_ - 1) % rows_) * stride_];
+            const uint32_t* pq = &sqsum_[((computed_ - 1) % rows_) * stride_];
+            uint32_t* s = &sum_[(computed_ % rows_) * stride_];
+            uint32_t* q = &sqsum_[(computed_ % rows_) * stride_];
+            uint32_t rs = 0, rq = 0;
+            s[0] = q[0] = 0;
+            for (int x = 0; x < gray_.cols; ++x) {
+                rs += p[x];
+                rq += (uint32_t)p[x] * p[x];
+                s[x + 1] = ps[x + 1] + rs;
+                q[x + 1] = pq[x + 1] + rq;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Sauvola 自适应二值化
+ *
+ * 每个像素以窗口内的均值 m、标准差 s 求阈值 T = m * (1 + k * (s / r - 1))，
+ * 像素值 > T 为 255。窗口统计来自积分图，与窗口大小无关；图像边缘处窗口截断。
+ * 图像按行带并行，每带用自己的滚动积分图（从带的 halo 起点开始，多算上方 window / 2 行）。
+ * 适合光照不均匀的文档图像。
+ *
+ * @param gray CV_8UC1 灰度图
+ * @param cfg 参数
+ *
+ * @return 二值图像
+ */
+inline cv::Mat sauvola_binarize(const cv::Mat& gray, const SauvolaConfig& cfg = SauvolaConfig()) {
+    CV_Assert(gray.type() == CV_8UC1 && cfg.window >= 1 && cfg.window <= 257);
+    cv::Mat out(gray.rows, gray.cols, CV_8UC1);
+    int r = cfg.window / 2;
+    float k = (float)cfg.k, inv_r = (float)(1 / cfg.r);
+
+    parallel_for_rows(gray.rows, r, [&](const ParallelRange& band) {
+        int top = band.halo_begin;
+        RollingIntegral ii(gray, top, 2 * r + 2);
+
+        for (int y = band.begin; y < band.end; ++y) {
+            const uint8_t* p = gray.ptr<uint8_t>(y);
+            uint8_t* o = out.ptr<uint8_t>(y);
+            int y0 = std::max(y - r, 0), y1 = std::min(y + r + 1, gray.rows);
+            const uint32_t* s1 = ii.sum(y1 - top);
+            const uint32_t* q1 = ii.sqsum(y1 - top);
+            const uint32_t* s0 = ii.sum(y0 - top);
+            const uint32_t* q0 = ii.sqsum(y0 - top);
+
+            auto binarize = [&](int x, int x0, int x1, float inv_area) {
+                uint32_t s = s1[x1] - s1[x0] - s0[x1] + s0[x0];
+                uint32_t q = q1[x1] - q1[x0] - q0[x1] + q0[x0];
+                float m = s * inv_area;
+                float sd = std::sqrt(std::max(q * inv_area - m * m, 0.f));
+                float t = m * (1 + k * (sd * inv_r - 1));
+                o[x] = p[x] > t ? 255 : 0;
+            };
+
+            // 左右边缘处窗口截断，中间部分窗口面积不变
+            int left = std::min(r, gray.cols), right = std::max(left, gray.cols - r - 1);
+            for (int x = 0; x < left; ++x) {
+                int x1 = std::min(x + r + 1, gray.cols);
+                binarize(x, 0, x1, 1.f / (x1 * (y1 - y0)));
+            }
+            float inv_area = 1.f / ((2 * r + 1) * (y1 - y0));
+            int x = left;
+#if defined(__AVX2__)
+            // 8 个像素一组；平方和可能超过 int32，拆成高低 16 位再转 float
+            const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+            const __m256 va = _mm256_set1_ps(inv_area), vk = _mm256_set1_ps(k), vr = _mm256_set1_ps(inv_r);
+            const __m256 one = _mm256_set1_ps(1), zero = _mm256_setzero_ps(), scale16 = _mm256_set1_ps(65536.f);
+            for (; x + 8 <= right; x += 8) {
+                int x0 = x - r, x1 = x + r + 1;
+                auto box = [&](const uint32_t* a, const uint32_t* b) {
+                    __m256i d = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(b + x1)),
+                                                 _mm256_loadu_si256((const __m256i*)(b + x0)));
+                    d = _mm256_sub_epi32(d, _mm256_loadu_si256((const __m256i*)(a + x1)));
+                    return _mm256_add_epi32(d, _mm256_loadu_si256((const __m256i*)(a + x0)));
+                };
+                __m256i vs = box(s0, s1), vq = box(q0, q1);
+                __m256 m = _mm256_mul_ps(_mm256_cvtepi32_ps(vs), va);
+                __m256 q = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(vq, 16)), scale16),
+                                         _mm256_cvtepi32_ps(_mm256_and_si256(vq, lo16)));
+                __m256 var = _mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(q, va), _mm256_mul_ps(m, m)), zero);
+                __m256 sd = _mm256_sqrt_ps(var);
+                __m256 t = _mm256_mul_ps(m, _mm256_add_ps(one, _mm256_mul_ps(vk, _mm256_sub_ps(_mm256_mul_ps(sd, vr), one))));
+                __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(p + x))));
+                __m256i mask = _mm256_castps_si256(_mm256_cmp_ps(v, t, _CMP_GT_OQ));
+                __m128i m16 = _mm_packs_epi32(_mm256_castsi256_si128(mask), _mm256_extracti128_si256(mask, 1));
+                _mm_storel_epi64((__m128i*)(o + x), _mm_packs_epi16(m16, m16));
+            }
+#endif
+            for (; x < right; ++x) {
+                binarize(x, x - r, x + r + 1, inv_area);
+            }
+            for (int x = right; x < gray.cols; ++x) {
+                int x0 = std::max(x - r, 0);
+                binarize(x, x0, gray.cols, 1.f / ((gray.cols - x0) * (y1 - y0)));
+            }
+        }
+    }, std::max(64, 4 * cfg.window));
+    return out;
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 线程数上限，0 表示不限制（基准测试用它测量不同线程数下的加速比）
+ */
+inline std::atomic<int>& parallel_thread_limit() {
+    static std::atomic<int> limit(0);
+    return limit;
+}
+
+/**
+ * @brief 默认的并行线程数
+ */
+inline int parallel_threads() {
+    int n = (int)std::max(1u, std::thread::hardware_concurrency());
+    int limit = parallel_thread_limit();
+    return limit > 0 ? std::min(n, limit) : n;
+}
+
+/**
+ * @brief 一次 parallel_for 最多的段数（参与的线程数）
+ */
+static const int PARALLEL_MAX_SLOTS = 256;
+
+/**
+ * @brief 一次 parallel_for 的任务
+ *
+ * 任务对象在发起的线程的栈上，段存放在定长数组中，函数以指针和上下文传入，发起一次并行不申请堆内存。
+ * [begin, end) 预先均分成 slots（不超过 PARALLEL_MAX_SLOTS）段，每个参与的线程持有一段，段的起止（相对 begin）打包在一个 64 位原子量中。
+ * 线程从自己那一段的前端逐个领取下标；自己的段取完后，找剩余最多的一段，用 CAS 把它的后一半窃取过来
+ * 作为自己的新段。没有线程领取的段也会被其他线程窃取完，因此参与的线程少于 slots 时结果不变。
+ * 函数抛出异常时记录第一个异常，剩余的下标不再执行，由发起的线程重新抛出。
+ */
+class ParallelJob {
+   public:
+    ParallelJob(int begin, int end, int slots, void (*fn)(void*, int), void* context)
+        : begin_(begin), slots_(slots), fn_(fn), context_(context) {
+        int64_t n = (int64_t)end - begin;
+        for (int s = 0; s < slots; ++s) {
+            ranges_[s] = pack((uint32_t)(n * s / slots), (uint32_t)(n * (s + 1) / slots));
+        }
+    }
+
+    /**
+     * @brief 以第 slot 段为起点执行，直到所有的段都为空
+     */
+    void run(int slot) {
+        uint32_t i;
+        while (take(slot, i) || steal(slot, i)) {
+            if (failed_) {
+                continue;
+            }
+            try {
+                fn_(context_, begin_ + (int)i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex_);
+                if (!failed_) {
+                    error_ = std::current_exception();
+                    failed_ = true;
+                }
+            }
+        }
+    }
+
+    std::exception_ptr error() const { return error_; }
+
+    // 以下两个计数由线程池的互斥锁保护
+    int joined = 1;  // 已分配的段数（发起的线程占第 0 段）
+    int active = 0;  // 正在执行的工作线程数
+
+    int slots() const { return slots_; }
+
+   private:
+    int begin_, slots_;
+    std::atomic<uint64_t> ranges_[PARALLEL_MAX_SLOTS];
+    void (*fn_)(void*, int);
+    void* context_;
+    std::atomic<bool> failed_{false};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+
+    static uint64_t pack(uint32_t lo, uint32_t hi) { return (uint64_t)lo << 32 | hi; }
+    static uint32_t lo(uint64_t v) { return (uint32_t)(v >> 32); }
+    static uint32_t hi(uint64_t v) { return (uint32_t)v; }
+
+    bool take(int slot, uint32_t& i) {
+        std::atomic<uint64_t>& r = ranges_[slot];
+        uint64_t v = r.load();
+        while (lo(v) < hi(v)) {
+            if (r.compare_exchange_weak(v, pack(lo(v) + 1, hi(v)))) {
+                i = lo(v);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 只有自己的段为空时才会调用，此时自己的段只会被自己写入
+    bool steal(int slot, uint32_t& i) {
+        while (true) {
+            int victim = -1;
+            uint64_t v = 0;
+            uint32_t most = 0;
+            for (int s = 0; s < slots_; ++s) {
+                uint64_t r = ranges_[s].load();
+                if (hi(r) - lo(r) > most) {
+                    most = hi(r) - lo(r);
+                    victim = s;
+                    v = r;
+                }
+            }
+            if (victim < 0) {
+                return false;
+            }
+            // 窃取 [mid, hi)，剩余 1 个时整段取走
+            uint32_t mid = hi(v) - (most + 1) / 2;
+            if (ranges_[victim].compare_exchange_strong(v, pack(lo(v), mid))) {
+                ranges_[slot].store(pack(mid + 1, hi(v)));
+                i = mid;
+                return true;
+            }
+        }
+    }
+};
+
+/**
+ * @brief 常驻的线程池，第一次并行时启动 hardware_concurrency - 1 个工作线程
+ *
+ * 发起 parallel_for 的线程把任务挂到列表上、唤醒工作线程，自己执行第 0 段，
+ * 之后等待加入的工作线程全部退出。工作线程在执行任务时可以再次发起 parallel_for（嵌套），
+ * 嵌套的任务同样挂到列表上由空闲的线程窃取，等待关系只会指向更内层的任务，不会死锁。
+ */
+class ThreadPool {
+   public:
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief 执行任务，返回时所有的下标都已执行完
+     */
+    void run(ParallelJob& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(&job);
+        }
+        for (int s = 1; s < job.slots(); ++s) {
+            wake_.notify_one();
+        }
+        job.run(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+            done_.wait(lock, [&] { return job.active == 0; });
+        }
+        if (job.error()) {
+            std::rethrow_exception(job.error());
+        }
+    }
+
+   private:
+    std::vector<std::thread> workers_;
+    std::vector<ParallelJob*> jobs_;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+
+    ThreadPool() {
+        int n = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 1; i < n; ++i) {
+            workers_.emplace_back(&ThreadPool::worker, this);
+        }
+    }
+
+    // 还有空闲段的任务，调用时持有 mutex_
+    ParallelJob* open_job() const {
+        for (ParallelJob* job : jobs_) {
+            if (job->joined < job->slots()) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            ParallelJob* job = nullptr;
+            wake_.wait(lock, [&] { return stop_ || (job = open_job()) != nullptr; });
+            if (stop_) {
+                return;
+            }
+            int slot = job->joined++;
+            ++job->active;
+            lock.unlock();
+            job->run(slot);
+            lock.lock();
+            if (--job->active == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+};
+
+/**
+ * @brief 并行执行 fn(i)，i ∈ [begin, end)
+ *
+ * 由常驻线程池执行，各线程先处理连续的一段下标，空闲后从其他线程窃取剩余下标的一半，
+ * 适合每个任务耗时不均的情况（例如不同尺度的金字塔层）。
+ * 任务数不多于 1 或只有一个线程时直接在当前线程执行。fn 抛出的第一个异常会在当前线程重新抛出。
+ * 线程池启动后，发起一次并行不申请堆内存。
+ *
+ * @param begin 起始下标
+ * @param end 结束下标（不含）
+ * @param fn 任务函数
+ */
+template <typename F>
+void parallel_for(int begin, int end, F&& fn) {
+    int threads = std::min(std::min(parallel_threads(), end - begin), PARALLEL_MAX_SLOTS);
+    if (threads <= 1) {
+        for (int i = begin; i < end; ++i) {
+            fn(i);
+        }
+        return;
+    }
+    using Fn = typename std::remove_reference<F>::type;
+    ParallelJob job(begin, end, threads, [](void* context, int i) { (*static_cast<Fn*>(context))(i); },
+                    const_cast<void*>(static_cast<const void*>(&fn)));
+    ThreadPool::instance().run(job);
+}
+
+/**
+ * @brief 并行任务的临时状态，每个可能同时执行的任务一份
+ *
+ * 由发起并行的线程持有（一般是内核中的 thread_local），并行前用 prepare 准备 parallel_threads() 份，
+ * 任务中用 use 借出一份；同时执行的任务数不超过线程数，不会不够用。
+ * 状态由发起的线程复用、只增不减，prepare 时把每一份都准备到本次需要的大小，
+ * 所以稳定后不再申请内存，与由哪些工作线程执行任务无关。
+ * 任务中要通过发起线程取得的引用访问它：thread_local 的名字在工作线程上指向的是另一个对象。
+ */
+template <typename T>
+class ParallelSlots {
+   public:
+    /**
+     * @brief 准备 n 份状态，对每一份调用 init(T&)；在发起并行的线程上、没有任务执行时调用
+     */
+    template <typename Init>
+    void prepare(int n, Init&& init) {
+        if (n > size_) {
+            entries_.reset(new Entry[n]);
+            size_ = n;
+        }
+        for (int i = 0; i < n; ++i) {
+            init(entries_[i].state);
+        }
+    }
+
+    /**
+     * @brief 借出一份空闲的状态执行 fn(T&)，返回时归还
+     */
+    template <typename F>
+    void use(F&& fn) {
+        CV_Assert(size_ > 0);
+        Entry* e = nullptr;
+        while (!e) {
+            for (int i = 0; i < size_ && !e; ++i) {
+                bool expected = false;
+                if (entries_[i].busy.compare_exchange_strong(expected, true)) {
+                    e = &entries_[i];
+                }
+            }
+        }
+        struct Release {
+            Entry* e;
+            ~Release() { e->busy.store(false); }
+        } release{e};
+        fn(e->state);
+    }
+
+   private:
+    struct Entry {
+        T state;
+        std::atomic<bool> busy{false};
+    };
+
+    std::unique_ptr<Entry[]> entries_;
+    int size_ = 0;
+};
+
+/**
+ * @brief 一维的分块范围
+ *
+ * [begin, end) 为本块负责输出的部分；[halo_begin, halo_end) 向两侧各扩展 halo 并截断到 [0, n)，
+ * 是邻域运算计算这些输出需要读取的输入范围。
+ */
+struct ParallelRange {
+    int begin, end;
+    int halo_begin, halo_end;
+};
+
+/**
+ * @brief 二维的分块（x、y 两个方向的范围）
+ */
+struct ParallelTile {
+    ParallelRange x, y;
+};
+
+/**
+ * @brief 把 [0, n) 均分为 parts 块中的第 i 块
+ */
+inline ParallelRange parallel_split(int n, int parts, int i, int halo) {
+    ParallelRange r;
+    r.begin = (int)((int64_t)n * i / parts);
+    r.end = (int)((int64_t)n * (i + 1) / parts);
+    r.halo_begin = std::max(r.begin - halo, 0);
+    r.halo_end = std::min(r.end + halo, n);
+    return r;
+}
+
+/**
+ * @brief 按行带并行：[0, rows) 分成连续的行带，对每一带执行 fn(const ParallelRange&)
+ *
+ * 带数取线程数的 4 倍以便窃取时负载均衡，每带不少于 min_rows 行（用于每带有固定准备开销的内核，
+ * 例如需要先填满 halo 的滑动窗口）。
+ *
+ * @param rows 行数
+ * @param halo 邻域半径（行），决定 halo_begin、halo_end
+ * @param fn 行带函数
+ * @param min_rows 每带的最少行数
+ */
+template <typename F>
+void parallel_for_rows(int rows, int halo, F&& fn, int min_rows = 1) {
+    int bands = std::min(parallel_threads() * 4, rows / std::max(min_rows, 1));
+    bands = std::max(bands, std::min(rows, 1));
+    parallel_for(0, bands, [&](int b) { fn(parallel_split(rows, bands, b, halo)); });
+}
+
+/**
+ * @brief 按二维块并行：width × height 分成不大于 tile_w × tile_h 的块，对每一块执行 fn(const ParallelTile&)
+ *
+ * 块按行优先编号，相邻的下标在图像中相邻，被窃取的后一半也是连续的一片。
+ *
+ * @param width 宽度
+ * @param height 高度
+ * @param tile_w 块宽度
+ * @param tile_h 块高度
+ * @param halo 邻域半径（像素），x、y 方向相同
+ * @param fn 块函数
+ */
+template <typename F>
+void parallel_for_tiles(int width, int height, int tile_w, int tile_h, int halo, F&& fn) {
+    CV_Assert(tile_w > 0 && tile_h > 0);
+    int tiles_x = (width + tile_w - 1) / tile_w, tiles_y = (height + tile_h - 1) / tile_h;
+    parallel_for(0, tiles_x * tiles_y, [&](int t) {
+        ParallelTile tile;
+        int i = t % tiles_x, j = t / tiles_x;
+        tile.x = {i * tile_w, std::min((i + 1) * tile_w, width), std::max(i * tile_w - halo, 0),
+                  std::min((i + 1) * tile_w + halo, width)};
+        tile.y = {j * tile_h, std::min((j + 1) * tile_h, height), std::max(j * tile_h - halo, 0),
+                  std::min((j + 1) * tile_h + halo, height)};
+        fn(tile);
+    });
+}
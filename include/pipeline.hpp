@@ -0,0 +1,560 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "color.hpp"
+#include "convolve.hpp"
+#include "lut.hpp"
+#include "morphology.hpp"
+#include "parallel.hpp"
+
+/**
+ * @brief 两幅图像逐元素合并的方式
+ */
+enum PipelineCombine {
+    COMBINE_MAX,
+    COMBINE_MIN,
+    COMBINE_ADD,      // 饱和加法
+    COMBINE_ABSDIFF,  // |a - b|
+};
+
+/**
+ * @brief 逐元素合并两行，out 可以与 a 或 b 相同
+ */
+inline void combine_row(const uint8_t* a, const uint8_t* b, int n, PipelineCombine op, uint8_t* out) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i)), vb = _mm_loadu_si128((const __m128i*)(b + i)), v;
+        switch (op) {
+            case COMBINE_MAX:
+                v = _mm_max_epu8(va, vb);
+                break;
+            case COMBINE_MIN:
+                v = _mm_min_epu8(va, vb);
+                break;
+            case COMBINE_ADD:
+                v = _mm_adds_epu8(va, vb);
+                break;
+            default:
+                v = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+                break;
+        }
+        _mm_storeu_si128((__m128i*)(out + i), v);
+    }
+#endif
+    for (; i < n; ++i) {
+        switch (op) {
+            case COMBINE_MAX:
+                out[i] = std::max(a[i], b[i]);
+                break;
+            case COMBINE_MIN:
+                out[i] = std::min(a[i], b[i]);
+                break;
+            case COMBINE_ADD:
+                out[i] = (uint8_t)std::min(255, a[i] + b[i]);
+                break;
+            default:
+                out[i] = (uint8_t)std::abs(a[i] - b[i]);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief 流水线中的节点（一幅中间图像），由 Pipeline 的成员函数创建
+ */
+struct PipelineNode {
+    int id = -1;
+};
+
+/**
+ * @brief 惰性求值的图像处理流水线
+ *
+ * 先用成员函数声明节点组成有向无环图（每个节点是一幅图像），调用 run 时才计算需要的输出：
+ * - 点运算（灰度化、查表）融合进产生其输入的节点，在同一行缓冲上原地完成，相邻的查表合成一张表；
+ * - 卷积、形态学等邻域运算按行流式计算，每个节点只在环形行缓冲中保留后续节点还会读取的几行
+ *   （输出第 y 行时，节点需要的行落在 [y - reach, y + reach] 内，缓冲为 2 * reach + 1 行）；
+ * - 图像按行带并行，每带从 halo 起点开始填充各级行缓冲，带之间互不依赖。
+ * 中间结果只存在于每个线程几行宽的缓冲中，不会生成整幅的中间图像。
+ * 各节点的结果与对整幅图像依次调用 convolve、morphology、apply_lut 逐位一致。
+ *
+ * 例如 answer_41 的前半部分：
+ *     Pipeline p;
+ *     PipelineNode blur = p.convolve(p.gray(p.input()), kernel_gaussian(5, 1.4));
+ *     PipelineNode fx = p.convolve(blur, kernel_sobel(true)), fy = p.convolve(blur, kernel_sobel(false));
+ *     std::vector<cv::Mat> out;
+ *     p.run(image, {fx, fy}, out);
+ */
+class Pipeline {
+   public:
+    Pipeline() { nodes_.push_back(Node(NODE_INPUT)); }
+
+    /**
+     * @brief 输入图像（CV_8U，1 ~ 4 通道）
+     */
+    PipelineNode input() const { return PipelineNode{0}; }
+
+    /**
+     * @brief BGR 转灰度（与 answer_2 相同），输入必须是 3 通道
+     */
+    PipelineNode gray(PipelineNode in) {
+        Node n(NODE_GRAY);
+        n.a = check(in);
+        return add(n);
+    }
+
+    /**
+     * @brief 所有通道查同一张表
+     */
+    PipelineNode lut(PipelineNode in, const Lut& lut) {
+        Node n(NODE_LUT);
+        n.a = check(in);
+        n.lut = ChannelLut(lut, 0);
+        return add(n);
+    }
+
+    /**
+     * @brief 按通道查表，通道数必须与输入一致
+     */
+    PipelineNode lut(PipelineNode in, const ChannelLut& lut) {
+        Node n(NODE_LUT);
+        n.a = check(in);
+        n.lut = lut;
+        return add(n);
+    }
+
+    /**
+     * @brief 滤波（与 convolve() 相同，图像外按 0 处理）
+     */
+    PipelineNode convolve(PipelineNode in, const Kernel& kernel) {
+        Node n(NODE_CONVOLVE);
+        n.a = check(in);
+        n.conv = std::make_shared<Convolver>(kernel);
+        n.kernel_rows = kernel.rows;
+        n.kernel_cols = kernel.cols;
+        return add(n);
+    }
+
+    /**
+     * @brief 形态学运算（与 morphology() 相同），展开为 iterations 或 2 * iterations 个节点
+     */
+    PipelineNode morphology(PipelineNode in, MorphologyOp op, int iterations = 1, bool square = false) {
+        CV_Assert(iterations >= 0);
+        bool dilate = op == MORPHOLOGY_DILATE || op == MORPHOLOGY_CLOSE;
+        int passes = op == MORPHOLOGY_OPEN || op == MORPHOLOGY_CLOSE ? 2 : 1;
+        check(in);
+        for (int p = 0; p < passes; ++p, dilate = !dilate) {
+            for (int i = 0; i < iterations; ++i) {
+                Node n(NODE_MORPHOLOGY);
+                n.a = in.id;
+                n.dilate = dilate;
+                n.square = square;
+                in = add(n);
+            }
+        }
+        return in;
+    }
+
+    /**
+     * @brief 逐元素合并两个通道数相同的节点
+     */
+    PipelineNode combine(PipelineNode a, PipelineNode b, PipelineCombine op) {
+        Node n(NODE_COMBINE);
+        n.a = check(a);
+        n.b = check(b);
+        n.combine = op;
+        return add(n);
+    }
+
+    /**
+     * @brief 计算若干个输出
+     *
+     * @param src 输入图像
+     * @param outputs 要计算的节点
+     * @param dst 与 outputs 一一对应的结果
+     */
+    void run(const cv::Mat& src, const std::vector<PipelineNode>& outputs, std::vector<cv::Mat>& dst) const {
+        CV_Assert(src.depth() == CV_8U && !outputs.empty());
+        Plan plan = compile(src.channels(), outputs);
+        dst.resize(outputs.size());
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            dst[k].create(src.rows, src.cols, CV_8UC(plan.channels[outputs[k].id]));
+        }
+
+        int halo = 0;
+        for (const Group& g : plan.groups) {
+            halo = std::max(halo, g.reach);
+        }
+        // 每带重复计算上下 halo 行，带高至少为 4 倍 halo
+        parallel_for_rows(src.rows, halo, [&](const ParallelRange& band) {
+            State state(plan, src);
+            for (int y = band.begin; y < band.end; ++y) {
+                for (size_t k = 0; k < outputs.size(); ++k) {
+                    const uint8_t* row = state.row(plan.group_of[outputs[k].id], y);
+                    std::memcpy(dst[k].ptr<uint8_t>(y), row, (size_t)src.cols * dst[k].channels());
+                }
+            }
+        }, std::max(16, 4 * halo));
+    }
+
+    cv::Mat run(const cv::Mat& src, PipelineNode output) const {
+        std::vector<cv::Mat> dst;
+        run(src, {output}, dst);
+        return dst[0];
+    }
+
+    /**
+     * @brief 计算 outputs 时一个输出像素依赖的输入范围（像素，水平、垂直取较大者），即分块处理时需要的 halo
+     */
+    int halo(const std::vector<PipelineNode>& outputs) const {
+        std::vector<int> h(nodes_.size(), 0);
+        for (size_t i = 1; i < nodes_.size(); ++i) {
+            const Node& n = nodes_[i];
+            int r = n.kind == NODE_CONVOLVE ? std::max(n.kernel_rows, n.kernel_cols) / 2
+                                            : n.kind == NODE_MORPHOLOGY ? 1 : 0;
+            h[i] = h[n.a] + r;
+            if (n.b >= 0) {
+                h[i] = std::max(h[i], h[n.b] + r);
+            }
+        }
+        int result = 0;
+        for (PipelineNode o : outputs) {
+            result = std::max(result, h[check(o)]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief 融合后的执行计划（每行一组：头部运算、融合的点运算、行缓冲的行数），用于调试
+     */
+    std::string describe(int channels, const std::vector<PipelineNode>& outputs) const {
+        Plan plan = compile(channels, outputs);
+        std::string s;
+        char buf[64];
+        for (size_t i = 0; i < plan.groups.size(); ++i) {
+            const Group& g = plan.groups[i];
+            const Node& head = *g.head;
+            std::snprintf(buf, sizeof(buf), "[%d] ", (int)i);
+            s += buf;
+            switch (g.kind) {
+                case NODE_INPUT:
+                    s += "input";
+                    break;
+                case NODE_CONVOLVE:
+                    std::snprintf(buf, sizeof(buf), "convolve %dx%d%s%s", head.kernel_rows, head.kernel_cols,
+                                  head.conv->separable() ? " separable" : "", head.conv->integer() ? " int16" : "");
+                    s += buf;
+                    break;
+                case NODE_MORPHOLOGY:
+                    s += head.dilate ? "dilate" : "erode";
+                    s += head.square ? " square" : " cross";
+                    break;
+                case NODE_COMBINE:
+                    s += "combine";
+                    break;
+                default:
+                    s += "map";
+                    break;
+            }
+            if (g.a >= 0) {
+                std::snprintf(buf, sizeof(buf), g.b >= 0 ? " <- [%d], [%d]" : " <- [%d]", g.a, g.b);
+                s += buf;
+            }
+            for (const PointOp& op : g.ops) {
+                s += op.gray ? " | gray" : " | lut";
+            }
+            if (g.kind == NODE_INPUT && g.ops.empty()) {
+                s += "  (zero copy)\n";
+            } else {
+                std::snprintf(buf, sizeof(buf), "  (%d rows)\n", 2 * g.reach + 1);
+                s += buf;
+            }
+        }
+        return s;
+    }
+
+   private:
+    enum Kind { NODE_INPUT, NODE_GRAY, NODE_LUT, NODE_CONVOLVE, NODE_MORPHOLOGY, NODE_COMBINE };
+
+    struct Node {
+        Kind kind;
+        int a = -1, b = -1;                               // 输入节点
+        ChannelLut lut = ChannelLut(Lut::identity(), 0);  // channels 为 0 时所有通道使用 ch[0]
+        std::shared_ptr<const Convolver> conv;
+        int kernel_rows = 0, kernel_cols = 0;
+        bool dilate = false, square = false;
+        PipelineCombine combine = COMBINE_MAX;
+
+        explicit Node(Kind kind) : kind(kind) {}
+    };
+
+    // 融合进组的点运算：灰度化或查表
+    struct PointOp {
+        bool gray = false;
+        ChannelLut lut = ChannelLut(Lut::identity(), 1);
+    };
+
+    // 一组 = 一个头部运算 + 融合的点运算，只有组的结果有行缓冲
+    struct Group {
+        Kind kind;                   // 头部运算；NODE_LUT 表示直接读取输入组，全部工作由 ops 完成
+        const Node* head = nullptr;  // 头节点
+        int a = -1, b = -1;          // 输入组
+        int radius = 0;              // 头部运算读取输入组的垂直半径
+        int reach = 0;               // 输出第 y 行时需要本组的 [y - reach, y + reach] 行
+        int head_channels = 0;       // 头部运算结果的通道数（NODE_LUT 为输入组的通道数）
+        int stride = 0;              // 行缓冲每个像素的字节数（各步中最多的通道数）
+        std::vector<PointOp> ops;
+    };
+
+    struct Plan {
+        std::vector<Group> groups;
+        std::vector<int> group_of;  // 节点所在的组
+        std::vector<int> channels;  // 节点的通道数
+    };
+
+    std::vector<Node> nodes_;
+
+    int check(PipelineNode n) const {
+        CV_Assert(n.id >= 0 && n.id < (int)nodes_.size());
+        return n.id;
+    }
+
+    PipelineNode add(const Node& n) {
+        nodes_.push_back(n);
+        return PipelineNode{(int)nodes_.size() - 1};
+    }
+
+    Plan compile(int channels, const std::vector<PipelineNode>& outputs) const {
+        int count = (int)nodes_.size();
+        // 只保留输出依赖的节点（节点只引用编号更小的节点，倒序一遍即可）
+        std::vector<char> live(count, 0), output(count, 0);
+        for (PipelineNode o : outputs) {
+            live[check(o)] = output[o.id] = 1;
+        }
+        std::vector<int> consumers(count, 0);
+        for (int i = count - 1; i >= 0; --i) {
+            if (!live[i]) {
+                continue;
+            }
+            for (int in : {nodes_[i].a, nodes_[i].b}) {
+                if (in >= 0) {
+                    live[in] = 1;
+                    ++consumers[in];
+                }
+            }
+        }
+
+        Plan plan;
+        plan.group_of.assign(count, -1);
+        plan.channels.assign(count, 0);
+        for (int i = 0; i < count; ++i) {
+            if (!live[i]) {
+                continue;
+            }
+            const Node& n = nodes_[i];
+            int in_cn = n.a >= 0 ? plan.channels[n.a] : channels;
+            int cn = in_cn;
+            PointOp op;
+            switch (n.kind) {
+                case NODE_GRAY:
+                    CV_Assert(in_cn == 3);
+                    cn = 1;
+                    op.gray = true;
+                    break;
+                case NODE_LUT:
+                    CV_Assert(n.lut.channels == 0 || n.lut.channels == in_cn);
+                    op.lut = n.lut.channels == 0 ? ChannelLut(n.lut.ch[0], in_cn) : n.lut;
+                    break;
+                case NODE_COMBINE:
+                    CV_Assert(plan.channels[n.b] == in_cn);
+                    break;
+                default:
+                    break;
+            }
+            CV_Assert(cn >= 1 && cn <= 4);
+            plan.channels[i] = cn;
+
+            if (n.kind == NODE_GRAY || n.kind == NODE_LUT) {
+                // 输入只被本节点使用时融合进输入所在的组，相邻的查表合成一张
+                int g = plan.group_of[n.a];
+                if (consumers[n.a] == 1 && !output[n.a]) {
+                    Group& G = plan.groups[g];
+                    if (!op.gray && !G.ops.empty() && !G.ops.back().gray) {
+                        G.ops.back().lut = G.ops.back().lut.then(op.lut);
+                    } else {
+                        G.ops.push_back(op);
+                    }
+                    plan.group_of[i] = g;
+                    continue;
+                }
+                Group G;
+                G.kind = NODE_LUT;
+                G.head = &n;
+                G.a = g;
+                G.head_channels = in_cn;
+                G.ops.push_back(op);
+                plan.group_of[i] = (int)plan.groups.size();
+                plan.groups.push_back(G);
+                continue;
+            }
+
+            Group G;
+            G.kind = n.kind;
+            G.head = &n;
+            G.a = n.a >= 0 ? plan.group_of[n.a] : -1;
+            G.b = n.b >= 0 ? plan.group_of[n.b] : -1;
+            G.radius = n.kind == NODE_CONVOLVE ? n.kernel_rows / 2 : n.kind == NODE_MORPHOLOGY ? 1 : 0;
+            G.head_channels = cn;
+            plan.group_of[i] = (int)plan.groups.size();
+            plan.groups.push_back(G);
+        }
+
+        // 行缓冲的范围：从输出往回累加各级的垂直半径
+        for (int g = (int)plan.groups.size() - 1; g >= 0; --g) {
+            const Group& G = plan.groups[g];
+            for (int in : {G.a, G.b}) {
+                if (in >= 0) {
+                    Group& I = plan.groups[in];
+                    I.reach = std::max(I.reach, G.reach + G.radius);
+                }
+            }
+        }
+        for (Group& G : plan.groups) {
+            int cn = G.kind == NODE_LUT ? 1 : G.head_channels;
+            for (const PointOp& op : G.ops) {
+                cn = std::max(cn, op.gray ? 1 : op.lut.channels);
+            }
+            G.stride = cn;
+        }
+        return plan;
+    }
+
+    // 一个行带的计算状态：各组的环形行缓冲和卷积的输入缓冲
+    class State {
+       public:
+        State(const Plan& plan, const cv::Mat& src)
+            : plan_(plan), src_(src), ring_(plan.groups.size()), tag_(plan.groups.size()),
+              conv_i_(plan.groups.size()), conv_f_(plan.groups.size()) {
+            int max_cn = 1;
+            for (size_t g = 0; g < plan.groups.size(); ++g) {
+                const Group& G = plan.groups[g];
+                max_cn = std::max(max_cn, G.stride);
+                if (G.kind == NODE_INPUT && G.ops.empty()) {
+                    continue;  // 直接读取输入图像
+                }
+                int rows = 2 * G.reach + 1;
+                ring_[g].resize((size_t)rows * src.cols * G.stride);
+                tag_[g].assign(rows, -1);
+                if (G.kind == NODE_CONVOLVE) {
+                    const Convolver& conv = *G.head->conv;
+                    int cn = G.head_channels;
+                    if (conv.integer()) {
+                        conv_i_[g].reset(new ConvolveRows<int16_t>(conv, src.cols, src.rows, cn));
+                    } else {
+                        conv_f_[g].reset(new ConvolveRows<float>(conv, src.cols, src.rows, cn));
+                    }
+                }
+            }
+            tmp_.resize((size_t)src.cols * max_cn);
+        }
+
+        /**
+         * @brief 第 g 组的第 y 行（0 <= y < rows），只在下一次请求同一槽位的其他行之前有效
+         */
+        const uint8_t* row(int g, int y) {
+            const Group& G = plan_.groups[g];
+            if (G.kind == NODE_INPUT && G.ops.empty()) {
+                return src_.ptr<uint8_t>(y);
+            }
+            int slots = (int)tag_[g].size(), slot = y % slots;
+            uint8_t* out = &ring_[g][(size_t)slot * src_.cols * G.stride];
+            if (tag_[g][slot] == y) {
+                return out;
+            }
+            tag_[g][slot] = y;
+
+            int width = src_.cols, n = width * G.head_channels;
+            const uint8_t* in = out;  // 点运算的输入
+            switch (G.kind) {
+                case NODE_INPUT:
+                    in = src_.ptr<uint8_t>(y);
+                    break;
+                case NODE_LUT:
+                    in = row(G.a, y);
+                    break;
+                case NODE_CONVOLVE: {
+                    auto input = [&](int iy) { return row(G.a, iy); };
+                    if (conv_i_[g]) {
+                        conv_i_[g]->row(y, input, out);
+                    } else {
+                        conv_f_[g]->row(y, input, out);
+                    }
+                    break;
+                }
+                case NODE_MORPHOLOGY: {
+                    // 图像外的行、列不参与，等价于重复边缘
+                    const uint8_t* up = row(G.a, std::max(y - 1, 0));
+                    const uint8_t* mid = row(G.a, y);
+                    const uint8_t* down = row(G.a, std::min(y + 1, src_.rows - 1));
+                    if (G.head->dilate) {
+                        morph<true>(up, mid, down, G.head->square, G.head_channels, out);
+                    } else {
+                        morph<false>(up, mid, down, G.head->square, G.head_channels, out);
+                    }
+                    break;
+                }
+                case NODE_COMBINE: {
+                    const uint8_t* a = row(G.a, y);
+                    combine_row(a, row(G.b, y), n, G.head->combine, out);
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            for (const PointOp& op : G.ops) {
+                if (op.gray) {
+                    bgr_to_gray_row(in, width, out);
+                } else {
+                    apply_lut_u8(in, out, (size_t)width, op.lut);
+                }
+                in = out;
+            }
+            return out;
+        }
+
+       private:
+        const Plan& plan_;
+        const cv::Mat& src_;
+        std::vector<std::vector<uint8_t>> ring_;
+        std::vector<std::vector<int>> tag_;
+        std::vector<std::unique_ptr<ConvolveRows<int16_t>>> conv_i_;
+        std::vector<std::unique_ptr<ConvolveRows<float>>> conv_f_;
+        std::vector<uint8_t> tmp_;
+
+        template <bool MAX>
+        void morph(const uint8_t* up, const uint8_t* mid, const uint8_t* down, bool square, int cn, uint8_t* out) {
+            int width = src_.cols, n = width * cn;
+            if (square) {
+                morphology_vertical<MAX>(up, mid, down, n, tmp_.data());
+                morphology_horizontal<MAX>(tmp_.data(), width, cn, out);
+            } else {
+                morphology_horizontal<MAX>(mid, width, cn, out);
+                morphology_vertical<MAX>(up, out, down, n, out);
+            }
+        }
+    };
+};
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 池化方式
+ */
+enum PoolType {
+    POOL_AVG,  // 平均池化（answer_7）
+    POOL_MAX,  // 最大池化（answer_8）
+};
+
+/**
+ * @brief 池化参数
+ */
+struct PoolConfig {
+    int kernel = 8;          // 窗口边长（不超过 257）
+    int stride = 0;          // 步长，0 表示等于 kernel
+    int pad = 0;             // 四周的填充，填充部分不参与计算
+    PoolType type = POOL_AVG;
+    bool mosaic = false;     // true：输出与输入同尺寸，每个窗口的结果填满其 stride × stride 的格子
+    bool ceil_mode = false;  // true：末尾不足一个窗口的部分也输出（mosaic 时总是如此）
+};
+
+/**
+ * @brief 池化输出（降采样时）的尺寸
+ */
+inline cv::Size pool_output_size(cv::Size in, const PoolConfig& cfg) {
+    int s = cfg.stride > 0 ? cfg.stride : cfg.kernel;
+    bool ceil_mode = cfg.ceil_mode || cfg.mosaic;
+    auto len = [&](int n) {
+        int span = n + 2 * cfg.pad - cfg.kernel;
+        if (span < 0) {
+            return ceil_mode && n > 0 ? 1 : 0;
+        }
+        int count = (ceil_mode ? (span + s - 1) / s : span / s) + 1;
+        // 最后一个窗口不能从图像之外开始
+        if (count > 1 && (count - 1) * s - cfg.pad >= n) {
+            --count;
+        }
+        return count;
+    };
+    return cv::Size(len(in.width), len(in.height));
+}
+
+/**
+ * @brief 垂直方向求和：把若干行 8 bit 数据累加到 uint16 缓冲中
+ */
+inline void pool_sum_rows(const uint8_t* const* rows, int count, int n, uint16_t* out) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = zero, hi = zero;
+        for (int r = 0; r < count; ++r) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(rows[r] + i));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), lo);
+        _mm_storeu_si128((__m128i*)(out + i + 8), hi);
+    }
+#endif
+    for (; i < n; ++i) {
+        uint16_t sum = 0;
+        for (int r = 0; r < count; ++r) {
+            sum += rows[r][i];
+        }
+        out[i] = sum;
+    }
+}
+
+/**
+ * @brief 垂直方向求最大值（pmaxub）
+ */
+inline void pool_max_rows(const uint8_t* const* rows, int count, int n, uint8_t* out) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i*)(rows[0] + i));
+        for (int r = 1; r < count; ++r) {
+            m = _mm_max_epu8(m, _mm_loadu_si128((const __m128i*)(rows[r] + i)));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), m);
+    }
+#endif
+    for (; i < n; ++i) {
+        uint8_t m = rows[0][i];
+        for (int r = 1; r < count; ++r) {
+            m = std::max(m, rows[r][i]);
+        }
+        out[i] = m;
+    }
+}
+
+/**
+ * @brief 单通道、窗口不重叠且宽度为 8 的倍数时，直接用 psadbw 求每行的窗口和
+ *
+ * psadbw 与 0 做差的绝对值之和即 8 个字节之和，一条指令完成 16 个像素的水平归约。
+ *
+ * @param row 一行数据
+ * @param windows 窗口个数（每个窗口 kernel 个像素，首尾相接）
+ * @param kernel 窗口宽度，8 的倍数
+ * @param sums 累加到的窗口和
+ */
+inline void pool_sad_row(const uint8_t* row, int windows, int kernel, uint32_t* sums) {
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (int w = 0; w < windows; ++w) {
+        const uint8_t* p = row + (size_t)w * kernel;
+        __m128i acc = zero;
+        int i = 0;
+        for (; i + 16 <= kernel; i += 16) {
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(p + i)), zero));
+        }
+        if (i < kernel) {
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i*)(p + i)), zero));
+        }
+        sums[w] += (uint32_t)(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+    }
+#else
+    for (int w = 0; w < windows; ++w) {
+        const uint8_t* p = row + (size_t)w * kernel;
+        uint32_t sum = 0;
+        for (int i = 0; i < kernel; ++i) {
+            sum += p[i];
+        }
+        sums[w] += sum;
+    }
+#endif
+}
+
+/**
+ * @brief 池化
+ *
+ * 对每个输出行，先把窗口覆盖的若干输入行在垂直方向归约（求和用 uint16、最大值用 pmaxub），
+ * 再在水平方向按窗口归约：求和用前缀和，窗口重叠时每个输出也只需 O(1)。
+ * 单通道、窗口不重叠且宽度为 8 的倍数时改用 psadbw 先做水平归约。
+ * 平均值按窗口内的有效像素数计算，与 answer_7 一样截断取整。
+ * 各输出行相互独立，按行带并行处理，行指针与各级归约的缓冲在每个行带内只分配一次。
+ *
+ * @param src CV_8U 图像，1~4 通道
+ * @param dst 输出：降采样的图像，或 mosaic 模式下与输入同尺寸的马赛克图像
+ * @param cfg 参数
+ */
+inline void pool(const cv::Mat& src, cv::Mat& dst, const PoolConfig& cfg = PoolConfig()) {
+    CV_Assert(src.depth() == CV_8U && src.data != dst.data);
+    CV_Assert(cfg.kernel >= 1 && cfg.kernel <= 257 && cfg.stride >= 0 && cfg.pad >= 0 && cfg.pad < cfg.kernel);
+    int k = cfg.kernel, s = cfg.stride > 0 ? cfg.stride : k, pad = cfg.pad;
+    int cn = src.channels(), width = src.cols, height = src.rows;
+    cv::Size out_size = pool_output_size(src.size(), cfg);
+    if (cfg.mosaic) {
+        dst.create(height, width, src.type());
+    } else {
+        dst.create(out_size.height, out_size.width, src.type());
+    }
+    int out_w = out_size.width;
+    bool sad = cn == 1 && s == k && pad == 0 && k % 8 == 0 && cfg.type == POOL_AVG;
+
+    int n = width * cn;
+
+    parallel_for_rows(out_size.height, 0, [&](const ParallelRange& band) {
+        std::vector<const uint8_t*> rows(k);
+        std::vector<uint8_t> values((size_t)out_w * cn);
+        std::vector<uint32_t> sums(sad ? out_w : 0);
+        std::vector<uint16_t> column_sum(!sad && cfg.type == POOL_AVG ? n : 0);
+        std::vector<uint32_t> prefix(!sad && cfg.type == POOL_AVG ? (size_t)(width + 1) * cn : 0, 0);
+        std::vector<uint8_t> column_max(cfg.type == POOL_MAX ? n : 0);
+        for (int oy = band.begin; oy < band.end; ++oy) {
+            int y0 = std::max(oy * s - pad, 0), y1 = std::min(oy * s - pad + k, height);
+            for (int y = y0; y < y1; ++y) {
+                rows[y - y0] = src.ptr<uint8_t>(y);
+            }
+
+            if (sad) {
+                // 整窗口部分用 psadbw，末尾不足一个窗口的部分（ceil_mode）逐像素累加
+                int full = std::min(out_w, width / k);
+                std::fill(sums.begin(), sums.end(), 0);
+                for (int i = 0; i < y1 - y0; ++i) {
+                    const uint8_t* r = rows[i];
+                    pool_sad_row(r, full, k, sums.data());
+                    for (int x = full * k; x < std::min(width, out_w * k); ++x) {
+                        sums[x / k] += r[x];
+                    }
+                }
+                for (int ox = 0; ox < out_w; ++ox) {
+                    int cols = std::min(ox * k + k, width) - ox * k;
+                    values[ox] = (uint8_t)(sums[ox] / (uint32_t)(cols * (y1 - y0)));
+                }
+            } else if (cfg.type == POOL_AVG) {
+                // 垂直求和后再对每个通道做前缀和（prefix 的前 cn 个元素始终为 0）
+                pool_sum_rows(rows.data(), y1 - y0, n, column_sum.data());
+                for (int x = 0; x < width; ++x) {
+                    for (int c = 0; c < cn; ++c) {
+                        prefix[(x + 1) * cn + c] = prefix[x * cn + c] + column_sum[x * cn + c];
+                    }
+                }
+                for (int ox = 0; ox < out_w; ++ox) {
+                    int x0 = std::max(ox * s - pad, 0), x1 = std::min(ox * s - pad + k, width);
+                    uint32_t area = (uint32_t)((x1 - x0) * (y1 - y0));
+                    for (int c = 0; c < cn; ++c) {
+                        values[ox * cn + c] = (uint8_t)((prefix[x1 * cn + c] - prefix[x0 * cn + c]) / area);
+                    }
+                }
+            } else {
+                pool_max_rows(rows.data(), y1 - y0, n, column_max.data());
+                for (int ox = 0; ox < out_w; ++ox) {
+                    int x0 = std::max(ox * s - pad, 0), x1 = std::min(ox * s - pad + k, width);
+                    for (int c = 0; c < cn; ++c) {
+                        uint8_t m = 0;
+                        for (int x = x0; x < x1; ++x) {
+                            m = std::max(m, column_max[x * cn + c]);
+                        }
+                        values[ox * cn + c] = m;
+                    }
+                }
+            }
+
+            if (!cfg.mosaic) {
+                std::memcpy(dst.ptr<uint8_t>(oy), values.data(), values.size());
+                continue;
+            }
+
+            // 马赛克：每个结果填满 stride × stride 的格子，先展开一行再复制到格子覆盖的各行
+            // 第一个和最后一个格子延伸到图像边缘，保证整幅图像都被覆盖
+            int cy0 = oy == 0 ? 0 : std::min(std::max(oy * s - pad, 0), height);
+            int cy1 = oy == out_size.height - 1 ? height : std::min(oy * s - pad + s, height);
+            if (cy0 >= cy1) {
+                continue;
+            }
+            uint8_t* first = dst.ptr<uint8_t>(cy0);
+            for (int ox = 0; ox < out_w; ++ox) {
+                int cx0 = ox == 0 ? 0 : std::min(std::max(ox * s - pad, 0), width);
+                int cx1 = ox == out_w - 1 ? width : std::min(ox * s - pad + s, width);
+                for (int x = cx0; x < cx1; ++x) {
+                    for (int c = 0; c < cn; ++c) {
+                        first[x * cn + c] = values[ox * cn + c];
+                    }
+                }
+            }
+            for (int y = cy0 + 1; y < cy1; ++y) {
+                std::memcpy(dst.ptr<uint8_t>(y), first, n);
+            }
+        }
+    });
+}
+
+/**
+ * @brief 池化（返回新图像）
+ */
+inline cv::Mat pool(const cv::Mat& src, const PoolConfig& cfg = PoolConfig()) {
+    cv::Mat dst;
+    pool(src, dst, cfg);
+    return dst;
+}
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+#include "warp.hpp"
+
+/**
+ * @brief 3 × 3 单应矩阵（行主序）
+ *
+ * 正向映射（源 -> 目标）：[x', y', w'] = H · [x, y, 1]，目标坐标为 (x' / w', y' / w')。
+ */
+struct Homography {
+    double h[9];
+};
+
+/**
+ * @brief 求单应矩阵的逆
+ */
+inline Homography homography_invert(const Homography& m) {
+    const double* a = m.h;
+    Homography inv;
+    double* r = inv.h;
+    r[0] = a[4] * a[8] - a[5] * a[7];
+    r[1] = a[2] * a[7] - a[1] * a[8];
+    r[2] = a[1] * a[5] - a[2] * a[4];
+    r[3] = a[5] * a[6] - a[3] * a[8];
+    r[4] = a[0] * a[8] - a[2] * a[6];
+    r[5] = a[2] * a[3] - a[0] * a[5];
+    r[6] = a[3] * a[7] - a[4] * a[6];
+    r[7] = a[1] * a[6] - a[0] * a[7];
+    r[8] = a[0] * a[4] - a[1] * a[3];
+    double det = a[0] * r[0] + a[1] * r[3] + a[2] * r[6];
+    for (int i = 0; i < 9; ++i) {
+        r[i] /= det;
+    }
+    return inv;
+}
+
+/**
+ * @brief 由 4 对对应点求单应矩阵
+ *
+ * 固定 h[8] = 1，对 8 元线性方程组做列主元高斯消元。
+ *
+ * @param src 源图上的 4 个点
+ * @param dst 目标图上对应的 4 个点
+ *
+ * @return 源 -> 目标的单应矩阵
+ */
+inline Homography homography_from_points(const cv::Point2f src[4], const cv::Point2f dst[4]) {
+    double A[8][9];
+    for (int i = 0; i < 4; ++i) {
+        double x = src[i].x, y = src[i].y, u = dst[i].x, v = dst[i].y;
+        double r0[9] = {x, y, 1, 0, 0, 0, -u * x, -u * y, u};
+        double r1[9] = {0, 0, 0, x, y, 1, -v * x, -v * y, v};
+        std::copy(r0, r0 + 9, A[2 * i]);
+        std::copy(r1, r1 + 9, A[2 * i + 1]);
+    }
+
+    for (int c = 0; c < 8; ++c) {
+        int p = c;
+        for (int r = c + 1; r < 8; ++r) {
+            if (std::fabs(A[r][c]) > std::fabs(A[p][c])) {
+                p = r;
+            }
+        }
+        std::swap(A[c], A[p]);
+        for (int r = 0; r < 8; ++r) {
+            if (r != c) {
+                double f = A[r][c] / A[c][c];
+                for (int k = c; k < 9; ++k) {
+                    A[r][k] -= f * A[c][k];
+                }
+            }
+        }
+    }
+
+    Homography H;
+    for (int i = 0; i < 8; ++i) {
+        H.h[i] = A[i][8] / A[i][i];
+    }
+    H.h[8] = 1;
+    return H;
+}
+
+/**
+ * @brief 透视变换
+ *
+ * 每行输出的齐次坐标分子、分母按步长递增，每个像素只做一次除法；
+ * 坐标换算成 16.16 定点数后复用 warp_affine 的采样器，源图宽高同样不能超过 WARP_MAX_SIZE。
+ * 透视变换下有效区间不是线性的，这里逐像素判断并对边缘截断。
+ * 同一组参数需要处理很多帧时应使用 RemapTable。
+ *
+ * @param src CV_8U 源图，1~4 通道
+ * @param dst 输出
+ * @param H 正向单应矩阵（源 -> 目标）
+ * @param dsize 输出尺寸
+ * @param interp 插值方式
+ * @param border 图像外的填充值
+ */
+inline void warp_perspective(const cv::Mat& src, cv::Mat& dst, const Homography& H, cv::Size dsize,
+                             WarpInterp interp = WARP_BILINEAR, uint8_t border = 0) {
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4 && src.data != dst.data);
+    CV_Assert(src.cols <= WARP_MAX_SIZE && src.rows <= WARP_MAX_SIZE);
+    dst.create(dsize.height, dsize.width, src.type());
+
+    Homography inv = homography_invert(H);
+    const double* m = inv.h;
+    WarpSampler s = {src.data, src.step, src.cols, src.rows, src.channels()};
+    int cn = s.channels;
+    double lo = -0.5, hi_x = s.width - 0.5, hi_y = s.height - 0.5;
+
+    parallel_for_rows(dsize.height, 0, [&](const ParallelRange& band) {
+        for (int y = band.begin; y < band.end; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(y);
+            // 像素中心对齐
+            double yc = y + 0.5;
+            double nx = m[0] * 0.5 + m[1] * yc + m[2];
+            double ny = m[3] * 0.5 + m[4] * yc + m[5];
+            double nw = m[6] * 0.5 + m[7] * yc + m[8];
+
+            for (int x = 0; x < dsize.width; ++x, nx += m[0], ny += m[3], nw += m[6]) {
+                uint8_t* o = out + (size_t)x * cn;
+                double iw = 1.0 / nw;
+                double sx = nx * iw - 0.5, sy = ny * iw - 0.5;
+                if (!(nw > 0) || !(sx >= lo && sx < hi_x && sy >= lo && sy < hi_y)) {
+                    std::fill(o, o + cn, border);
+                    continue;
+                }
+
+                int32_t X = (int32_t)std::lround(sx * WARP_FIX_ONE);
+                int32_t Y = (int32_t)std::lround(sy * WARP_FIX_ONE);
+                switch (interp) {
+                    case WARP_NEAREST:
+                        s.nearest(X, Y, o);
+                        break;
+                    case WARP_BILINEAR:
+                        s.bilinear<true>(X, Y, o);
+                        break;
+                    case WARP_BICUBIC:
+                        s.bicubic<true>(X, Y, o);
+                        break;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief 透视变换（返回新图像）
+ */
+inline cv::Mat warp_perspective(const cv::Mat& src, const Homography& H, cv::Size dsize,
+                                WarpInterp interp = WARP_BILINEAR, uint8_t border = 0) {
+    cv::Mat dst;
+    warp_perspective(src, dst, H, dsize, interp, border);
+    return dst;
+}
+
+/**
+ * @brief 镜头畸变参数（Brown-Conrady 模型）
+ */
+struct LensDistortion {
+    double fx, fy, cx, cy;  // 相机内参
+    double k1, k2, k3;      // 径向畸变
+    double p1, p2;          // 切向畸变
+};
+
+/**
+ * @brief 预计算的重映射表
+ *
+ * 每个目标像素存 4 字节的源坐标（x、y 各 16 bit，为双线性 2 × 2 邻域的左上角）
+ * 和 2 字节的插值权重（fx、fy 各 7 bit 小数，取值 0~128）。
+ * 建表时已经把邻域调整到图像内部，因此应用时不需要任何边界判断；
+ * 图像外的像素权重标记为 REMAP_INVALID，输出填充值。
+ * 一个表对应一组固定的源/目标尺寸，构建一次后对每一帧重复使用，
+ * 每帧的开销只剩按表取像素的访存。
+ */
+class RemapTable {
+   public:
+    static const uint16_t REMAP_INVALID = 0xFFFF;
+
+    RemapTable() {}
+
+    /**
+     * @brief 由映射函数建表
+     *
+     * @param src_size 源尺寸
+     * @param dst_size 目标尺寸
+     * @param map 目标像素中心 (x, y) -> 源坐标（像素中心为整数），返回 false 表示没有对应的源像素
+     */
+    RemapTable(cv::Size src_size, cv::Size dst_size, const std::function<bool(double, double, double&, double&)>& map)
+        : src_size_(src_size), dst_size_(dst_size) {
+        CV_Assert(src_size.width >= 2 && src_size.height >= 2 && src_size.width <= 65535 &&
+                  src_size.height <= 65535);
+        size_t n = (size_t)dst_size.width * dst_size.height;
+        xy_.resize(n);
+        weight_.resize(n);
+
+        parallel_for_rows(dst_size.height, 0, [&](const ParallelRange& band) {
+            for (int y = band.begin; y < band.end; ++y) {
+                for (int x = 0; x < dst_size.width; ++x) {
+                    size_t i = (size_t)y * dst_size.width + x;
+                    double sx, sy;
+                    if (!map(x, y, sx, sy) || !(sx >= -0.5 && sx < src_size.width - 0.5 && sy >= -0.5 &&
+                                                sy < src_size.height - 0.5)) {
+                        xy_[i] = 0;
+                        weight_[i] = REMAP_INVALID;
+                        continue;
+                    }
+
+                    // 7 bit 定点坐标，邻域限制在图像内部：边缘处的权重取 0 或 128
+                    int ix = (int)std::lround(std::min(std::max(sx, 0.0), src_size.width - 1.0) * 128);
+                    int iy = (int)std::lround(std::min(std::max(sy, 0.0), src_size.height - 1.0) * 128);
+                    int x0 = std::min(ix >> 7, src_size.width - 2);
+                    int y0 = std::min(iy >> 7, src_size.height - 2);
+                    xy_[i] = (uint32_t)x0 | ((uint32_t)y0 << 16);
+                    weight_[i] = (uint16_t)((ix - (x0 << 7)) | ((iy - (y0 << 7)) << 8));
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief 由单应矩阵建表
+     */
+    static RemapTable from_homography(const Homography& H, cv::Size src_size, cv::Size dst_size) {
+        Homography inv = homography_invert(H);
+        const double* m = inv.h;
+        return RemapTable(src_size, dst_size, [m](double x, double y, double& sx, double& sy) {
+            double xc = x + 0.5, yc = y + 0.5;
+            double w = m[6] * xc + m[7] * yc + m[8];
+            if (!(w > 0)) {
+                return false;
+            }
+            sx = (m[0] * xc + m[1] * yc + m[2]) / w - 0.5;
+            sy = (m[3] * xc + m[4] * yc + m[5]) / w - 0.5;
+            return true;
+        });
+    }
+
+    /**
+     * @brief 由镜头畸变参数建去畸变表
+     *
+     * 目标为去畸变后的图像（与源图使用同一组内参），对每个目标像素施加畸变模型得到源坐标。
+     */
+    static RemapTable from_distortion(const LensDistortion& d, cv::Size src_size, cv::Size dst_size) {
+        return RemapTable(src_size, dst_size, [d](double x, double y, double& sx, double& sy) {
+            double u = (x - d.cx) / d.fx, v = (y - d.cy) / d.fy;
+            double r2 = u * u + v * v;
+            double radial = 1 + r2 * (d.k1 + r2 * (d.k2 + r2 * d.k3));
+            double ud = u * radial + 2 * d.p1 * u * v + d.p2 * (r2 + 2 * u * u);
+            double vd = v * radial + d.p1 * (r2 + 2 * v * v) + 2 * d.p2 * u * v;
+            sx = ud * d.fx + d.cx;
+            sy = vd * d.fy + d.cy;
+            return true;
+        });
+    }
+
+    cv::Size src_size() const { return src_size_; }
+    cv::Size dst_size() const { return dst_size_; }
+
+    /**
+     * @brief 按表重映射一帧
+     *
+     * 单通道时用 AVX2 的 vpgatherdd 一次取 8 个像素的 2 × 2 邻域（偏移为 32 bit，源图不超过 2 GB 时），
+     * 多通道按像素处理。
+     * 直接包含本头文件时 AVX2 路径只在以 -mavx2（或 -march=native）编译时启用，
+     * 否则全部走标量路径；通过 libimgproc 的 imgproc::remap 调用时按 cpuid 选择。
+     *
+     * @param src CV_8U 源图，尺寸必须与建表时一致
+     * @param dst 输出
+     * @param border 图像外的填充值
+     */
+    void apply(const cv::Mat& src, cv::Mat& dst, uint8_t border = 0) const {
+        CV_Assert(src.size() == src_size_);
+        apply(src, dst, dst_size_, xy_.data(), weight_.data(), border);
+    }
+
+    /**
+     * @brief 按表重映射一帧（返回新图像）
+     */
+    cv::Mat apply(const cv::Mat& src, uint8_t border = 0) const {
+        cv::Mat dst;
+        apply(src, dst, border);
+        return dst;
+    }
+
+    const uint32_t* xy() const { return xy_.data(); }
+    const uint16_t* weights() const { return weight_.data(); }
+
+    /**
+     * @brief 按表中的数据重映射（供 libimgproc 的各指令集版本调用）
+     *
+     * @param src CV_8U 源图，尺寸为建表时的源尺寸
+     * @param dst 输出
+     * @param dst_size 目标尺寸
+     * @param xy 每个目标像素的源坐标，见 xy()
+     * @param wt 每个目标像素的插值权重，见 weights()
+     * @param border 图像外的填充值
+     */
+    static void apply(const cv::Mat& src, cv::Mat& dst, cv::Size dst_size, const uint32_t* xy, const uint16_t* wt,
+                      uint8_t border) {
+        CV_Assert(src.depth() == CV_8U && src.cols >= 2 && src.rows >= 2 && src.data != dst.data);
+        dst.create(dst_size.height, dst_size.width, src.type());
+        int cn = src.channels();
+        // SIMD 路径的 gather 偏移是有符号 32 bit，源图超过 2 GB 时会回绕，只能走标量路径
+        bool simd = (uint64_t)src.step * src.rows <= (uint64_t)INT32_MAX;
+
+        parallel_for_rows(dst_size.height, 0, [&](const ParallelRange& band) {
+            for (int y = band.begin; y < band.end; ++y) {
+                const uint32_t* row_xy = xy + (size_t)y * dst_size.width;
+                const uint16_t* row_wt = wt + (size_t)y * dst_size.width;
+                uint8_t* out = dst.ptr<uint8_t>(y);
+                int x = 0;
+
+                if (cn == 1 && simd) {
+                    x = apply_row_simd(src, row_xy, row_wt, dst_size.width, out, border);
+                }
+
+                for (; x < dst_size.width; ++x) {
+                    sample(src, row_xy[x], row_wt[x], out + (size_t)x * cn, border);
+                }
+            }
+        });
+    }
+
+   private:
+    cv::Size src_size_, dst_size_;
+    std::vector<uint32_t> xy_;
+    std::vector<uint16_t> weight_;
+
+    static void sample(const cv::Mat& src, uint32_t xy, uint16_t w, uint8_t* o, uint8_t border) {
+        int cn = src.channels();
+        if (w == REMAP_INVALID) {
+            std::fill(o, o + cn, border);
+            return;
+        }
+        int fx = w & 0xFF, fy = w >> 8;
+        const uint8_t* p00 = src.ptr<uint8_t>(xy >> 16) + (size_t)(xy & 0xFFFF) * cn;
+        const uint8_t* p10 = p00 + src.step;
+        for (int c = 0; c < cn; ++c) {
+            int top = p00[c] * (128 - fx) + p00[c + cn] * fx;
+            int bottom = p10[c] * (128 - fx) + p10[c + cn] * fx;
+            o[c] = (uint8_t)((top * (128 - fy) + bottom * fy + (1 << 13)) >> 14);
+        }
+    }
+
+    // 单通道的 SIMD 路径，返回处理到的列
+    static int apply_row_simd(const cv::Mat& src, const uint32_t* xy, const uint16_t* wt, int width, uint8_t* out,
+                              uint8_t border) {
+        int x = 0;
+#if defined(__AVX2__)
+        // 以 32 bit 为单位读取 2 × 2 邻域的每一行；邻域在最后一行末尾时会越过缓冲区，这样的块交给标量路径
+        const __m256i last_y = _mm256_set1_epi32(src.rows - 2);
+        const __m256i last_x = _mm256_set1_epi32(src.cols - 4);
+        const __m256i mask16 = _mm256_set1_epi32(0xFFFF);
+        const __m256i mask8 = _mm256_set1_epi32(0xFF);
+        const __m256i k128 = _mm256_set1_epi32(128);
+        const __m256i invalid = _mm256_set1_epi32(REMAP_INVALID);
+        const __m256i vstride = _mm256_set1_epi32((int)src.step);
+        const __m256i vborder = _mm256_set1_epi32(border);
+        const int* base = (const int*)src.data;
+
+        for (; x + 8 <= width; x += 8) {
+            __m256i vxy = _mm256_loadu_si256((const __m256i*)(xy + x));
+            __m256i vy = _mm256_srli_epi32(vxy, 16);
+            __m256i tail = _mm256_and_si256(_mm256_cmpeq_epi32(vy, last_y),
+                                            _mm256_cmpgt_epi32(_mm256_and_si256(vxy, mask16), last_x));
+            if (!_mm256_testz_si256(tail, tail)) {
+                for (int i = x; i < x + 8; ++i) {
+                    sample(src, xy[i], wt[i], out + i, border);
+                }
+                continue;
+            }
+            __m256i vw = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(wt + x)));
+            __m256i bad = _mm256_cmpeq_epi32(vw, invalid);
+
+            __m256i off = _mm256_add_epi32(_mm256_mullo_epi32(vy, vstride), _mm256_and_si256(vxy, mask16));
+            off = _mm256_andnot_si256(bad, off);
+            __m256i g0 = _mm256_i32gather_epi32(base, off, 1);
+            __m256i g1 = _mm256_i32gather_epi32(base, _mm256_add_epi32(off, vstride), 1);
+
+            __m256i fx = _mm256_and_si256(vw, mask8);
+            __m256i fy = _mm256_and_si256(_mm256_srli_epi32(vw, 8), mask8);
+            __m256i ifx = _mm256_sub_epi32(k128, fx);
+            __m256i ify = _mm256_sub_epi32(k128, fy);
+
+            __m256i top = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(g0, mask8), ifx),
+                                           _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(g0, 8), mask8), fx));
+            __m256i bottom =
+                _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(g1, mask8), ifx),
+                                 _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(g1, 8), mask8), fx));
+            __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(top, ify), _mm256_mullo_epi32(bottom, fy));
+            v = _mm256_srli_epi32(_mm256_add_epi32(v, _mm256_set1_epi32(1 << 13)), 14);
+            v = _mm256_blendv_epi8(v, vborder, bad);
+
+            // 8 × int32 -> 8 × uint8
+            __m128i p16 = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            _mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(p16, p16));
+        }
+#else
+        (void)src;
+        (void)xy;
+        (void)wt;
+        (void)width;
+        (void)out;
+        (void)border;
+#endif
+        return x;
+    }
+};
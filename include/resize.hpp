@@ -0,0 +1,422 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 重采样滤波器
+ */
+enum ResampleFilter {
+    RESAMPLE_BILINEAR,  // 三角核，半径 1
+    RESAMPLE_BICUBIC,   // 三次卷积核（a = -1，与 answer_27 的 h 相同），半径 2
+    RESAMPLE_AREA,      // 盒核，缩小时等价于按面积平均
+    RESAMPLE_LANCZOS3,  // Lanczos 核，半径 3
+};
+
+/**
+ * @brief 一个方向上预计算的采样表
+ *
+ * 目标的第 i 个像素 = Σ_t weight[i * taps + t] * src[index[i] + t]，权重为 Q14 定点数且和为 1 << 14。
+ * 越界的 tap 已经折叠到边缘像素上，index[i] .. index[i] + taps - 1 一定落在源图范围内。
+ */
+struct ResampleAxis {
+    int src_len = 0;
+    int dst_len = 0;
+    int taps = 0;
+    std::vector<int> index;
+    std::vector<int16_t> weight;
+};
+
+static const int RESAMPLE_WEIGHT_BITS = 14;  // 权重的小数位数
+static const int RESAMPLE_INTER_BITS = 6;    // 水平方向中间结果保留的小数位数
+
+/**
+ * @brief 滤波器半径
+ */
+inline double resample_support(ResampleFilter filter) {
+    switch (filter) {
+        case RESAMPLE_BILINEAR:
+            return 1.0;
+        case RESAMPLE_BICUBIC:
+            return 2.0;
+        case RESAMPLE_AREA:
+            return 0.5;
+        default:
+            return 3.0;
+    }
+}
+
+/**
+ * @brief 滤波器核函数
+ */
+inline double resample_kernel(ResampleFilter filter, double t) {
+    t = std::fabs(t);
+    switch (filter) {
+        case RESAMPLE_BILINEAR:
+            return t < 1 ? 1 - t : 0;
+        case RESAMPLE_BICUBIC: {
+            const double a = -1;
+            if (t <= 1) {
+                return (a + 2) * t * t * t - (a + 3) * t * t + 1;
+            } else if (t <= 2) {
+                return a * t * t * t - 5 * a * t * t + 8 * a * t - 4 * a;
+            }
+            return 0;
+        }
+        case RESAMPLE_AREA:
+            return t < 0.5 ? 1 : (t == 0.5 ? 0.5 : 0);
+        default: {
+            if (t >= 3) {
+                return 0;
+            }
+            if (t < 1e-8) {
+                return 1;
+            }
+            double px = M_PI * t;
+            return 3 * std::sin(px) * std::sin(px / 3) / (px * px);
+        }
+    }
+}
+
+/**
+ * @brief 预计算一个方向的采样表
+ *
+ * 采用像素中心对齐。缩小且 antialias 为 true 时按缩放比拉宽滤波器，
+ * 每个目标像素覆盖它在源图上对应的整个区域，避免混叠。
+ *
+ * @param src_len 源长度
+ * @param dst_len 目标长度
+ * @param filter 滤波器
+ * @param antialias 缩小时是否抗混叠
+ *
+ * @return 采样表
+ */
+inline ResampleAxis make_resample_axis(int src_len, int dst_len, ResampleFilter filter, bool antialias) {
+    ResampleAxis axis;
+    axis.src_len = src_len;
+    axis.dst_len = dst_len;
+
+    double scale = (double)dst_len / src_len;
+    double fscale = (antialias && scale < 1) ? 1 / scale : 1;
+    double support = resample_support(filter) * fscale;
+    axis.taps = std::min((int)std::ceil(2 * support) + 1, src_len);
+    axis.index.resize(dst_len);
+    axis.weight.assign((size_t)dst_len * axis.taps, 0);
+
+    int T = (int)std::ceil(2 * support) + 1;
+    std::vector<double> w(axis.taps);
+    for (int i = 0; i < dst_len; ++i) {
+        double center = (i + 0.5) / scale;
+        int xmin = (int)std::floor(center - support);
+        int start = std::min(std::max(xmin, 0), src_len - axis.taps);
+        axis.index[i] = start;
+
+        // 计算权重，越界的 tap 折叠到边缘像素
+        std::fill(w.begin(), w.end(), 0.0);
+        double sum = 0;
+        for (int k = 0; k < T; ++k) {
+            int x = xmin + k;
+            double v = resample_kernel(filter, (x + 0.5 - center) / fscale);
+            w[std::min(std::max(x, 0), src_len - 1) - start] += v;
+            sum += v;
+        }
+
+        // 转换为 Q14，舍入误差补到最大的权重上
+        int16_t* wi = &axis.weight[(size_t)i * axis.taps];
+        int total = 0, largest = 0;
+        for (int k = 0; k < axis.taps; ++k) {
+            wi[k] = (int16_t)std::lround(w[k] / sum * (1 << RESAMPLE_WEIGHT_BITS));
+            total += wi[k];
+            if (std::abs(wi[k]) > std::abs(wi[largest])) {
+                largest = k;
+            }
+        }
+        wi[largest] += (int16_t)((1 << RESAMPLE_WEIGHT_BITS) - total);
+    }
+
+    return axis;
+}
+
+/**
+ * @brief 可分离的重采样器
+ *
+ * 构造时为水平、垂直两个方向各预计算一次采样表，之后对同样尺寸的每一帧重复使用。
+ * 先做水平方向，结果以 Q6 的 int16 存放在一个只保留 taps 行的环形缓冲区中，
+ * 再做垂直方向。两个方向都用 SSE2 的 pmaddwd 做 16 bit 定点乘加：水平方向单通道一次处理 8 个 tap，
+ * 多通道一次处理一个像素的全部通道、两个 tap；垂直方向一次处理 8 个像素、两个 tap。
+ * 输出按行分块并行计算。支持 1~4 通道的 8 bit 图像。
+ */
+class Resampler {
+   public:
+    /**
+     * @brief 构造函数
+     *
+     * @param src 源尺寸
+     * @param dst 目标尺寸
+     * @param channels 通道数
+     * @param filter 滤波器
+     * @param antialias 缩小时是否抗混叠，默认为 true
+     */
+    Resampler(cv::Size src, cv::Size dst, int channels, ResampleFilter filter, bool antialias = true)
+        : channels_(channels),
+          xaxis_(make_resample_axis(src.width, dst.width, filter, antialias)),
+          yaxis_(make_resample_axis(src.height, dst.height, filter, antialias)) {}
+
+    cv::Size src_size() const { return cv::Size(xaxis_.src_len, yaxis_.src_len); }
+    cv::Size dst_size() const { return cv::Size(xaxis_.dst_len, yaxis_.dst_len); }
+
+    /**
+     * @brief 重采样
+     *
+     * @param src 源数据
+     * @param sstride 源每行字节数
+     * @param dst 目标数据
+     * @param dstride 目标每行字节数
+     */
+    void apply(const uint8_t* src, size_t sstride, uint8_t* dst, size_t dstride) const {
+        apply(src, sstride, cv::Point(0, 0), dst, dstride, cv::Rect(0, 0, xaxis_.dst_len, yaxis_.dst_len));
+    }
+
+    /**
+     * @brief 计算目标矩形 roi 需要读取的源矩形
+     */
+    cv::Rect src_rect(const cv::Rect& roi) const {
+        int x0 = xaxis_.index[roi.x], x1 = xaxis_.index[roi.x + roi.width - 1] + xaxis_.taps;
+        int y0 = yaxis_.index[roi.y], y1 = yaxis_.index[roi.y + roi.height - 1] + yaxis_.taps;
+        return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+    }
+
+    /**
+     * @brief 只计算目标图像中的矩形 roi（分块处理大图时使用），结果与整幅计算的对应部分相同
+     *
+     * @param src 源数据，第一个元素是源图像中 origin 处的像素，必须覆盖 src_rect(roi)
+     * @param sstride 源每行字节数
+     * @param origin src 在源图像中的位置
+     * @param dst 目标数据，第一个元素对应 roi 的左上角
+     * @param dstride 目标每行字节数
+     * @param roi 目标矩形
+     */
+    void apply(const uint8_t* src, size_t sstride, cv::Point origin, uint8_t* dst, size_t dstride,
+               const cv::Rect& roi) const {
+        // 目标行带对应的源行由 yaxis_.index 决定，不使用 halo
+        parallel_for_rows(roi.height, 0, [&](const ParallelRange& band) {
+            // 环形缓冲区，第 r 行源图的水平结果放在 r % taps 行
+            int row_len = roi.width * channels_;
+            int cap = yaxis_.taps;
+            std::vector<int16_t> ring((size_t)cap * row_len);
+            std::vector<int> cached(cap, -1);
+            std::vector<const int16_t*> rows(cap);
+
+            for (int y = band.begin; y < band.end; ++y) {
+                int first = yaxis_.index[roi.y + y];
+                for (int t = 0; t < cap; ++t) {
+                    int r = first + t;
+                    int16_t* slot = &ring[(size_t)(r % cap) * row_len];
+                    if (cached[r % cap] != r) {
+                        horizontal(src + (size_t)(r - origin.y) * sstride, origin.x, roi.x, roi.width, slot);
+                        cached[r % cap] = r;
+                    }
+                    rows[t] = slot;
+                }
+                vertical(rows.data(), &yaxis_.weight[(size_t)(roi.y + y) * cap], cap, row_len,
+                         dst + (size_t)y * dstride);
+            }
+        });
+    }
+
+    /**
+     * @brief 重采样（cv::Mat 版本）
+     *
+     * @param src CV_8U 图像，尺寸和通道数必须与构造时一致
+     *
+     * @return 重采样后的图像
+     */
+    cv::Mat apply(const cv::Mat& src) const {
+        CV_Assert(src.depth() == CV_8U && src.channels() == channels_ && src.size() == src_size());
+        cv::Mat out(yaxis_.dst_len, xaxis_.dst_len, src.type());
+        apply(src.data, src.step, out.data, out.step);
+        return out;
+    }
+
+   private:
+    int channels_;
+    ResampleAxis xaxis_, yaxis_;
+
+    // 水平方向：一行 8 bit 源像素（从第 origin 列开始）-> 目标 [x0, x0 + width) 列的 Q6 int16
+    void horizontal(const uint8_t* src, int origin, int x0, int width, int16_t* out) const {
+        const int taps = xaxis_.taps;
+        const int cn = channels_;
+        const int shift = RESAMPLE_WEIGHT_BITS - RESAMPLE_INTER_BITS;
+        const int round = 1 << (shift - 1);
+
+#if defined(__SSE2__)
+        switch (cn) {
+            case 1: horizontal_gray(src, origin, x0, width, round, shift, out); return;
+            case 2: horizontal_color<2>(src, origin, x0, width, round, shift, out); return;
+            case 3: horizontal_color<3>(src, origin, x0, width, round, shift, out); return;
+            case 4: horizontal_color<4>(src, origin, x0, width, round, shift, out); return;
+        }
+#endif
+        for (int i = 0; i < width; ++i) {
+            int x = x0 + i;
+            const uint8_t* s = src + (size_t)(xaxis_.index[x] - origin) * cn;
+            const int16_t* w = &xaxis_.weight[(size_t)x * taps];
+            for (int c = 0; c < cn; ++c) {
+                int acc = round;
+                for (int t = 0; t < taps; ++t) {
+                    acc += (int)s[t * cn + c] * w[t];
+                }
+                out[i * cn + c] = (int16_t)(acc >> shift);
+            }
+        }
+    }
+
+#if defined(__SSE2__)
+    // 单通道：沿 tap 方向一次取 8 个像素，与 8 个权重做 pmaddwd，最后横向求和
+    void horizontal_gray(const uint8_t* src, int origin, int x0, int width, int round, int shift,
+                         int16_t* out) const {
+        const int taps = xaxis_.taps;
+        const __m128i zero = _mm_setzero_si128();
+        for (int i = 0; i < width; ++i) {
+            int x = x0 + i;
+            const uint8_t* s = src + (xaxis_.index[x] - origin);
+            const int16_t* w = &xaxis_.weight[(size_t)x * taps];
+            __m128i acc = zero;
+            int t = 0;
+            for (; t + 8 <= taps; t += 8) {
+                __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s + t)), zero);
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(v, _mm_loadu_si128((const __m128i*)(w + t))));
+            }
+            acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+            acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+            int sum = round + _mm_cvtsi128_si32(acc);
+            for (; t < taps; ++t) {
+                sum += (int)s[t] * w[t];
+            }
+            out[i] = (int16_t)(sum >> shift);
+        }
+    }
+
+    // 一个像素的 CN 个通道零扩展为 16 bit，不读取像素之外的字节
+    template <int CN>
+    static __m128i load_pixel(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int c = 0; c < CN; ++c) {
+            v |= (uint32_t)p[c] << (8 * c);
+        }
+        return _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)v), _mm_setzero_si128());
+    }
+
+    // (w[0], w[1]) 广播到每个 32 位通道，低 16 位为 w[0]
+    static __m128i weight_pair(const int16_t* w) {
+        return _mm_set1_epi32((int)(((uint32_t)(uint16_t)w[1] << 16) | (uint16_t)w[0]));
+    }
+
+    // 多通道：每个通道占一个 32 位累加器，两个 tap 一组交错后与 (w0, w1) 做 pmaddwd
+    template <int CN>
+    void horizontal_color(const uint8_t* src, int origin, int x0, int width, int round, int shift,
+                          int16_t* out) const {
+        const int taps = xaxis_.taps;
+        const __m128i vround = _mm_set1_epi32(round);
+        const __m128i zero = _mm_setzero_si128();
+        for (int i = 0; i < width; ++i) {
+            int x = x0 + i;
+            const uint8_t* s = src + (size_t)(xaxis_.index[x] - origin) * CN;
+            const int16_t* w = &xaxis_.weight[(size_t)x * taps];
+            __m128i acc = vround;
+            int t = 0;
+            // 一次读 8 字节，包含 tap t、t + 1 两个像素；只在不越过 s[taps * CN] 时使用
+            for (; t * CN + 8 <= taps * CN && t + 2 <= taps; t += 2) {
+                __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s + t * CN)), zero);
+                __m128i p = _mm_unpacklo_epi16(a, _mm_srli_si128(a, 2 * CN));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(p, weight_pair(w + t)));
+            }
+            for (; t + 2 <= taps; t += 2) {
+                __m128i p = _mm_unpacklo_epi16(load_pixel<CN>(s + t * CN), load_pixel<CN>(s + (t + 1) * CN));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(p, weight_pair(w + t)));
+            }
+            if (t < taps) {
+                __m128i p = _mm_unpacklo_epi16(load_pixel<CN>(s + t * CN), zero);
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32((uint16_t)w[t])));
+            }
+            acc = _mm_srai_epi32(acc, shift);
+            __m128i v = _mm_packs_epi32(acc, acc);
+            if (CN == 4) {
+                _mm_storel_epi64((__m128i*)(out + i * CN), v);
+            } else {
+                int16_t tmp[8];
+                _mm_storeu_si128((__m128i*)tmp, v);
+                for (int c = 0; c < CN; ++c) {
+                    out[i * CN + c] = tmp[c];
+                }
+            }
+        }
+    }
+#endif
+
+    // 垂直方向：taps 行 Q6 int16 -> 8 bit
+    static void vertical(const int16_t* const* rows, const int16_t* w, int taps, int len, uint8_t* out) {
+        const int shift = RESAMPLE_WEIGHT_BITS + RESAMPLE_INTER_BITS;
+        const int round = 1 << (shift - 1);
+        int x = 0;
+
+#if defined(__SSE2__)
+        const __m128i vround = _mm_set1_epi32(round);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 8 <= len; x += 8) {
+            __m128i acc_lo = vround, acc_hi = vround;
+            int t = 0;
+            // 两个 tap 一组：交错两行后与 (w0, w1) 做 pmaddwd
+            for (; t + 2 <= taps; t += 2) {
+                __m128i r0 = _mm_loadu_si128((const __m128i*)(rows[t] + x));
+                __m128i r1 = _mm_loadu_si128((const __m128i*)(rows[t + 1] + x));
+                __m128i wp = _mm_set1_epi32((int)(((uint32_t)(uint16_t)w[t + 1] << 16) | (uint16_t)w[t]));
+                acc_lo = _mm_add_epi32(acc_lo, _mm_madd_epi16(_mm_unpacklo_epi16(r0, r1), wp));
+                acc_hi = _mm_add_epi32(acc_hi, _mm_madd_epi16(_mm_unpackhi_epi16(r0, r1), wp));
+            }
+            if (t < taps) {
+                __m128i r0 = _mm_loadu_si128((const __m128i*)(rows[t] + x));
+                __m128i wp = _mm_set1_epi32((uint16_t)w[t]);
+                acc_lo = _mm_add_epi32(acc_lo, _mm_madd_epi16(_mm_unpacklo_epi16(r0, zero), wp));
+                acc_hi = _mm_add_epi32(acc_hi, _mm_madd_epi16(_mm_unpackhi_epi16(r0, zero), wp));
+            }
+            __m128i v = _mm_packs_epi32(_mm_srai_epi32(acc_lo, shift), _mm_srai_epi32(acc_hi, shift));
+            _mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(v, v));
+        }
+#endif
+
+        for (; x < len; ++x) {
+            int acc = round;
+            for (int t = 0; t < taps; ++t) {
+                acc += (int)rows[t][x] * w[t];
+            }
+            out[x] = (uint8_t)std::min(std::max(acc >> shift, 0), 255);
+        }
+    }
+};
+
+/**
+ * @brief 重采样（一次性调用）
+ *
+ * 对同一尺寸反复缩放时应直接复用 Resampler，避免重复计算采样表。
+ *
+ * @param img CV_8U 图像，1~4 通道
+ * @param size 目标尺寸
+ * @param filter 滤波器
+ * @param antialias 缩小时是否抗混叠，默认为 true
+ *
+ * @return 重采样后的图像
+ */
+inline cv::Mat resample(const cv::Mat& img, cv::Size size, ResampleFilter filter, bool antialias = true) {
+    return Resampler(img.size(), size, img.channels(), filter, antialias).apply(img);
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "box.hpp"
+#include "hog.hpp"
+#include "resize.hpp"
+
+/**
+ * @brief SplitMix64 伪随机数生成器
+ *
+ * 状态只有 64 bit，每个线程持有一个，生成随机数不加锁、不分配内存。
+ */
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [lo, hi) 内的均匀整数，用乘法代替取模
+    int uniform(int lo, int hi) { return lo + (int)(((next() >> 32) * (uint64_t)(hi - lo)) >> 32); }
+
+    // [0, 1) 内的均匀浮点数
+    double uniform01() { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+/**
+ * @brief 预分配的样本环形缓冲区
+ *
+ * 共 slots 个槽，每个槽存放一个 batch 的特征 (batch_size × feature_dim) 和标签 (batch_size)。
+ * 生产者取空槽、写满后发布；消费者取已发布的槽、用完后归还。
+ * 所有内存在构造时一次性分配，运行过程中不再分配。
+ */
+class SampleRing {
+   public:
+    SampleRing(int slots, int batch_size, int feature_dim)
+        : slots_(slots),
+          batch_size_(batch_size),
+          feature_dim_(feature_dim),
+          features_((size_t)slots * batch_size * feature_dim),
+          labels_((size_t)slots * batch_size),
+          free_(slots),
+          ready_(slots) {
+        for (int i = 0; i < slots; ++i) {
+            free_.push(i);
+        }
+    }
+
+    int batch_size() const { return batch_size_; }
+    int feature_dim() const { return feature_dim_; }
+    double* features(int slot) { return &features_[(size_t)slot * batch_size_ * feature_dim_]; }
+    double* labels(int slot) { return &labels_[(size_t)slot * batch_size_]; }
+
+    /**
+     * @brief 生产者获取一个空槽，没有空槽时阻塞
+     *
+     * @return 槽编号，缓冲区关闭后返回 -1
+     */
+    int acquire_free() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_free_.wait(lock, [&] { return closed_ || free_.size() > 0; });
+        return closed_ ? -1 : free_.pop();
+    }
+
+    /**
+     * @brief 生产者发布写满的槽
+     */
+    void publish(int slot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push(slot);
+        }
+        cv_ready_.notify_one();
+    }
+
+    /**
+     * @brief 消费者获取一个写满的槽，没有时阻塞
+     *
+     * @return 槽编号，缓冲区关闭且没有剩余数据时返回 -1
+     */
+    int acquire_ready() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_ready_.wait(lock, [&] { return closed_ || ready_.size() > 0; });
+        return ready_.size() > 0 ? ready_.pop() : -1;
+    }
+
+    /**
+     * @brief 消费者归还用完的槽
+     */
+    void release(int slot) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push(slot);
+        }
+        cv_free_.notify_one();
+    }
+
+    /**
+     * @brief 关闭缓冲区，唤醒所有等待的线程
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_free_.notify_all();
+        cv_ready_.notify_all();
+    }
+
+   private:
+    // 定长的槽编号队列
+    struct IndexQueue {
+        std::vector<int> buf;
+        int head = 0;
+        int count = 0;
+
+        explicit IndexQueue(int capacity) : buf(capacity) {}
+        int size() const { return count; }
+        void push(int v) { buf[(head + count++) % buf.size()] = v; }
+        int pop() {
+            int v = buf[head];
+            head = (head + 1) % buf.size();
+            --count;
+            return v;
+        }
+    };
+
+    int slots_, batch_size_, feature_dim_;
+    std::vector<double> features_;
+    std::vector<double> labels_;
+    IndexQueue free_, ready_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_free_, cv_ready_;
+};
+
+/**
+ * @brief 带标注的挖掘源图像
+ */
+struct MiningImage {
+    cv::Mat gray;  // CV_8UC1
+    Box gt;        // ground truth 边界框
+};
+
+/**
+ * @brief 样本挖掘参数
+ */
+struct MinerConfig {
+    int crop_size = 60;            // 裁剪框的基准边长，与 crop_bbox 的 L 相同
+    int canonical_size = 32;       // 裁剪后缩放到的边长
+    double iou_th = 0.5;           // IoU 不小于该值的样本为正样本
+    double positive_ratio = 0.5;   // 期望的正样本比例
+    double jitter = 0.25;          // 正样本相对 gt 中心的最大平移比例，以及裁剪框边长的缩放范围
+    int max_tries = 16;            // 为满足期望标签最多重新采样的次数
+    int threads = 0;               // 工作线程数，0 表示使用全部核心
+    uint64_t seed = 0x5EED;        // 随机种子，每个线程在此基础上派生
+};
+
+/**
+ * @brief 多线程样本挖掘流水线
+ *
+ * 每个工作线程持有自己的随机数生成器、缩放的采样表和 HOG 缓冲区，循环执行：
+ * 从环形缓冲区取空槽 → 逐个生成裁剪框并按 IoU 打标签 → 随机水平翻转 → 缩放到 canonical_size
+ * → 提取 HOG 特征写入槽 → 发布。正样本在 gt 附近抖动采样，负样本在全图均匀采样，
+ * 使 batch 中的正负比例接近 positive_ratio，不依赖于随机裁剪碰巧命中 gt。
+ */
+class SampleMiner {
+   public:
+    SampleMiner(const std::vector<MiningImage>& images, SampleRing& ring, const MinerConfig& config)
+        : images_(images), ring_(ring), config_(config) {
+        CV_Assert(ring.feature_dim() == feature_dim(config));
+    }
+
+    ~SampleMiner() { stop(); }
+
+    /**
+     * @brief 每个样本的特征维度
+     */
+    static int feature_dim(const MinerConfig& config) {
+        int n = config.canonical_size / HOG_CELL;
+        return n * n * HOG_BINS;
+    }
+
+    /**
+     * @brief 启动工作线程
+     */
+    void start() {
+        int n = config_.threads > 0 ? config_.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < n; ++i) {
+            workers_.emplace_back(&SampleMiner::worker, this, i);
+        }
+    }
+
+    /**
+     * @brief 关闭环形缓冲区并等待工作线程退出
+     */
+    void stop() {
+        ring_.close();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+        workers_.clear();
+    }
+
+    /**
+     * @brief 已生成的样本数
+     */
+    uint64_t produced() const { return produced_.load(); }
+
+   private:
+    const std::vector<MiningImage>& images_;
+    SampleRing& ring_;
+    MinerConfig config_;
+    std::vector<std::thread> workers_;
+    std::atomic<uint64_t> produced_{0};
+
+    void worker(int id) {
+        SplitMix64 rng(config_.seed + 0x9E3779B97F4A7C15ull * (uint64_t)(id + 1));
+        int cs = config_.canonical_size;
+        int n = cs / HOG_CELL;
+        int dim = feature_dim(config_);
+        std::vector<uint8_t> crop((size_t)cs * cs);
+        std::vector<std::unique_ptr<Resampler>> resamplers;  // 按裁剪框边长缓存的采样表
+        HogCells cells;
+
+        while (true) {
+            int slot = ring_.acquire_free();
+            if (slot < 0) {
+                break;
+            }
+
+            double* feat = ring_.features(slot);
+            double* label = ring_.labels(slot);
+            for (int i = 0; i < ring_.batch_size(); ++i) {
+                label[i] = sample(rng, resamplers, crop.data());
+                hog_cells(crop.data(), cs, cs, cs, cells);
+                hog_window(cells, 0, 0, n, n, feat + (size_t)i * dim);
+            }
+
+            ring_.publish(slot);
+            produced_ += ring_.batch_size();
+        }
+    }
+
+    // 生成一个裁剪框并缩放到 crop，返回标签；resamplers[L] 为边长 L 的裁剪框缩放到 canonical_size 的采样表
+    double sample(SplitMix64& rng, std::vector<std::unique_ptr<Resampler>>& resamplers, uint8_t* crop) {
+        const MiningImage& img = images_[rng.uniform(0, (int)images_.size())];
+        int H = img.gray.rows;
+        int W = img.gray.cols;
+        bool want_positive = rng.uniform01() < config_.positive_ratio;
+
+        int x1 = 0, y1 = 0, L = 0;
+        double iou = 0;
+        for (int t = 0; t < config_.max_tries; ++t) {
+            // 裁剪框边长在 crop_size 附近随机缩放
+            double s = 1.0 + config_.jitter * (2 * rng.uniform01() - 1);
+            L = std::min(std::max((int)(config_.crop_size * s), HOG_CELL), std::min(W, H));
+
+            if (want_positive) {
+                // 在 gt 中心附近抖动
+                double cx = (img.gt.x1 + img.gt.x2) / 2 + config_.jitter * L * (2 * rng.uniform01() - 1);
+                double cy = (img.gt.y1 + img.gt.y2) / 2 + config_.jitter * L * (2 * rng.uniform01() - 1);
+                x1 = std::min(std::max((int)(cx - L / 2), 0), W - L);
+                y1 = std::min(std::max((int)(cy - L / 2), 0), H - L);
+            } else {
+                x1 = rng.uniform(0, W - L + 1);
+                y1 = rng.uniform(0, H - L + 1);
+            }
+
+            iou = iou_box(img.gt, {(double)x1, (double)y1, (double)(x1 + L), (double)(y1 + L)});
+            if ((iou >= config_.iou_th) == want_positive) {
+                break;
+            }
+        }
+
+        int cs = config_.canonical_size;
+        if ((int)resamplers.size() <= L) {
+            resamplers.resize(L + 1);
+        }
+        if (!resamplers[L]) {
+            resamplers[L].reset(new Resampler(cv::Size(L, L), cv::Size(cs, cs), 1, RESAMPLE_BILINEAR));
+        }
+        resamplers[L]->apply(img.gray.ptr<uint8_t>(y1) + x1, img.gray.step, crop, cs);
+
+        // 随机水平翻转
+        if (rng.next() & 1) {
+            for (int y = 0; y < cs; ++y) {
+                std::reverse(crop + (size_t)y * cs, crop + (size_t)(y + 1) * cs);
+            }
+        }
+
+        return iou >= config_.iou_th ? 1.0 : 0.0;
+    }
+};
@@ -0,0 +1,702 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+/*
+ * 视频流格式
+ *
+ * Y4M（YUV4MPEG2）：一行文本头 "YUV4MPEG2 W<宽> H<高> F<分子>:<分母> C<色彩空间> ..."，
+ * 之后每帧为一行 "FRAME ..." 加上 Y、U、V 三个平面。支持 C420jpeg / 420paldv / 420mpeg2 / 420、C444、Cmono，
+ * 彩色按 BT.601 有限范围（Y ∈ [16, 235]）与 BGR 互转，mono 的 Y 直接作为灰度。
+ *
+ * PNM 序列：若干个 P6（RGB，读入后为 BGR）或 P5（灰度）图像首尾相接，maxval 必须为 255，
+ * 与 ffmpeg -f image2pipe -c:v ppm 的输出相同。
+ *
+ * 路径为 "-" 时读标准输入、写标准输出，可以放在管道中间使用。
+ */
+
+/**
+ * @brief 视频流文件格式
+ */
+enum StreamFormat {
+    STREAM_AUTO,  // 读取时按文件头判断，写出时按扩展名（.y4m 为 Y4M，其余为 PNM）
+    STREAM_Y4M,
+    STREAM_PNM,
+};
+
+inline uint8_t stream_clip(int v) { return (uint8_t)std::min(std::max(v, 0), 255); }
+
+/**
+ * @brief 一行 YUV 转 BGR（BT.601 有限范围，定点数）
+ *
+ * @param y 亮度，width 个
+ * @param u, v 色度，每 1 << shift 个像素共用一个
+ * @param width 像素数
+ * @param shift 色度的水平下采样（420 为 1，444 为 0）
+ * @param bgr 输出，width × 3
+ */
+inline void yuv_to_bgr_row(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int shift,
+                           uint8_t* bgr) {
+    for (int x = 0; x < width; ++x, bgr += 3) {
+        int c = 298 * (y[x] - 16) + 128, d = u[x >> shift] - 128, e = v[x >> shift] - 128;
+        bgr[0] = stream_clip((c + 516 * d) >> 8);
+        bgr[1] = stream_clip((c - 100 * d - 208 * e) >> 8);
+        bgr[2] = stream_clip((c + 409 * e) >> 8);
+    }
+}
+
+/**
+ * @brief BGR 图像转 YUV 平面（BT.601 有限范围），色度取 (1 << shift) × (1 << shift) 块内的平均值
+ *
+ * @param bgr CV_8UC3 图像
+ * @param shift 色度的下采样（420 为 1，444 为 0）
+ * @param planes 输出，依次为 Y、U、V 平面，U、V 的尺寸为宽、高除以 1 << shift 向上取整
+ */
+inline void bgr_to_yuv(const cv::Mat& bgr, int shift, uint8_t* planes) {
+    int w = bgr.cols, h = bgr.rows, cw = (w + (1 << shift) - 1) >> shift, ch = (h + (1 << shift) - 1) >> shift;
+    uint8_t *py = planes, *pu = planes + (size_t)w * h, *pv = pu + (size_t)cw * ch;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* p = bgr.ptr<uint8_t>(y);
+        for (int x = 0; x < w; ++x, p += 3) {
+            py[(size_t)y * w + x] = (uint8_t)(((66 * p[2] + 129 * p[1] + 25 * p[0] + 128) >> 8) + 16);
+        }
+    }
+    for (int cy = 0; cy < ch; ++cy) {
+        for (int cx = 0; cx < cw; ++cx) {
+            int b = 0, g = 0, r = 0, n = 0;
+            for (int y = cy << shift; y < std::min((cy + 1) << shift, h); ++y) {
+                const uint8_t* p = bgr.ptr<uint8_t>(y);
+                for (int x = cx << shift; x < std::min((cx + 1) << shift, w); ++x, ++n) {
+                    b += p[x * 3];
+                    g += p[x * 3 + 1];
+                    r += p[x * 3 + 2];
+                }
+            }
+            b = (b + n / 2) / n;
+            g = (g + n / 2) / n;
+            r = (r + n / 2) / n;
+            pu[(size_t)cy * cw + cx] = stream_clip(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            pv[(size_t)cy * cw + cx] = stream_clip(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+/**
+ * @brief 视频流读取（Y4M 或 PNM 序列）
+ */
+class FrameReader {
+   public:
+    FrameReader() {}
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+    ~FrameReader() { close(); }
+
+    /**
+     * @brief 打开文件（"-" 为标准输入）并读取流头
+     *
+     * @return 成功返回 true，文件不存在或格式不支持时返回 false
+     */
+    bool open(const std::string& path) {
+        close();
+        FILE* f = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+        if (!f) {
+            std::cerr << "无法打开视频流: " << path << std::endl;
+            return false;
+        }
+        owned_ = f != stdin;
+        return start(f);
+    }
+
+    /**
+     * @brief 从已打开的文件（例如 popen 的管道）读取，不负责关闭
+     */
+    bool open(FILE* f) {
+        close();
+        return start(f);
+    }
+
+    void close() {
+        if (f_ && owned_) {
+            std::fclose(f_);
+        }
+        f_ = nullptr;
+        owned_ = false;
+    }
+
+    /**
+     * @brief 读取下一帧
+     *
+     * @param frame 输出，CV_8UC3（BGR）或 CV_8UC1，尺寸、类型不变时复用 frame 的缓冲区
+     *
+     * @return 读到一帧返回 true，流结束或格式错误时返回 false
+     */
+    bool read(cv::Mat& frame) {
+        if (!f_) {
+            return false;
+        }
+        return format_ == STREAM_Y4M ? read_y4m(frame) : read_pnm(frame);
+    }
+
+    StreamFormat format() const { return format_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int type() const { return type_; }
+    double fps() const { return fps_; }
+
+   private:
+    FILE* f_ = nullptr;
+    bool owned_ = false;
+    StreamFormat format_ = STREAM_AUTO;
+    int width_ = 0, height_ = 0, type_ = CV_8UC3, shift_ = 1;
+    double fps_ = 25;
+    bool first_ = true;  // PNM 第一帧的文件头已经读取
+    std::vector<uint8_t> buf_;
+
+    bool fail(const char* message) {
+        std::cerr << message << std::endl;
+        close();
+        return false;
+    }
+
+    bool start(FILE* f) {
+        f_ = f;
+        char magic[2];
+        if (std::fread(magic, 1, 2, f_) != 2) {
+            return fail("视频流为空");
+        }
+        if (magic[0] == 'Y' && magic[1] == 'U') {
+            format_ = STREAM_Y4M;
+            return read_y4m_header();
+        }
+        if (magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6')) {
+            format_ = STREAM_PNM;
+            first_ = true;
+            return read_pnm_header(magic[1]);
+        }
+        return fail("不支持的视频流格式（需要 Y4M 或 PNM 序列）");
+    }
+
+    // 读到换行为止（不含换行），最多 1023 个字符
+    bool read_line(std::string& line) {
+        line.clear();
+        int c;
+        while ((c = std::fgetc(f_)) != EOF && c != '\n') {
+            if (line.size() >= 1023) {
+                return false;
+            }
+            line += (char)c;
+        }
+        return c == '\n';
+    }
+
+    bool read_y4m_header() {
+        std::string line;
+        if (!read_line(line) || line.compare(0, 8, "V4MPEG2 ") != 0) {
+            return fail("Y4M 文件头错误");
+        }
+        std::string colorspace = "420jpeg";
+        for (size_t i = 8; i < line.size();) {
+            size_t end = line.find(' ', i);
+            end = end == std::string::npos ? line.size() : end;
+            std::string token = line.substr(i, end - i);
+            i = end + 1;
+            if (token.empty()) {
+                continue;
+            }
+            const char* v = token.c_str() + 1;
+            switch (token[0]) {
+                case 'W':
+                    width_ = std::atoi(v);
+                    break;
+                case 'H':
+                    height_ = std::atoi(v);
+                    break;
+                case 'F': {
+                    int num = 0, den = 0;
+                    if (std::sscanf(v, "%d:%d", &num, &den) == 2 && num > 0 && den > 0) {
+                        fps_ = (double)num / den;
+                    }
+                    break;
+                }
+                case 'C':
+                    colorspace = v;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (width_ <= 0 || height_ <= 0) {
+            return fail("Y4M 文件头缺少宽高");
+        }
+        if (colorspace == "420jpeg" || colorspace == "420paldv" || colorspace == "420mpeg2" || colorspace == "420") {
+            type_ = CV_8UC3;
+            shift_ = 1;
+        } else if (colorspace == "444") {
+            type_ = CV_8UC3;
+            shift_ = 0;
+        } else if (colorspace == "mono") {
+            type_ = CV_8UC1;
+        } else {
+            return fail("不支持的 Y4M 色彩空间（需要 420、444 或 mono 的 8 bit 格式）");
+        }
+        return true;
+    }
+
+    bool read_y4m(cv::Mat& frame) {
+        std::string line;
+        if (!read_line(line)) {
+            return false;  // 流结束
+        }
+        if (line.compare(0, 5, "FRAME") != 0) {
+            return fail("Y4M 帧头错误");
+        }
+        frame.create(height_, width_, type_);
+        if (type_ == CV_8UC1) {
+            for (int y = 0; y < height_; ++y) {
+                if (std::fread(frame.ptr<uint8_t>(y), 1, width_, f_) != (size_t)width_) {
+                    return fail("Y4M 帧数据不完整");
+                }
+            }
+            return true;
+        }
+        int cw = (width_ + (1 << shift_) - 1) >> shift_, ch = (height_ + (1 << shift_) - 1) >> shift_;
+        size_t luma = (size_t)width_ * height_, chroma = (size_t)cw * ch;
+        buf_.resize(luma + 2 * chroma);
+        if (std::fread(buf_.data(), 1, buf_.size(), f_) != buf_.size()) {
+            return fail("Y4M 帧数据不完整");
+        }
+        const uint8_t *py = buf_.data(), *pu = py + luma, *pv = pu + chroma;
+        for (int y = 0; y < height_; ++y) {
+            size_t c = (size_t)(y >> shift_) * cw;
+            yuv_to_bgr_row(py + (size_t)y * width_, pu + c, pv + c, width_, shift_, frame.ptr<uint8_t>(y));
+        }
+        return true;
+    }
+
+    // PNM 头部的一个十进制数，跳过空白和注释
+    bool read_pnm_number(int& v) {
+        int c = std::fgetc(f_);
+        while (c == '#' || std::isspace(c)) {
+            if (c == '#') {
+                while (c != EOF && c != '\n') {
+                    c = std::fgetc(f_);
+                }
+            }
+            c = std::fgetc(f_);
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = 0;
+        while (c >= '0' && c <= '9') {
+            v = v * 10 + (c - '0');
+            c = std::fgetc(f_);
+        }
+        return std::isspace(c) != 0;  // 数据前恰好一个空白字符
+    }
+
+    bool read_pnm_header(char kind) {
+        int maxval = 0;
+        if (!read_pnm_number(width_) || !read_pnm_number(height_) || !read_pnm_number(maxval) || width_ <= 0 ||
+            height_ <= 0) {
+            return fail("PNM 文件头错误");
+        }
+        if (maxval != 255) {
+            return fail("不支持的 PNM 格式（maxval 必须为 255）");
+        }
+        type_ = kind == '6' ? CV_8UC3 : CV_8UC1;
+        return true;
+    }
+
+    bool read_pnm(cv::Mat& frame) {
+        if (!first_) {
+            char magic[2];
+            if (std::fread(magic, 1, 2, f_) != 2) {
+                return false;  // 流结束
+            }
+            if (magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6') || !read_pnm_header(magic[1])) {
+                return fail("PNM 序列中的帧头错误");
+            }
+        }
+        first_ = false;
+        frame.create(height_, width_, type_);
+        size_t row = (size_t)width_ * frame.channels();
+        for (int y = 0; y < height_; ++y) {
+            uint8_t* p = frame.ptr<uint8_t>(y);
+            if (std::fread(p, 1, row, f_) != row) {
+                return fail("PNM 帧数据不完整");
+            }
+            if (type_ == CV_8UC3) {
+                for (size_t i = 0; i < row; i += 3) {
+                    std::swap(p[i], p[i + 2]);  // RGB → BGR
+                }
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 视频流写出（Y4M 或 PNM 序列）
+ *
+ * Y4M 的彩色帧写成 C420jpeg，灰度帧写成 Cmono，宽高、通道数由第一帧决定，之后不能改变。
+ */
+class FrameWriter {
+   public:
+    FrameWriter() {}
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+    ~FrameWriter() { close(); }
+
+    /**
+     * @brief 创建文件（"-" 为标准输出）
+     *
+     * @param path 路径
+     * @param format 格式，STREAM_AUTO 按扩展名判断（标准输出为 PNM）
+     * @param fps Y4M 文件头中的帧率
+     */
+    bool open(const std::string& path, StreamFormat format = STREAM_AUTO, double fps = 25) {
+        close();
+        FILE* f = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+        if (!f) {
+            std::cerr << "无法写入视频流: " << path << std::endl;
+            return false;
+        }
+        if (format == STREAM_AUTO) {
+            bool y4m = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+            format = y4m ? STREAM_Y4M : STREAM_PNM;
+        }
+        owned_ = f != stdout;
+        start(f, format, fps);
+        return true;
+    }
+
+    /**
+     * @brief 写到已打开的文件（例如 popen 的管道），不负责关闭
+     */
+    bool open(FILE* f, StreamFormat format, double fps = 25) {
+        close();
+        start(f, format == STREAM_AUTO ? STREAM_PNM : format, fps);
+        return true;
+    }
+
+    void close() {
+        if (f_) {
+            std::fflush(f_);
+            if (owned_) {
+                std::fclose(f_);
+            }
+        }
+        f_ = nullptr;
+        owned_ = false;
+    }
+
+    /**
+     * @brief 写出一帧
+     *
+     * @param frame CV_8UC3（BGR）或 CV_8UC1
+     *
+     * @return 写入失败或帧的尺寸与之前不同时返回 false
+     */
+    bool write(const cv::Mat& frame) {
+        CV_Assert(frame.type() == CV_8UC3 || frame.type() == CV_8UC1);
+        if (!f_) {
+            return false;
+        }
+        return format_ == STREAM_Y4M ? write_y4m(frame) : write_pnm(frame);
+    }
+
+   private:
+    FILE* f_ = nullptr;
+    bool owned_ = false;
+    StreamFormat format_ = STREAM_PNM;
+    double fps_ = 25;
+    int width_ = 0, height_ = 0, type_ = -1;
+    std::vector<uint8_t> buf_;
+
+    void start(FILE* f, StreamFormat format, double fps) {
+        f_ = f;
+        format_ = format;
+        fps_ = fps;
+        type_ = -1;
+    }
+
+    bool write_y4m(const cv::Mat& frame) {
+        if (type_ < 0) {
+            width_ = frame.cols;
+            height_ = frame.rows;
+            type_ = frame.type();
+            int num = (int)std::lround(fps_ * 1000);
+            std::fprintf(f_, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C%s\n", width_, height_, num,
+                         type_ == CV_8UC3 ? "420jpeg" : "mono");
+        } else if (frame.cols != width_ || frame.rows != height_ || frame.type() != type_) {
+            std::cerr << "Y4M 流中帧的尺寸不能改变" << std::endl;
+            return false;
+        }
+        std::fputs("FRAME\n", f_);
+        if (type_ == CV_8UC1) {
+            for (int y = 0; y < height_; ++y) {
+                std::fwrite(frame.ptr<uint8_t>(y), 1, width_, f_);
+            }
+        } else {
+            size_t chroma = (size_t)((width_ + 1) / 2) * ((height_ + 1) / 2);
+            buf_.resize((size_t)width_ * height_ + 2 * chroma);
+            bgr_to_yuv(frame, 1, buf_.data());
+            std::fwrite(buf_.data(), 1, buf_.size(), f_);
+        }
+        return !std::ferror(f_);
+    }
+
+    bool write_pnm(const cv::Mat& frame) {
+        bool color = frame.channels() == 3;
+        std::fprintf(f_, "P%c\n%d %d\n255\n", color ? '6' : '5', frame.cols, frame.rows);
+        size_t row = (size_t)frame.cols * frame.channels();
+        buf_.resize(row);
+        for (int y = 0; y < frame.rows; ++y) {
+            const uint8_t* p = frame.ptr<uint8_t>(y);
+            if (color) {
+                for (size_t i = 0; i < row; i += 3) {
+                    buf_[i] = p[i + 2];  // BGR → RGB
+                    buf_[i + 1] = p[i + 1];
+                    buf_[i + 2] = p[i];
+                }
+                p = buf_.data();
+            }
+            std::fwrite(p, 1, row, f_);
+        }
+        return !std::ferror(f_);
+    }
+};
+
+/**
+ * @brief 流处理的参数
+ */
+struct StreamConfig {
+    int buffers = 4;         // 循环使用的帧缓冲数，即同时在流水线中的最多帧数
+    double deadline_ms = 0;  // 一帧从读入完成到开始写出的最长时间，超过时丢弃该帧；0 表示不丢帧
+};
+
+/**
+ * @brief 一个阶段的耗时统计（毫秒）
+ */
+struct StreamStageStats {
+    int frames = 0;
+    double total_ms = 0, max_ms = 0;
+
+    double mean_ms() const { return frames ? total_ms / frames : 0; }
+
+    void add(double ms) {
+        ++frames;
+        total_ms += ms;
+        max_ms = std::max(max_ms, ms);
+    }
+};
+
+/**
+ * @brief 流处理的统计
+ */
+struct StreamStats {
+    StreamStageStats decode, process, encode;
+    StreamStageStats latency;  // 读入完成到写出完成，只统计写出的帧
+    int frames = 0;            // 读入的帧数
+    int dropped = 0;           // 超过期限丢弃的帧数
+    int stopped = 0;           // 出错停止后没有处理或写出的帧数
+    double elapsed_ms = 0;     // 总耗时
+
+    // 写出的帧数（包括写出失败的那一帧）
+    int written() const { return frames - dropped - stopped; }
+
+    /**
+     * @brief 每个阶段一行的文字报告
+     */
+    std::string report() const {
+        std::string s;
+        char buf[128];
+        const struct {
+            const char* name;
+            const StreamStageStats& st;
+        } stages[] = {{"decode", decode}, {"process", process}, {"encode", encode}, {"latency", latency}};
+        for (const auto& st : stages) {
+            std::snprintf(buf, sizeof(buf), "%-8s %6d frames  mean %8.3f ms  max %8.3f ms\n", st.name, st.st.frames,
+                          st.st.mean_ms(), st.st.max_ms);
+            s += buf;
+        }
+        std::snprintf(buf, sizeof(buf), "%d frames, %d dropped, %d stopped, %.1f fps\n", frames, dropped, stopped,
+                      elapsed_ms > 0 ? written() * 1000.0 / elapsed_ms : 0.0);
+        return s + buf;
+    }
+};
+
+/**
+ * @brief 帧缓冲编号的阻塞队列，容量固定（等于帧缓冲数），不会在运行中分配内存
+ */
+class StreamQueue {
+   public:
+    explicit StreamQueue(int capacity) : items_(capacity) {}
+
+    void push(int v) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_[(head_ + size_) % items_.size()] = v;
+            ++size_;
+        }
+        ready_.notify_one();
+    }
+
+    /**
+     * @brief 取出一个编号，队列已关闭且为空时返回 false
+     */
+    bool pop(int& v) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return size_ > 0 || closed_; });
+        if (size_ == 0) {
+            return false;
+        }
+        v = items_[head_];
+        head_ = (head_ + 1) % items_.size();
+        --size_;
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+   private:
+    std::vector<int> items_;
+    size_t head_ = 0, size_ = 0;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+};
+
+/**
+ * @brief 流式处理：读入、处理、写出三个阶段各占一个线程，相邻的帧在不同阶段上重叠执行
+ *
+ * cfg.buffers 个帧缓冲（输入、输出各一幅图像）在三个阶段之间循环，尺寸不变时稳定后不再分配内存；
+ * 缓冲全部在用时读入阶段等待（对管道形成反压）。fn 在调用线程上执行，内部的并行照常使用线程池。
+ * 设置了 deadline_ms 时，开始处理或开始写出时已超过期限的帧被丢弃，不写出，使延迟保持有界（计入 dropped）。
+ * 写出失败或 fn 抛出异常后停止读入，已读入的帧不再处理、写出（计入 stopped）；
+ * fn 抛出的异常在所有线程退出后重新抛出。
+ *
+ * @param in 输入流
+ * @param out 输出流
+ * @param fn 处理函数 fn(input, output)，output 是上一次使用该缓冲时的结果，可以作为 dst 复用
+ * @param cfg 参数
+ */
+inline StreamStats stream_process(FrameReader& in, FrameWriter& out,
+                                  const std::function<void(const cv::Mat&, cv::Mat&)>& fn,
+                                  const StreamConfig& cfg = StreamConfig()) {
+    typedef std::chrono::steady_clock Clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    enum Skip { SKIP_NONE, SKIP_LATE, SKIP_STOPPED };
+    struct Slot {
+        cv::Mat input, output;
+        Clock::time_point ready;  // 读入完成的时间
+        Skip skip = SKIP_NONE;    // 不写出的原因
+    };
+
+    CV_Assert(cfg.buffers >= 1);
+    std::vector<Slot> slots(cfg.buffers);
+    StreamQueue free_slots(cfg.buffers), decoded(cfg.buffers), processed(cfg.buffers);
+    for (int i = 0; i < cfg.buffers; ++i) {
+        free_slots.push(i);
+    }
+    std::atomic<bool> stop(false);
+    StreamStats stats;
+    Clock::time_point begin = Clock::now();
+    auto late = [&](const Slot& s) { return cfg.deadline_ms > 0 && ms(s.ready, Clock::now()) > cfg.deadline_ms; };
+
+    std::thread decoder([&] {
+        int i;
+        while (free_slots.pop(i) && !stop) {
+            Clock::time_point t = Clock::now();
+            if (!in.read(slots[i].input)) {
+                break;
+            }
+            slots[i].ready = Clock::now();
+            stats.decode.add(ms(t, slots[i].ready));
+            ++stats.frames;
+            decoded.push(i);
+        }
+        decoded.close();
+    });
+
+    std::thread encoder([&] {
+        int i;
+        while (processed.pop(i)) {
+            Slot& s = slots[i];
+            if (s.skip == SKIP_NONE) {
+                s.skip = stop ? SKIP_STOPPED : late(s) ? SKIP_LATE : SKIP_NONE;
+            }
+            if (s.skip == SKIP_LATE) {
+                ++stats.dropped;
+            } else if (s.skip == SKIP_STOPPED) {
+                ++stats.stopped;
+            } else {
+                Clock::time_point t = Clock::now();
+                if (!out.write(s.output)) {
+                    std::cerr << "视频流写出失败" << std::endl;
+                    stop = true;
+                }
+                Clock::time_point done = Clock::now();
+                stats.encode.add(ms(t, done));
+                stats.latency.add(ms(s.ready, done));
+            }
+            free_slots.push(i);
+        }
+    });
+
+    // 出错后继续取出剩余的帧（不处理），使另外两个线程能够退出
+    std::exception_ptr error;
+    int i;
+    while (decoded.pop(i)) {
+        Slot& s = slots[i];
+        s.skip = stop ? SKIP_STOPPED : late(s) ? SKIP_LATE : SKIP_NONE;
+        if (s.skip == SKIP_NONE) {
+            Clock::time_point t = Clock::now();
+            try {
+                fn(s.input, s.output);
+            } catch (...) {
+                error = std::current_exception();
+                stop = true;
+                s.skip = SKIP_STOPPED;
+            }
+            stats.process.add(ms(t, Clock::now()));
+        }
+        processed.push(i);
+    }
+    processed.close();
+    encoder.join();
+    free_slots.close();
+    decoder.join();
+    stats.elapsed_ms = ms(begin, Clock::now());
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return stats;
+}
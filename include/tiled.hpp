@@ -0,0 +1,299 @@
+#pragma once
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include <opencv2/core.hpp>
+
+#include "convolve.hpp"
+#include "mapped_file.hpp"
+#include "morphology.hpp"
+#include "parallel.hpp"
+#include "pipeline.hpp"
+#include "resize.hpp"
+
+/*
+ * 分块图像文件格式（小端序）
+ *
+ *   TiledFileHeader                    64 字节
+ *   块 (0, 0)、(1, 0) ...              按行优先排列，从 TILED_PAGE 开始，每块 tile × tile 个像素，
+ *                                      大小对齐到 TILED_PAGE
+ *
+ * 右、下边缘的块同样占一整块，只使用左上部分。文件用 ftruncate 建立，未写入的块不占磁盘空间。
+ * 每块对齐到页，块之间互不共享页，可以分别换出。
+ */
+
+static const char TILED_FILE_MAGIC[8] = {'C', 'E', 'D', 'A', 'R', 'T', 'I', 'L'};
+static const uint32_t TILED_FILE_VERSION = 1;
+static const size_t TILED_PAGE = 4096;
+
+struct TiledFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t type;  // OpenCV 类型，例如 CV_8UC3
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile;
+    uint32_t reserved0;
+    uint64_t chunk_bytes;  // 每块占用的字节数
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(TiledFileHeader) == 64, "TiledFileHeader must be 64 bytes");
+
+/**
+ * @brief 存放在磁盘上、按块内存映射的图像，用于放不进内存的大图
+ *
+ * 文件以 MAP_SHARED 方式映射，访问到的块才由系统读入；处理完的块用 evict 换出，
+ * 使常驻内存只取决于同时处理的块数和块大小，与图像大小无关。
+ * 不同的线程可以同时读写不重叠的区域。
+ */
+class TiledImage {
+   public:
+    TiledImage() {}
+    TiledImage(const TiledImage&) = delete;
+    TiledImage& operator=(const TiledImage&) = delete;
+    ~TiledImage() { close(); }
+
+    /**
+     * @brief 新建（覆盖）分块图像文件，内容为 0
+     *
+     * @param path 文件路径
+     * @param width 宽度
+     * @param height 高度
+     * @param type 类型（CV_8UC1 ~ CV_8UC4 等）
+     * @param tile 块的边长，必须是 8 的倍数（8 × 8 的 DCT 块不会跨越两块），不超过 65536
+     *
+     * @return 成功返回 true
+     */
+    bool create(const std::string& path, int width, int height, int type, int tile = 256) {
+        CV_Assert(width > 0 && height > 0 && tile >= 8 && tile % 8 == 0 && tile <= 65536);
+        close();
+        TiledFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, TILED_FILE_MAGIC, sizeof(header.magic));
+        header.version = TILED_FILE_VERSION;
+        header.type = (uint32_t)type;
+        header.width = (uint32_t)width;
+        header.height = (uint32_t)height;
+        header.tile = (uint32_t)tile;
+        header.chunk_bytes = align((size_t)tile * tile * CV_ELEM_SIZE(type));
+        size_t tiles = (size_t)((width + tile - 1) / tile) * ((height + tile - 1) / tile);
+        uint64_t size = TILED_PAGE + tiles * header.chunk_bytes;
+        return file_.create(path, size, &header, sizeof(header), "分块图像") && parse(path);
+    }
+
+    /**
+     * @brief 打开已有的分块图像文件
+     *
+     * @param path 文件路径
+     * @param writable 是否可写；只读打开时不能调用 write，也不能写入 tile 返回的图像
+     *
+     * @return 成功返回 true，文件不存在或格式不正确时返回 false
+     */
+    bool open(const std::string& path, bool writable = false) {
+        close();
+        return file_.open(path, writable, TILED_PAGE, "分块图像") && parse(path);
+    }
+
+    /**
+     * @brief 解除映射（已写入的内容由系统写回文件）
+     */
+    void close() { file_.close(); }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    cv::Size size() const { return cv::Size(width_, height_); }
+    int type() const { return type_; }
+    int tile() const { return tile_; }
+    int tiles_x() const { return (width_ + tile_ - 1) / tile_; }
+    int tiles_y() const { return (height_ + tile_ - 1) / tile_; }
+
+    /**
+     * @brief 第 (tx, ty) 块，直接指向映射的内存（边缘的块小于 tile × tile）
+     */
+    cv::Mat tile(int tx, int ty) const {
+        CV_Assert(tx >= 0 && tx < tiles_x() && ty >= 0 && ty < tiles_y());
+        int w = std::min(tile_, width_ - tx * tile_), h = std::min(tile_, height_ - ty * tile_);
+        return cv::Mat(h, w, type_, chunk(tx, ty), (size_t)tile_ * CV_ELEM_SIZE(type_));
+    }
+
+    /**
+     * @brief 把矩形区域复制到 dst（尺寸、类型不变时复用 dst 的缓冲区）
+     */
+    void read(const cv::Rect& r, cv::Mat& dst) const {
+        CV_Assert(r.x >= 0 && r.y >= 0 && r.width > 0 && r.height > 0 && r.x + r.width <= width_ &&
+                  r.y + r.height <= height_);
+        dst.create(r.height, r.width, type_);
+        copy(r, dst.data, dst.step, false);
+    }
+
+    /**
+     * @brief 把 src 写到左上角为 at 的区域
+     */
+    void write(cv::Point at, const cv::Mat& src) {
+        CV_Assert(file_.writable() && src.type() == type_ && at.x >= 0 && at.y >= 0 && at.x + src.cols <= width_ &&
+                  at.y + src.rows <= height_);
+        copy(cv::Rect(at.x, at.y, src.cols, src.rows), (uint8_t*)src.data, src.step, true);
+    }
+
+    /**
+     * @brief 换出与矩形区域重叠的块的内存页（不影响内容，之后访问时重新从页缓存或文件读入）
+     */
+    void evict(const cv::Rect& r) const {
+        for (int ty = r.y / tile_; ty <= (r.y + r.height - 1) / tile_; ++ty) {
+            for (int tx = r.x / tile_; tx <= (r.x + r.width - 1) / tile_; ++tx) {
+                madvise(chunk(tx, ty), chunk_bytes_, MADV_DONTNEED);
+            }
+        }
+    }
+
+   private:
+    MappedFile file_;
+    size_t chunk_bytes_ = 0;
+    int width_ = 0, height_ = 0, type_ = 0, tile_ = 0;
+
+    static size_t align(size_t v) { return (v + TILED_PAGE - 1) / TILED_PAGE * TILED_PAGE; }
+
+    uint8_t* chunk(int tx, int ty) const {
+        return file_.data() + TILED_PAGE + ((size_t)ty * tiles_x() + tx) * chunk_bytes_;
+    }
+
+    bool parse(const std::string& path) {
+        // 关闭预读：否则缺页时系统会顺带映射相邻块的页，这些页不在 evict 的范围内，会一直占用内存
+        madvise(file_.data(), file_.size(), MADV_RANDOM);
+
+        const TiledFileHeader* h = (const TiledFileHeader*)file_.data();
+        bool ok = file_.has_magic(TILED_FILE_MAGIC, sizeof(h->magic)) && h->version == TILED_FILE_VERSION &&
+                  h->tile >= 8 && h->tile % 8 == 0 && h->tile <= 65536 && h->width > 0 && h->height > 0 &&
+                  h->width <= INT32_MAX - h->tile && h->height <= INT32_MAX - h->tile;
+        if (ok) {
+            width_ = (int)h->width;
+            height_ = (int)h->height;
+            type_ = (int)h->type;
+            tile_ = (int)h->tile;
+            chunk_bytes_ = (size_t)h->chunk_bytes;
+            // 尺寸来自文件头，检查溢出，回绕的结果会绕过文件大小的检查
+            uint64_t tile_bytes, data_bytes, end;
+            ok = checked_mul((uint64_t)tile_ * tile_, CV_ELEM_SIZE(type_), tile_bytes) &&
+                 checked_mul((uint64_t)tiles_x() * tiles_y(), chunk_bytes_, data_bytes) &&
+                 checked_add(TILED_PAGE, data_bytes, end) && chunk_bytes_ >= tile_bytes && file_.size() >= end;
+        }
+        if (!ok) {
+            std::cerr << "分块图像格式错误: " << path << std::endl;
+            close();
+        }
+        return ok;
+    }
+
+    // 在矩形 r 与各块之间逐行复制，to_tiles 为 true 时从 data 写入块
+    void copy(const cv::Rect& r, uint8_t* data, size_t step, bool to_tiles) const {
+        size_t es = CV_ELEM_SIZE(type_), tstep = (size_t)tile_ * es;
+        for (int ty = r.y / tile_; ty <= (r.y + r.height - 1) / tile_; ++ty) {
+            int y0 = std::max(r.y, ty * tile_), y1 = std::min(r.y + r.height, (ty + 1) * tile_);
+            for (int tx = r.x / tile_; tx <= (r.x + r.width - 1) / tile_; ++tx) {
+                int x0 = std::max(r.x, tx * tile_), x1 = std::min(r.x + r.width, (tx + 1) * tile_);
+                uint8_t* t = chunk(tx, ty) + (size_t)(x0 - tx * tile_) * es;
+                size_t len = (size_t)(x1 - x0) * es;
+                for (int y = y0; y < y1; ++y) {
+                    uint8_t* p = t + (size_t)(y - ty * tile_) * tstep;
+                    uint8_t* q = data + (size_t)(y - r.y) * step + (size_t)(x0 - r.x) * es;
+                    if (to_tiles) {
+                        std::memcpy(p, q, len);
+                    } else {
+                        std::memcpy(q, p, len);
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief 分块执行邻域运算：dst 的每一块从 src 读入该块加上四周 halo 个像素（截断到图像内），
+ * 调用 fn(input, output) 后取中间部分写入 dst
+ *
+ * 只要 halo 不小于运算的邻域半径，结果就与对整幅图像计算相同：图像边缘处读入的区域同样止于图像边缘，
+ * 内部的块边缘则由 halo 提供真实的邻居。块之间并行，每块处理完后换出用到的内存页，
+ * 峰值内存约为 线程数 × (tile + 2 × halo)² × 每像素字节数 × 2。
+ * 逐 8 × 8 块独立的运算（例如 answer_40 的 DCT 量化）取 halo 为 0 即可。
+ *
+ * @param src 输入
+ * @param dst 输出，尺寸与 src 相同，按 dst 的块划分
+ * @param halo 邻域半径（像素）
+ * @param fn 处理函数，output 的尺寸与 input 相同、类型与 dst 相同
+ */
+inline void tiled_apply(const TiledImage& src, TiledImage& dst, int halo,
+                        const std::function<void(const cv::Mat&, cv::Mat&)>& fn) {
+    CV_Assert(&src != &dst && src.size() == dst.size() && halo >= 0);
+    int t = dst.tile();
+    parallel_for_tiles(dst.width(), dst.height(), t, t, halo, [&](const ParallelTile& tile) {
+        cv::Rect outer(tile.x.halo_begin, tile.y.halo_begin, tile.x.halo_end - tile.x.halo_begin,
+                       tile.y.halo_end - tile.y.halo_begin);
+        cv::Mat input, output;
+        src.read(outer, input);
+        fn(input, output);
+        CV_Assert(output.rows == input.rows && output.cols == input.cols && output.type() == dst.type());
+        cv::Rect inner(tile.x.begin - outer.x, tile.y.begin - outer.y, tile.x.end - tile.x.begin,
+                       tile.y.end - tile.y.begin);
+        dst.write(cv::Point(tile.x.begin, tile.y.begin), output(inner));
+        src.evict(outer);  // halo 所在的块也要换出，否则被邻块读入后会一直留在内存中
+        dst.evict(cv::Rect(tile.x.begin, tile.y.begin, inner.width, inner.height));
+    });
+}
+
+/**
+ * @brief 分块滤波（与 convolve 的结果相同）
+ */
+inline void tiled_convolve(const TiledImage& src, TiledImage& dst, const Kernel& kernel) {
+    Convolver conv(kernel);
+    tiled_apply(src, dst, std::max(kernel.rows, kernel.cols) / 2,
+                [&](const cv::Mat& in, cv::Mat& out) { conv.apply(in, out); });
+}
+
+/**
+ * @brief 分块形态学运算（与 morphology 的结果相同），halo 为膨胀、腐蚀的总次数
+ */
+inline void tiled_morphology(const TiledImage& src, TiledImage& dst, const MorphologyConfig& cfg) {
+    int passes = cfg.op == MORPHOLOGY_OPEN || cfg.op == MORPHOLOGY_CLOSE ? 2 : 1;
+    tiled_apply(src, dst, cfg.iterations * passes,
+                [&](const cv::Mat& in, cv::Mat& out) { morphology(in, out, cfg); });
+}
+
+/**
+ * @brief 分块执行流水线的一个输出（与 Pipeline::run 的结果相同）
+ */
+inline void tiled_pipeline(const TiledImage& src, TiledImage& dst, const Pipeline& pipeline, PipelineNode output) {
+    tiled_apply(src, dst, pipeline.halo({output}), [&](const cv::Mat& in, cv::Mat& out) {
+        std::vector<cv::Mat> outs(1);
+        pipeline.run(in, {output}, outs);
+        out = outs[0];
+    });
+}
+
+/**
+ * @brief 分块重采样（与 resample 的结果相同）：dst 的每一块只读入 Resampler::src_rect 给出的源区域
+ *
+ * 缩小时每块读入的源区域随缩放比增大，大倍数缩小时应相应减小 dst 的块大小。
+ */
+inline void tiled_resample(const TiledImage& src, TiledImage& dst, ResampleFilter filter, bool antialias = true) {
+    CV_Assert(src.type() == dst.type() && CV_MAT_DEPTH(src.type()) == CV_8U);
+    Resampler resampler(src.size(), dst.size(), CV_MAT_CN(src.type()), filter, antialias);
+    int t = dst.tile();
+    parallel_for_tiles(dst.width(), dst.height(), t, t, 0, [&](const ParallelTile& tile) {
+        cv::Rect roi(tile.x.begin, tile.y.begin, tile.x.end - tile.x.begin, tile.y.end - tile.y.begin);
+        cv::Rect from = resampler.src_rect(roi);
+        cv::Mat input, output(roi.height, roi.width, dst.type());
+        src.read(from, input);
+        resampler.apply(input.data, input.step, cv::Point(from.x, from.y), output.data, output.step, roi);
+        dst.write(cv::Point(roi.x, roi.y), output);
+        src.evict(from);
+        dst.evict(roi);
+    });
+}
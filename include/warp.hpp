@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "parallel.hpp"
+
+/**
+ * @brief 插值方式
+ */
+enum WarpInterp {
+    WARP_NEAREST,
+    WARP_BILINEAR,
+    WARP_BICUBIC,
+};
+
+/**
+ * @brief 仿射变换矩阵
+ *
+ * 正向映射：x' = a * x + b * y + tx，y' = c * x + d * y + ty。
+ * 注意与 answer_28~31 的 affine 不同，这里平移作用在线性变换之后。
+ */
+struct AffineMatrix {
+    double a, b, c, d, tx, ty;
+};
+
+/**
+ * @brief 求仿射变换的逆
+ */
+inline AffineMatrix affine_invert(const AffineMatrix& m) {
+    double det = m.a * m.d - m.b * m.c;
+    AffineMatrix inv;
+    inv.a = m.d / det;
+    inv.b = -m.b / det;
+    inv.c = -m.c / det;
+    inv.d = m.a / det;
+    inv.tx = -(inv.a * m.tx + inv.b * m.ty);
+    inv.ty = -(inv.c * m.tx + inv.d * m.ty);
+    return inv;
+}
+
+/**
+ * @brief 绕 (cx, cy) 旋转 theta 度的仿射变换
+ *
+ * 与 answer_30 的旋转方向相同（theta 为负时顺时针）。
+ */
+inline AffineMatrix affine_rotation(double theta, double cx, double cy) {
+    double rad = theta / 180. * M_PI;
+    AffineMatrix m;
+    m.a = std::cos(rad);
+    m.b = -std::sin(rad);
+    m.c = std::sin(rad);
+    m.d = std::cos(rad);
+    m.tx = cx - (m.a * cx + m.b * cy);
+    m.ty = cy - (m.c * cx + m.d * cy);
+    return m;
+}
+
+static const int WARP_FIX_BITS = 16;  // 源坐标为 16.16 定点数
+static const int WARP_FIX_ONE = 1 << WARP_FIX_BITS;
+static const int WARP_FIX_HALF = 1 << (WARP_FIX_BITS - 1);
+static const int WARP_MAX_SIZE = (1 << (31 - WARP_FIX_BITS)) - 1;  // 源图宽高上限，保证源坐标不超出 int32
+
+/**
+ * @brief 双三次插值的权重表
+ *
+ * 按小数部分的高 8 bit 取 4 个 Q10 权重，核函数与 answer_27 的 h 相同（a = -1）。
+ */
+struct CubicWeightTable {
+    int16_t w[256][4];
+
+    CubicWeightTable() {
+        const double a = -1;
+        auto h = [&](double t) {
+            t = std::fabs(t);
+            if (t <= 1) {
+                return (a + 2) * t * t * t - (a + 3) * t * t + 1;
+            } else if (t <= 2) {
+                return a * t * t * t - 5 * a * t * t + 8 * a * t - 4 * a;
+            }
+            return 0.0;
+        };
+        for (int i = 0; i < 256; ++i) {
+            double f = i / 256.0;
+            int sum = 0;
+            for (int k = 0; k < 4; ++k) {
+                w[i][k] = (int16_t)std::lround(h(f - (k - 1)) * 1024);
+                sum += w[i][k];
+            }
+            // 保证权重和严格为 1024
+            w[i][1] += (int16_t)(1024 - sum);
+        }
+    }
+};
+
+inline const CubicWeightTable& cubic_weight_table() {
+    static const CubicWeightTable table;
+    return table;
+}
+
+/**
+ * @brief 8 bit 图像上的定点采样器
+ *
+ * 采样点 (X, Y) 为 16.16 定点数的源坐标（像素中心为整数）。
+ * fast 版本假定插值所需的邻域全部在图像内，edge 版本对越界的邻域像素截断到边缘。
+ */
+struct WarpSampler {
+    const uint8_t* data;
+    size_t stride;
+    int width, height, channels;
+
+    const uint8_t* pixel(int x, int y) const { return data + (size_t)y * stride + (size_t)x * channels; }
+
+    const uint8_t* pixel_clamped(int x, int y) const {
+        return pixel(std::min(std::max(x, 0), width - 1), std::min(std::max(y, 0), height - 1));
+    }
+
+    void nearest(int32_t X, int32_t Y, uint8_t* out) const {
+        const uint8_t* p = pixel((X + WARP_FIX_HALF) >> WARP_FIX_BITS, (Y + WARP_FIX_HALF) >> WARP_FIX_BITS);
+        for (int c = 0; c < channels; ++c) {
+            out[c] = p[c];
+        }
+    }
+
+    template <bool EDGE>
+    void bilinear(int32_t X, int32_t Y, uint8_t* out) const {
+        int x0 = X >> WARP_FIX_BITS, y0 = Y >> WARP_FIX_BITS;
+        int fx = (X >> 8) & 255, fy = (Y >> 8) & 255;
+        const uint8_t *p00, *p01, *p10, *p11;
+        if (EDGE) {
+            p00 = pixel_clamped(x0, y0);
+            p01 = pixel_clamped(x0 + 1, y0);
+            p10 = pixel_clamped(x0, y0 + 1);
+            p11 = pixel_clamped(x0 + 1, y0 + 1);
+        } else {
+            p00 = pixel(x0, y0);
+            p01 = p00 + channels;
+            p10 = p00 + stride;
+            p11 = p10 + channels;
+        }
+        for (int c = 0; c < channels; ++c) {
+            int top = p00[c] * (256 - fx) + p01[c] * fx;
+            int bottom = p10[c] * (256 - fx) + p11[c] * fx;
+            out[c] = (uint8_t)((top * (256 - fy) + bottom * fy + (1 << 15)) >> 16);
+        }
+    }
+
+    template <bool EDGE>
+    void bicubic(int32_t X, int32_t Y, uint8_t* out) const {
+        const CubicWeightTable& table = cubic_weight_table();
+        int x0 = X >> WARP_FIX_BITS, y0 = Y >> WARP_FIX_BITS;
+        const int16_t* wx = table.w[(X >> 8) & 255];
+        const int16_t* wy = table.w[(Y >> 8) & 255];
+
+        for (int c = 0; c < channels; ++c) {
+            int acc = 1 << 19;
+            for (int j = 0; j < 4; ++j) {
+                int row = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const uint8_t* p = EDGE ? pixel_clamped(x0 + i - 1, y0 + j - 1) : pixel(x0 + i - 1, y0 + j - 1);
+                    row += p[c] * wx[i];
+                }
+                acc += row * wy[j];
+            }
+            out[c] = (uint8_t)std::min(std::max(acc >> 20, 0), 255);
+        }
+    }
+};
+
+/**
+ * @brief 求 lo <= s0 + x * ds <= hi 的 x 区间，与 [x0, x1) 求交
+ *
+ * 坐标是 x 的线性函数，满足条件的 x 一定是一个区间，可以直接解出，不需要逐像素判断。
+ *
+ * @return 区间 [first, second)，x0 <= first <= second <= x1
+ */
+inline std::pair<int, int> warp_span(int64_t s0, int64_t ds, int64_t lo, int64_t hi, int x0, int x1) {
+    auto floor_div = [](int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); };
+    auto ceil_div = [&](int64_t a, int64_t b) { return -floor_div(-a, b); };
+
+    if (ds == 0) {
+        return (s0 >= lo && s0 <= hi) ? std::make_pair(x0, x1) : std::make_pair(x0, x0);
+    }
+    int64_t a, b;
+    if (ds > 0) {
+        a = ceil_div(lo - s0, ds);
+        b = floor_div(hi - s0, ds) + 1;
+    } else {
+        a = ceil_div(hi - s0, ds);
+        b = floor_div(lo - s0, ds) + 1;
+    }
+    int first = (int)std::min<int64_t>(std::max<int64_t>(a, x0), x1);
+    int second = (int)std::min<int64_t>(std::max<int64_t>(b, first), x1);
+    return std::make_pair(first, second);
+}
+
+/**
+ * @brief 仿射变换
+ *
+ * 对每一行输出，源坐标用 16.16 定点数从行首开始逐像素累加步长，不再逐像素做浮点乘除。
+ * 累加在 int64 上进行，只有落在有效区间内的坐标才截成 int32 交给采样器，
+ * 因此源图宽高不能超过 WARP_MAX_SIZE（32767）；目标尺寸和变换的缩放倍数没有限制。
+ * 每行先解析地求出两个区间：
+ *   - 有效区间：采样点落在图像内（含半个像素的边缘），区间外填充 border；
+ *   - 内部区间：插值邻域完全在图像内，使用不做边界判断的快速路径；
+ *     有效区间中内部区间以外的部分使用截断到边缘的采样。
+ * 输出按 64 × 64 的 tile 并行计算。
+ *
+ * @param src CV_8U 源图，1~4 通道
+ * @param dst 输出，按 dsize 和 src 的类型分配
+ * @param m 正向仿射变换（源 -> 目标）
+ * @param dsize 输出尺寸
+ * @param interp 插值方式
+ * @param border 有效区间以外填充的值
+ */
+inline void warp_affine(const cv::Mat& src, cv::Mat& dst, const AffineMatrix& m, cv::Size dsize,
+                        WarpInterp interp = WARP_BILINEAR, uint8_t border = 0) {
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4 && src.data != dst.data);
+    CV_Assert(src.cols <= WARP_MAX_SIZE && src.rows <= WARP_MAX_SIZE);
+    dst.create(dsize.height, dsize.width, src.type());
+
+    // 逆映射：src = inv * (dst + 0.5) - 0.5，换算成 16.16 定点数
+    AffineMatrix inv = affine_invert(m);
+    double ox = inv.a * 0.5 + inv.b * 0.5 + inv.tx - 0.5;
+    double oy = inv.c * 0.5 + inv.d * 0.5 + inv.ty - 0.5;
+    int64_t dxx = std::llround(inv.a * WARP_FIX_ONE), dxy = std::llround(inv.b * WARP_FIX_ONE);
+    int64_t dyx = std::llround(inv.c * WARP_FIX_ONE), dyy = std::llround(inv.d * WARP_FIX_ONE);
+    int64_t x00 = std::llround(ox * WARP_FIX_ONE), y00 = std::llround(oy * WARP_FIX_ONE);
+
+    WarpSampler s = {src.data, src.step, src.cols, src.rows, src.channels()};
+    int cn = s.channels;
+    int64_t W = s.width, H = s.height;
+
+    // 有效区间：距最近的像素中心不超过半个像素
+    int64_t valid_lo = -WARP_FIX_HALF;
+    int64_t valid_hi_x = ((W - 1) << WARP_FIX_BITS) + WARP_FIX_HALF - 1;
+    int64_t valid_hi_y = ((H - 1) << WARP_FIX_BITS) + WARP_FIX_HALF - 1;
+
+    // 内部区间：插值邻域完全在图像内
+    int64_t in_lo = 0, in_hi_x = valid_hi_x, in_hi_y = valid_hi_y;
+    if (interp == WARP_BILINEAR) {
+        in_hi_x = ((W - 1) << WARP_FIX_BITS) - 1;
+        in_hi_y = ((H - 1) << WARP_FIX_BITS) - 1;
+    } else if (interp == WARP_BICUBIC) {
+        in_lo = WARP_FIX_ONE;
+        in_hi_x = ((W - 2) << WARP_FIX_BITS) - 1;
+        in_hi_y = ((H - 2) << WARP_FIX_BITS) - 1;
+    } else {
+        in_lo = valid_lo;
+    }
+
+    const int TILE = 64;
+
+    parallel_for_tiles(dsize.width, dsize.height, TILE, TILE, 0, [&](const ParallelTile& tile) {
+        int tx0 = tile.x.begin, tx1 = tile.x.end;
+        int ty0 = tile.y.begin, ty1 = tile.y.end;
+
+        for (int y = ty0; y < ty1; ++y) {
+            uint8_t* out = dst.ptr<uint8_t>(y);
+            int64_t X0 = x00 + dxy * y;
+            int64_t Y0 = y00 + dyy * y;
+
+            // 解析地求出有效区间和内部区间
+            std::pair<int, int> vx = warp_span(X0, dxx, valid_lo, valid_hi_x, tx0, tx1);
+            std::pair<int, int> vy = warp_span(Y0, dyx, valid_lo, valid_hi_y, vx.first, vx.second);
+            int v0 = vy.first, v1 = vy.second;
+            std::pair<int, int> ix = warp_span(X0, dxx, in_lo, in_hi_x, v0, v1);
+            std::pair<int, int> iy = warp_span(Y0, dyx, in_lo, in_hi_y, ix.first, ix.second);
+            int i0 = iy.first, i1 = iy.second;
+            if (i0 == i1) {
+                i0 = i1 = v1;
+            }
+
+            std::fill(out + (size_t)tx0 * cn, out + (size_t)v0 * cn, border);
+            std::fill(out + (size_t)v1 * cn, out + (size_t)tx1 * cn, border);
+
+            // 逐像素累加步长；区间内的坐标一定在 int32 范围内，最后一次累加可能越界，所以用 int64
+            auto run = [&](int x0, int x1, auto sample) {
+                int64_t X = X0 + dxx * x0, Y = Y0 + dyx * x0;
+                for (int x = x0; x < x1; ++x) {
+                    sample((int32_t)X, (int32_t)Y, out + (size_t)x * cn);
+                    X += dxx;
+                    Y += dyx;
+                }
+            };
+
+            switch (interp) {
+                case WARP_NEAREST:
+                    run(v0, v1, [&](int32_t X, int32_t Y, uint8_t* o) { s.nearest(X, Y, o); });
+                    break;
+                case WARP_BILINEAR:
+                    run(v0, i0, [&](int32_t X, int32_t Y, uint8_t* o) { s.bilinear<true>(X, Y, o); });
+                    run(i0, i1, [&](int32_t X, int32_t Y, uint8_t* o) { s.bilinear<false>(X, Y, o); });
+                    run(i1, v1, [&](int32_t X, int32_t Y, uint8_t* o) { s.bilinear<true>(X, Y, o); });
+                    break;
+                case WARP_BICUBIC:
+                    run(v0, i0, [&](int32_t X, int32_t Y, uint8_t* o) { s.bicubic<true>(X, Y, o); });
+                    run(i0, i1, [&](int32_t X, int32_t Y, uint8_t* o) { s.bicubic<false>(X, Y, o); });
+                    run(i1, v1, [&](int32_t X, int32_t Y, uint8_t* o) { s.bicubic<true>(X, Y, o); });
+                    break;
+            }
+        }
+    });
+}
+
+/**
+ * @brief 仿射变换（返回新图像）
+ */
+inline cv::Mat warp_affine(const cv::Mat& src, const AffineMatrix& m, cv::Size dsize,
+                           WarpInterp interp = WARP_BILINEAR, uint8_t border = 0) {
+    cv::Mat dst;
+    warp_affine(src, dst, m, dsize, interp, border);
+    return dst;
+}
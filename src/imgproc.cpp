@@ -0,0 +1,157 @@
+// libimgproc 的入口：检测 CPU，选择内核表并转发调用。按基线指令集编译。
+
+#include "imgproc.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "imgproc_kernels.hpp"
+
+namespace imgproc {
+
+namespace {
+
+const ImgprocKernels* table_for(CpuLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+    switch (level) {
+        case CPU_AVX512:
+            return imgproc_kernels_avx512();
+        case CPU_AVX2:
+            return imgproc_kernels_avx2();
+        case CPU_SSE42:
+            return imgproc_kernels_sse42();
+        default:
+            break;
+    }
+#endif
+    (void)level;
+    return imgproc_kernels_baseline();
+}
+
+CpuLevel parse_level(const char* name, CpuLevel fallback) {
+    for (int level = CPU_BASELINE; level <= CPU_AVX512; ++level) {
+        if (std::strcmp(name, cpu_level_name((CpuLevel)level)) == 0) {
+            return (CpuLevel)level;
+        }
+    }
+    return fallback;
+}
+
+struct Dispatch {
+    std::atomic<int> level;
+    std::atomic<const ImgprocKernels*> kernels;
+
+    Dispatch() {
+        CpuLevel detected = cpu_detect(), use = detected;
+        if (const char* env = std::getenv("IMGPROC_CPU")) {
+            use = std::min(detected, parse_level(env, detected));
+        }
+        level = use;
+        kernels = table_for(use);
+    }
+};
+
+Dispatch& dispatch() {
+    static Dispatch d;
+    return d;
+}
+
+const ImgprocKernels& kernels() { return *dispatch().kernels.load(std::memory_order_acquire); }
+
+}  // namespace
+
+CpuLevel cpu_detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512vbmi")) {
+        return CPU_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return CPU_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("ssse3")) {
+        return CPU_SSE42;
+    }
+#endif
+    return CPU_BASELINE;
+}
+
+CpuLevel cpu_level() { return (CpuLevel)dispatch().level.load(); }
+
+CpuLevel set_cpu_level(CpuLevel level) {
+    level = std::min(level, cpu_detect());
+    Dispatch& d = dispatch();
+    d.kernels.store(table_for(level), std::memory_order_release);
+    d.level = level;
+    return level;
+}
+
+const char* cpu_level_name(CpuLevel level) {
+    static const char* names[] = {"baseline", "sse42", "avx2", "avx512"};
+    return level >= CPU_BASELINE && level <= CPU_AVX512 ? names[level] : "unknown";
+}
+
+void set_thread_limit(int limit) {
+    for (int level = CPU_BASELINE; level <= cpu_detect(); ++level) {
+        table_for((CpuLevel)level)->set_thread_limit(limit);
+    }
+}
+
+void apply_lut(const cv::Mat& src, cv::Mat& dst, const Lut& lut) { kernels().lut(src, dst, lut.table); }
+
+void apply_lut(const cv::Mat& src, cv::Mat& dst, const ChannelLut& lut) {
+    uint8_t tables[4][256];
+    for (int c = 0; c < lut.channels; ++c) {
+        std::memcpy(tables[c], lut.ch[c].table, 256);
+    }
+    kernels().lut_channels(src, dst, tables, lut.channels);
+}
+
+void equalize_hist(const cv::Mat& src, cv::Mat& dst) { kernels().equalize_hist(src, dst); }
+
+void clahe(const cv::Mat& src, cv::Mat& dst, const ClaheConfig& cfg) {
+    kernels().clahe(src, dst, cfg.tiles_x, cfg.tiles_y, cfg.clip_limit, cfg.mode);
+}
+
+void convolve(const cv::Mat& src, cv::Mat& dst, const Kernel& kernel) {
+    CV_Assert((int)kernel.w.size() == kernel.rows * kernel.cols);
+    kernels().convolve(src, dst, kernel.rows, kernel.cols, kernel.w.data());
+}
+
+void gradient(const cv::Mat& gray, GradientImages& out, int outputs, const GradientConfig& cfg) {
+    cv::Mat* const images[4] = {&out.gx, &out.gy, &out.magnitude, &out.orientation};
+    kernels().gradient(gray, images, outputs, cfg.kernel, cfg.norm, cfg.reflect, cfg.bins, cfg.centered);
+}
+
+void pool(const cv::Mat& src, cv::Mat& dst, const PoolConfig& cfg) {
+    kernels().pool(src, dst, cfg.kernel, cfg.stride, cfg.pad, cfg.type, cfg.mosaic, cfg.ceil_mode);
+}
+
+void resample(const cv::Mat& src, cv::Mat& dst, cv::Size size, ResampleFilter filter, bool antialias) {
+    kernels().resample(src, dst, size, filter, antialias);
+}
+
+void warp_affine(const cv::Mat& src, cv::Mat& dst, const AffineMatrix& m, cv::Size dsize, WarpInterp interp,
+                 uint8_t border) {
+    const double a[6] = {m.a, m.b, m.c, m.d, m.tx, m.ty};
+    kernels().warp_affine(src, dst, a, dsize, interp, border);
+}
+
+void warp_perspective(const cv::Mat& src, cv::Mat& dst, const Homography& H, cv::Size dsize, WarpInterp interp,
+                      uint8_t border) {
+    kernels().warp_perspective(src, dst, H.h, dsize, interp, border);
+}
+
+void remap(const cv::Mat& src, cv::Mat& dst, const RemapTable& table, uint8_t border) {
+    CV_Assert(src.size() == table.src_size());
+    kernels().remap(src, dst, table.dst_size(), table.xy(), table.weights(), border);
+}
+
+void sauvola_binarize(const cv::Mat& gray, cv::Mat& dst, const SauvolaConfig& cfg) {
+    kernels().sauvola(gray, dst, cfg.window, cfg.k, cfg.r);
+}
+
+}  // namespace imgproc
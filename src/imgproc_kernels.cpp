@@ -0,0 +1,159 @@
+// 内核的实现，由 build_lib.sh 以不同的指令集选项各编译一次：
+//   -DIMGPROC_ISA=baseline                       x86-64 默认（SSE2）
+//   -DIMGPROC_ISA=sse42  -msse4.2                 SSSE3 pshufb 查表
+//   -DIMGPROC_ISA=avx2   -mavx2                   AVX2 查表、gather、Sauvola
+//   -DIMGPROC_ISA=avx512 -mavx512bw -mavx512vbmi  vpermi2b 查表
+// 头文件中的实现都是 inline 的，为避免不同指令集的同名函数在链接时被合并，
+// 每个版本整体放在自己的命名空间 imgproc_<isa> 中。
+// 被包含的头文件用到的标准库、OpenCV 头文件必须先在全局命名空间中包含。
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "imgproc_kernels.hpp"
+
+#ifndef IMGPROC_ISA
+#define IMGPROC_ISA baseline
+#endif
+
+#define IMGPROC_CAT2(a, b) a##b
+#define IMGPROC_CAT(a, b) IMGPROC_CAT2(a, b)
+#define IMGPROC_NS IMGPROC_CAT(imgproc_, IMGPROC_ISA)
+#define IMGPROC_STR2(a) #a
+#define IMGPROC_STR(a) IMGPROC_STR2(a)
+
+namespace IMGPROC_NS {
+
+#include "clahe.hpp"
+#include "convolve.hpp"
+#include "gradient.hpp"
+#include "histogram.hpp"
+#include "lut.hpp"
+#include "otsu.hpp"
+#include "pool.hpp"
+#include "remap.hpp"
+#include "resize.hpp"
+#include "warp.hpp"
+
+static void lut_entry(const cv::Mat& src, cv::Mat& dst, const uint8_t* table) { apply_lut(src, dst, table); }
+
+static void lut_channels_entry(const cv::Mat& src, cv::Mat& dst, const uint8_t (*tables)[256], int channels) {
+    ChannelLut lut(Lut::identity(), channels);
+    for (int c = 0; c < channels; ++c) {
+        std::copy(tables[c], tables[c] + 256, lut.ch[c].table);
+    }
+    apply_lut(src, dst, lut);
+}
+
+static void equalize_hist_entry(const cv::Mat& src, cv::Mat& dst) {
+    apply_lut(src, dst, equalize_lut(Histogram(src)));
+}
+
+static void clahe_entry(const cv::Mat& src, cv::Mat& dst, int tiles_x, int tiles_y, double clip_limit, int mode) {
+    ClaheConfig cfg;
+    cfg.tiles_x = tiles_x;
+    cfg.tiles_y = tiles_y;
+    cfg.clip_limit = clip_limit;
+    cfg.mode = (ClaheMode)mode;
+    clahe(src, dst, cfg);
+}
+
+static void convolve_entry(const cv::Mat& src, cv::Mat& dst, int rows, int cols, const double* weights) {
+    Kernel k(rows, cols);
+    std::copy(weights, weights + (size_t)rows * cols, k.w.begin());
+    Convolver(k).apply(src, dst);
+}
+
+static void gradient_entry(const cv::Mat& gray, cv::Mat* const out[4], int outputs, int kernel, int norm,
+                           bool reflect, int bins, bool centered) {
+    GradientConfig cfg;
+    cfg.kernel = (GradientKernel)kernel;
+    cfg.norm = (GradientNorm)norm;
+    cfg.reflect = reflect;
+    cfg.bins = bins;
+    cfg.centered = centered;
+    GradientImages images;
+    GradientOperator(cfg).apply(gray, images, outputs);
+    *out[0] = images.gx;
+    *out[1] = images.gy;
+    *out[2] = images.magnitude;
+    *out[3] = images.orientation;
+}
+
+static void pool_entry(const cv::Mat& src, cv::Mat& dst, int kernel, int stride, int pad, int type, bool mosaic,
+                       bool ceil_mode) {
+    PoolConfig cfg;
+    cfg.kernel = kernel;
+    cfg.stride = stride;
+    cfg.pad = pad;
+    cfg.type = (PoolType)type;
+    cfg.mosaic = mosaic;
+    cfg.ceil_mode = ceil_mode;
+    pool(src, dst, cfg);
+}
+
+static void resample_entry(const cv::Mat& src, cv::Mat& dst, cv::Size size, int filter, bool antialias) {
+    dst = resample(src, size, (ResampleFilter)filter, antialias);
+}
+
+static void warp_affine_entry(const cv::Mat& src, cv::Mat& dst, const double* m, cv::Size dsize, int interp,
+                              uint8_t border) {
+    AffineMatrix a = {m[0], m[1], m[2], m[3], m[4], m[5]};
+    warp_affine(src, dst, a, dsize, (WarpInterp)interp, border);
+}
+
+static void warp_perspective_entry(const cv::Mat& src, cv::Mat& dst, const double* h, cv::Size dsize, int interp,
+                                   uint8_t border) {
+    Homography H;
+    std::copy(h, h + 9, H.h);
+    warp_perspective(src, dst, H, dsize, (WarpInterp)interp, border);
+}
+
+static void remap_entry(const cv::Mat& src, cv::Mat& dst, cv::Size dst_size, const uint32_t* xy,
+                        const uint16_t* weights, uint8_t border) {
+    RemapTable::apply(src, dst, dst_size, xy, weights, border);
+}
+
+static void sauvola_entry(const cv::Mat& gray, cv::Mat& dst, int window, double k, double r) {
+    SauvolaConfig cfg;
+    cfg.window = window;
+    cfg.k = k;
+    cfg.r = r;
+    dst = sauvola_binarize(gray, cfg);
+}
+
+static void set_thread_limit_entry(int limit) { parallel_thread_limit() = limit; }
+
+}  // namespace IMGPROC_NS
+
+const ImgprocKernels* IMGPROC_CAT(imgproc_kernels_, IMGPROC_ISA)() {
+    using namespace IMGPROC_NS;
+    static const ImgprocKernels table = {
+        IMGPROC_STR(IMGPROC_ISA), lut_entry,     lut_channels_entry, equalize_hist_entry,    clahe_entry,
+        convolve_entry,           gradient_entry, pool_entry,         resample_entry,         warp_affine_entry,
+        warp_perspective_entry,   remap_entry,    sauvola_entry,      set_thread_limit_entry,
+    };
+    return &table;
+}
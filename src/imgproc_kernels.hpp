@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 一组按某个指令集编译的内核（库内部使用）
+ *
+ * imgproc_kernels.cpp 按不同的 -m 选项编译多次，每次得到一张表，
+ * imgproc.cpp 在运行时根据 cpuid 选择其中一张。
+ * 表中的函数只使用 cv::Mat 和基本类型作为参数：各指令集的实现位于不同的命名空间，
+ * 不能与调用方共享 Lut、Kernel 等类型（否则会把按高指令集编译的 inline 函数链接进基线代码）。
+ */
+struct ImgprocKernels {
+    const char* isa;
+    void (*lut)(const cv::Mat& src, cv::Mat& dst, const uint8_t* table);
+    void (*lut_channels)(const cv::Mat& src, cv::Mat& dst, const uint8_t (*tables)[256], int channels);
+    void (*equalize_hist)(const cv::Mat& src, cv::Mat& dst);
+    void (*clahe)(const cv::Mat& src, cv::Mat& dst, int tiles_x, int tiles_y, double clip_limit, int mode);
+    void (*convolve)(const cv::Mat& src, cv::Mat& dst, int rows, int cols, const double* weights);
+    void (*gradient)(const cv::Mat& gray, cv::Mat* const out[4], int outputs, int kernel, int norm, bool reflect,
+                     int bins, bool centered);
+    void (*pool)(const cv::Mat& src, cv::Mat& dst, int kernel, int stride, int pad, int type, bool mosaic,
+                 bool ceil_mode);
+    void (*resample)(const cv::Mat& src, cv::Mat& dst, cv::Size size, int filter, bool antialias);
+    void (*warp_affine)(const cv::Mat& src, cv::Mat& dst, const double* m, cv::Size dsize, int interp,
+                        uint8_t border);
+    void (*warp_perspective)(const cv::Mat& src, cv::Mat& dst, const double* h, cv::Size dsize, int interp,
+                             uint8_t border);
+    void (*remap)(const cv::Mat& src, cv::Mat& dst, cv::Size dst_size, const uint32_t* xy, const uint16_t* weights,
+                  uint8_t border);
+    void (*sauvola)(const cv::Mat& gray, cv::Mat& dst, int window, double k, double r);
+    void (*set_thread_limit)(int limit);
+};
+
+const ImgprocKernels* imgproc_kernels_baseline();
+#if defined(__x86_64__) || defined(__i386__)
+const ImgprocKernels* imgproc_kernels_sse42();
+const ImgprocKernels* imgproc_kernels_avx2();
+const ImgprocKernels* imgproc_kernels_avx512();
+#endif
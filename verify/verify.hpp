@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+/**
+ * @brief 允许的误差
+ *
+ * 逐元素比较：|参考 - 优化| 超过 max_diff 的元素所占比例不能超过 max_bad_ratio；
+ * min_psnr 大于 0 时，整幅图像的 PSNR 还不能低于它。默认值表示逐位相同。
+ */
+struct Tolerance {
+    int max_diff = 0;
+    double max_bad_ratio = 0;
+    double min_psnr = 0;
+};
+
+/**
+ * @brief 逐位相同
+ */
+inline Tolerance tol_exact() { return Tolerance(); }
+
+/**
+ * @brief 每个元素最多相差 max_diff，其中最多 bad_ratio 比例的元素可以例外
+ */
+inline Tolerance tol_diff(int max_diff, double bad_ratio = 0) {
+    Tolerance t;
+    t.max_diff = max_diff;
+    t.max_bad_ratio = bad_ratio;
+    return t;
+}
+
+/**
+ * @brief 只要求 PSNR 不低于 db（用于坐标约定不同、只能近似相等的实现）
+ */
+inline Tolerance tol_psnr(double db) {
+    Tolerance t;
+    t.max_diff = 255;
+    t.max_bad_ratio = 1;
+    t.min_psnr = db;
+    return t;
+}
+
+/**
+ * @brief 两幅图像的差异
+ */
+struct Comparison {
+    bool same_shape = false;
+    int max_diff = 0;
+    double bad_ratio = 0;                                   // 超过 Tolerance::max_diff 的元素比例
+    double psnr = std::numeric_limits<double>::infinity();  // 完全相同时为无穷大
+    cv::Point worst;                                        // 差异最大的像素位置
+};
+
+/**
+ * @brief 逐元素比较两幅 CV_8U 图像
+ *
+ * @param max_diff 统计 bad_ratio 时的阈值
+ * @param mask 可选的 CV_8UC1 掩码，为 0 的像素不参与比较
+ */
+inline Comparison compare_images(const cv::Mat& a, const cv::Mat& b, int max_diff, const cv::Mat& mask = cv::Mat()) {
+    Comparison r;
+    r.same_shape = a.size() == b.size() && a.type() == b.type();
+    if (!r.same_shape || a.empty()) {
+        return r;
+    }
+    CV_Assert(a.depth() == CV_8U && (mask.empty() || (mask.type() == CV_8UC1 && mask.size() == a.size())));
+    int cn = a.channels();
+    double sse = 0, n = 0;
+    size_t bad = 0;
+    for (int y = 0; y < a.rows; ++y) {
+        const uint8_t* pa = a.ptr<uint8_t>(y);
+        const uint8_t* pb = b.ptr<uint8_t>(y);
+        const uint8_t* pm = mask.empty() ? nullptr : mask.ptr<uint8_t>(y);
+        for (int x = 0; x < a.cols * cn; ++x) {
+            if (pm && !pm[x / cn]) {
+                continue;
+            }
+            int d = std::abs(pa[x] - pb[x]);
+            sse += (double)d * d;
+            bad += d > max_diff;
+            n += 1;
+            if (d > r.max_diff) {
+                r.max_diff = d;
+                r.worst = cv::Point(x / cn, y);
+            }
+        }
+    }
+    r.bad_ratio = n > 0 ? bad / n : 0;
+    if (sse > 0) {
+        r.psnr = 10 * std::log10(255.0 * 255.0 * n / sse);
+    }
+    return r;
+}
+
+/**
+ * @brief 差异是否在允许的范围内
+ */
+inline bool within_tolerance(const Comparison& c, const Tolerance& tol) {
+    return c.same_shape && c.bad_ratio <= tol.max_bad_ratio && (tol.min_psnr <= 0 || c.psnr >= tol.min_psnr);
+}
+
+/**
+ * @brief 随机输入图像的内容，可以按位组合
+ */
+enum VerifyPattern {
+    PATTERN_NOISE = 1,   // 均匀分布的噪声
+    PATTERN_SMOOTH = 2,  // 平滑的渐变叠加少量噪声（接近自然图像）
+    PATTERN_BLOCKS = 4,  // 随机的纯色矩形，边缘锐利
+    PATTERN_NARROW = 8,  // 只占很窄的一段灰度范围（直方图类算法的边界情况）
+    PATTERN_FLAT = 16,   // 整幅图像只有一个值
+    PATTERN_ALL = 31,
+};
+
+/**
+ * @brief 按 patterns 中随机选取的一种内容生成 CV_8U 图像
+ */
+inline cv::Mat verify_image(std::mt19937& rng, cv::Size size, int type, int patterns) {
+    std::vector<int> choices;
+    for (int p = PATTERN_NOISE; p < PATTERN_ALL; p <<= 1) {
+        if (patterns & p) {
+            choices.push_back(p);
+        }
+    }
+    CV_Assert(!choices.empty());
+    int pattern = choices[std::uniform_int_distribution<int>(0, (int)choices.size() - 1)(rng)];
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    cv::Mat img(size.height, size.width, type);
+    int cn = img.channels();
+    int lo = byte(rng) % 232, hi = lo + 1 + byte(rng) % 24;
+    int flat = byte(rng);
+    double fx = std::uniform_real_distribution<double>(0.2, 2.0)(rng);
+    double fy = std::uniform_real_distribution<double>(0.2, 2.0)(rng);
+    for (int y = 0; y < size.height; ++y) {
+        uint8_t* row = img.ptr<uint8_t>(y);
+        for (int x = 0; x < size.width * cn; ++x) {
+            int v = 0;
+            switch (pattern) {
+                case PATTERN_NOISE:
+                    v = byte(rng);
+                    break;
+                case PATTERN_SMOOTH: {
+                    double u = (double)(x / cn) / std::max(1, size.width - 1);
+                    double w = (double)y / std::max(1, size.height - 1);
+                    double s = 0.5 + 0.25 * std::sin(6.28 * fx * u + x % cn) + 0.25 * std::cos(6.28 * fy * w);
+                    v = (int)(s * 230) + byte(rng) % 8;
+                    break;
+                }
+                case PATTERN_NARROW:
+                    v = std::uniform_int_distribution<int>(lo, hi)(rng);
+                    break;
+                case PATTERN_FLAT:
+                    v = flat;
+                    break;
+                default:
+                    break;
+            }
+            row[x] = (uint8_t)std::min(255, std::max(0, v));
+        }
+    }
+    if (pattern == PATTERN_BLOCKS) {
+        img.setTo(cv::Scalar::all(byte(rng)));
+        int blocks = 4 + byte(rng) % 12;
+        for (int i = 0; i < blocks; ++i) {
+            int x0 = byte(rng) % size.width, y0 = byte(rng) % size.height;
+            int x1 = std::min(size.width, x0 + 1 + byte(rng) % size.width);
+            int y1 = std::min(size.height, y0 + 1 + byte(rng) % size.height);
+            img(cv::Rect(x0, y0, x1 - x0, y1 - y0)).setTo(cv::Scalar(byte(rng), byte(rng), byte(rng), byte(rng)));
+        }
+    }
+    return img;
+}
+
+/**
+ * @brief 一次对比的结果：参考实现和优化实现的输出，以及本次随机选取的参数（出错时打印）
+ *
+ * mask 非空时只比较其中非 0 的像素，用于排除两种实现的取整方式本身就无法确定结果的位置。
+ */
+struct VerifyPair {
+    cv::Mat reference;
+    cv::Mat optimized;
+    std::string params;
+    cv::Mat mask;
+};
+
+/**
+ * @brief 一个差分测试
+ *
+ * 每次迭代随机生成 [min_side, max_side] 内、宽高均为 align 倍数的输入，
+ * run 用同一个随机数发生器选取参数，分别调用 answer_N 和优化实现。
+ */
+struct VerifyCase {
+    std::string name;
+    int type = CV_8UC3;
+    int patterns = PATTERN_ALL;
+    int min_side = 8;
+    int max_side = 160;
+    int align = 1;
+    bool square = false;  // 只生成正方形的输入（answer_6 把宽和高弄反了）
+    Tolerance tol;
+    std::function<VerifyPair(const cv::Mat&, std::mt19937&)> run;
+};
+
+/**
+ * @brief 固定输入的黄金输出测试
+ *
+ * reference 对 input 的输出与 golden_dir/name.png（无损，要求逐位相同）或 name.jpg
+ * （answers_images/ 中原有的 JPEG，只能要求 PSNR 不低于 GOLDEN_JPEG_PSNR）比较。
+ * optimized 非空时同样与黄金输出比较，png 时允许 tol 的误差。
+ */
+struct GoldenCase {
+    std::string name;
+    std::string input;
+    std::function<cv::Mat(const cv::Mat&)> reference;
+    std::function<cv::Mat(const cv::Mat&)> optimized;
+    Tolerance tol;
+};
+
+static const double GOLDEN_JPEG_PSNR = 30.0;
+
+/**
+ * @brief 运行参数
+ */
+struct VerifyOptions {
+    std::string filter = ".*";
+    uint32_t seed = 1;
+    int iterations = 20;
+    std::string golden_dir = "answers_images";
+    bool update_golden = false;  // 用参考实现的输出重新生成 golden_dir/name.png
+    bool golden = true;
+    bool verbose = false;
+};
+
+/**
+ * @brief 第 iteration 次迭代的随机数发生器，只由种子、测试名和迭代序号决定
+ *
+ * 用 --filter 只运行一个测试时得到的输入与完整运行时相同，便于复现失败。
+ */
+inline std::mt19937 verify_rng(uint32_t seed, const std::string& name, int iteration) {
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h = (h ^ (uint8_t)c) * 16777619u;
+    }
+    std::seed_seq seq{seed, h, (uint32_t)iteration};
+    return std::mt19937(seq);
+}
+
+/**
+ * @brief 运行所有匹配的差分测试
+ *
+ * @return 失败的测试个数
+ */
+inline int verify_run(const std::vector<VerifyCase>& cases, const VerifyOptions& opt) {
+    std::regex filter(opt.filter);
+    int failed = 0;
+    std::printf("%-32s %6s %9s %10s %10s  %s\n", "case", "iters", "max_diff", "bad_ratio", "min_psnr", "result");
+    for (const VerifyCase& c : cases) {
+        if (!std::regex_search(c.name, filter)) {
+            continue;
+        }
+        int max_diff = 0;
+        double bad_ratio = 0, min_psnr = std::numeric_limits<double>::infinity();
+        bool ok = true;
+        std::string message;
+        for (int it = 0; it < opt.iterations && ok; ++it) {
+            std::mt19937 rng = verify_rng(opt.seed, c.name, it);
+            int lo = (c.min_side + c.align - 1) / c.align, hi = std::max(lo, c.max_side / c.align);
+            std::uniform_int_distribution<int> side(lo, hi);
+            cv::Size size(side(rng) * c.align, side(rng) * c.align);
+            if (c.square) {
+                size.height = size.width;
+            }
+            cv::Mat img = verify_image(rng, size, c.type, c.patterns);
+            VerifyPair pair = c.run(img, rng);
+
+            Comparison cmp = compare_images(pair.reference, pair.optimized, c.tol.max_diff, pair.mask);
+            max_diff = std::max(max_diff, cmp.max_diff);
+            bad_ratio = std::max(bad_ratio, cmp.bad_ratio);
+            min_psnr = std::min(min_psnr, cmp.psnr);
+            if (!within_tolerance(cmp, c.tol)) {
+                ok = false;
+                char buf[256];
+                if (!cmp.same_shape) {
+                    std::snprintf(buf, sizeof(buf), "iteration %d, %dx%d %s: shape %dx%dx%d vs %dx%dx%d", it,
+                                  size.width, size.height, pair.params.c_str(), pair.reference.cols,
+                                  pair.reference.rows, pair.reference.channels(), pair.optimized.cols,
+                                  pair.optimized.rows, pair.optimized.channels());
+                } else {
+                    std::snprintf(buf, sizeof(buf), "iteration %d, %dx%d %s: max diff %d at (%d, %d)", it,
+                                  size.width, size.height, pair.params.c_str(), cmp.max_diff, cmp.worst.x,
+                                  cmp.worst.y);
+                }
+                message = buf;
+            } else if (opt.verbose) {
+                std::printf("  %s #%d %dx%d %s: max diff %d, psnr %.2f\n", c.name.c_str(), it, size.width,
+                            size.height, pair.params.c_str(), cmp.max_diff, cmp.psnr);
+            }
+        }
+        failed += !ok;
+        std::printf("%-32s %6d %9d %10.5f %10.2f  %s\n", c.name.c_str(), opt.iterations, max_diff, bad_ratio, min_psnr,
+                    ok ? "ok" : "FAIL");
+        if (!ok) {
+            std::printf("  %s (rerun: --filter='^%s$' --seed=%u)\n", message.c_str(), c.name.c_str(), opt.seed);
+        }
+        std::fflush(stdout);
+    }
+    return failed;
+}
+
+inline bool file_exists(const std::string& path) { return std::ifstream(path.c_str()).good(); }
+
+/**
+ * @brief 与黄金输出比较（或在 update_golden 时重新生成）
+ *
+ * 缺少黄金输出也算失败：黄金输出随仓库提交，新增的测试先用 update_golden 生成。
+ *
+ * @return 失败的测试个数
+ */
+inline int golden_run(const std::vector<GoldenCase>& cases, const VerifyOptions& opt) {
+    std::regex filter(opt.filter);
+    int failed = 0;
+    std::printf("\n%-32s %-40s %9s %10s  %s\n", "golden", "file", "max_diff", "psnr", "result");
+    for (const GoldenCase& c : cases) {
+        if (!std::regex_search(c.name, filter)) {
+            continue;
+        }
+        cv::Mat input = cv::imread(c.input, cv::IMREAD_COLOR);
+        if (input.empty()) {
+            std::printf("%-32s cannot read input %s\n", c.name.c_str(), c.input.c_str());
+            ++failed;
+            continue;
+        }
+        cv::Mat ref = c.reference(input);
+        std::string png = opt.golden_dir + "/" + c.name + ".png", jpg = opt.golden_dir + "/" + c.name + ".jpg";
+        if (opt.update_golden) {
+            bool ok = cv::imwrite(png, ref);
+            std::printf("%-32s %-40s %9s %10s  %s\n", c.name.c_str(), png.c_str(), "", "",
+                        ok ? "written" : "WRITE FAILED");
+            failed += !ok;
+            continue;
+        }
+        bool lossless = file_exists(png);
+        std::string path = lossless ? png : jpg;
+        if (!lossless && !file_exists(jpg)) {
+            std::printf("%-32s %-40s %9s %10s  %s\n", c.name.c_str(), png.c_str(), "", "", "MISSING");
+            ++failed;
+            continue;
+        }
+        cv::Mat golden = cv::imread(path, cv::IMREAD_UNCHANGED);
+
+        Tolerance ref_tol = lossless ? tol_exact() : tol_psnr(GOLDEN_JPEG_PSNR);
+        Tolerance opt_tol = lossless ? c.tol : tol_psnr(GOLDEN_JPEG_PSNR);
+        struct {
+            const char* label;
+            cv::Mat out;
+            Tolerance tol;
+        } checks[2] = {{"reference", ref, ref_tol}, {"optimized", c.optimized ? c.optimized(input) : cv::Mat(), opt_tol}};
+        for (int i = 0; i < (c.optimized ? 2 : 1); ++i) {
+            Comparison cmp = compare_images(golden, checks[i].out, checks[i].tol.max_diff);
+            bool ok = within_tolerance(cmp, checks[i].tol);
+            failed += !ok;
+            std::string label = c.name + " (" + checks[i].label + ")";
+            if (!cmp.same_shape) {
+                std::printf("%-32s %-40s shape %dx%dx%d vs %dx%dx%d  FAIL\n", label.c_str(), path.c_str(), golden.cols,
+                            golden.rows, golden.channels(), checks[i].out.cols, checks[i].out.rows,
+                            checks[i].out.channels());
+            } else {
+                std::printf("%-32s %-40s %9d %10.2f  %s\n", label.c_str(), path.c_str(), cmp.max_diff, cmp.psnr,
+                            ok ? "ok" : "FAIL");
+            }
+        }
+        std::fflush(stdout);
+    }
+    return failed;
+}
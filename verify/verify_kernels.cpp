@@ -0,0 +1,1418 @@
+// 优化内核的正确性检查：以 answer_N 的原始实现为参考，在随机的图像、尺寸和参数上做差分测试，
+// 并把 answers_images/ 中的结果作为固定的黄金输出。
+//
+// 编译（先运行 ./build_lib.sh）：g++ verify/verify_kernels.cpp build/libimgproc.a -O2 -pthread -Iinclude -Ianswer -I/usr/local/include/opencv4 -L/usr/local/lib -lopencv_core -lopencv_imgcodecs -lopencv_highgui -o build/verify
+// 用法（在仓库根目录运行）：
+//       build/verify [--filter=正则] [--seed=N] [--iterations=N] [--golden-dir=answers_images]
+//                    [--update-golden] [--no-golden] [--verbose] [--list]
+// 有测试失败（包括缺少黄金输出）时返回 1。answers_images/answer-N.png 是参考实现在 imori.jpg 上的输出，随仓库提交，
+// 逐位比较；参考实现改变时用 --update-golden 重新生成并一起提交。没有 png 时才使用原有的有损的 jpg，只检查 PSNR。
+//
+// 没有对应优化实现，或参考实现本身有问题的 answer 不做差分测试：
+//   answer_26 的双线性插值第四项取错了像素并且会越界读取，
+//   answer_21 的 c、d 没有初始化，并且 (b - a) / (d - c) 是整数除法，
+//   answer_41 的 Sobel 结果先截断到 [0, 255]，与 gradient() 的有符号梯度不可比（answer_43 同样如此，canny() 也不与其比较，
+//   answer_44 ~ 46 的 Hough 变换因此以二值化的图像代替 Canny 的边缘作为输入）。
+// 另外 answer_9、answer_10、answer_11 只检查了左、上边界（见 with_zero_margin），answer_6 只能处理正方形图像，answer_22 对超出 [0, 255] 的结果没有截断，
+// answer_23 的直方图只有 255 个元素（像素值为 255 时越界），对应的测试限制了输入以避开这些问题，
+// answer_22、23 也不在 imori.jpg 上生成黄金输出。
+
+#include <sys/mman.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "answers.hpp"
+#include "verify.hpp"
+
+#include "batch.hpp"
+#include "color.hpp"
+#include "convolve.hpp"
+#include "histogram.hpp"
+#include "hough.hpp"
+#include "imgproc.hpp"
+#include "lut.hpp"
+#include "mapped_image.hpp"
+#include "morphology.hpp"
+#include "otsu.hpp"
+#include "pipeline.hpp"
+#include "pool.hpp"
+#include "remap.hpp"
+#include "stream.hpp"
+#include "tiled.hpp"
+#include "warp.hpp"
+
+namespace {
+
+std::string format(const char* fmt, ...) {
+    char buf[160];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return buf;
+}
+
+int uniform(std::mt19937& rng, int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); }
+
+double uniform(std::mt19937& rng, double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); }
+
+/**
+ * @brief 按 answer 的坐标约定构造 warp_affine 的正向矩阵
+ *
+ * answer_25 ~ 31 直接以像素的左上角为坐标：src = inv(dst)，warp_affine 以像素中心为坐标：
+ * src = M⁻¹(dst + 0.5) - 0.5。令 M⁻¹(y) = inv(y - 0.5) + 0.5 - shift，两者的采样位置就相差 shift。
+ * answer_25、27 四舍五入或直接插值，shift = 0；answer_28 ~ 31 用 (int) 截断，shift = 0.5。
+ *
+ * @param inv answer 使用的逆映射 src = (a * x + b * y + tx, c * x + d * y + ty)
+ */
+AffineMatrix from_answer_inverse(const AffineMatrix& inv, double shift) {
+    AffineMatrix m = inv;
+    m.tx += 0.5 - shift - (inv.a + inv.b) * 0.5;
+    m.ty += 0.5 - shift - (inv.c + inv.d) * 0.5;
+    return affine_invert(m);
+}
+
+/**
+ * @brief 最近邻采样时可以确定取哪个像素的位置
+ *
+ * warp_affine 的源坐标是 16.16 定点数，逐像素累加步长，误差约为 1 / 2000 像素；
+ * 参考实现以 double 计算，坐标恰好为整数时也可能因舍入落在任意一侧。
+ * 源坐标离取整的分界（round 为 0.5，截断为整数）不到 1 / 256 像素的位置不比较。
+ *
+ * @param boundary 分界的小数部分
+ */
+cv::Mat nearest_mask(cv::Size dsize, const AffineMatrix& inv, double boundary) {
+    auto ambiguous = [boundary](double v) {
+        double f = v - boundary - std::floor(v - boundary);
+        return f < 1.0 / 256 || f > 1 - 1.0 / 256;
+    };
+    cv::Mat mask(dsize.height, dsize.width, CV_8UC1);
+    for (int y = 0; y < dsize.height; ++y) {
+        uint8_t* row = mask.ptr<uint8_t>(y);
+        for (int x = 0; x < dsize.width; ++x) {
+            double sx = inv.a * x + inv.b * y + inv.tx, sy = inv.c * x + inv.d * y + inv.ty;
+            row[x] = ambiguous(sx) || ambiguous(sy) ? 0 : 255;
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief 把第一行、第一列置为 0
+ */
+cv::Mat zero_first_row_col(const cv::Mat& m) {
+    cv::Mat img = m.clone();
+    size_t es = img.elemSize();
+    std::memset(img.ptr<uint8_t>(0), 0, img.cols * es);
+    for (int y = 0; y < img.rows; ++y) {
+        std::memset(img.ptr<uint8_t>(y), 0, es);
+    }
+    return img;
+}
+
+/**
+ * @brief 把 m 复制到右、下方多出 margin 个 0 的缓冲区中，返回原尺寸的视图
+ *
+ * answer_9、answer_10、answer_11 的滤波只检查了左、上边界，右、下边界外会读到下一行甚至越过图像末尾。
+ * 在这样的视图上，越界的读取落在补上的 0 里，结果等价于四周补 0 的卷积。
+ */
+cv::Mat with_zero_margin(const cv::Mat& m, int margin) {
+    cv::Mat padded = cv::Mat::zeros(m.rows + margin, m.cols + margin, m.type());
+    cv::Mat view = padded(cv::Rect(0, 0, m.cols, m.rows));
+    m.copyTo(view);
+    return view;
+}
+
+PoolConfig mosaic(PoolType type) {
+    PoolConfig cfg;
+    cfg.mosaic = true;
+    cfg.type = type;
+    return cfg;
+}
+
+MorphologyConfig morph(MorphologyOp op, int iterations) {
+    MorphologyConfig cfg;
+    cfg.op = op;
+    cfg.iterations = iterations;
+    return cfg;
+}
+
+/**
+ * @brief 把 b 拼接到 a 的下方（同宽、同类型），用于一次比较流水线的多个输出
+ */
+cv::Mat stack_rows(const cv::Mat& a, const cv::Mat& b) {
+    cv::Mat out(a.rows + b.rows, a.cols, a.type());
+    cv::Mat top = out(cv::Rect(0, 0, a.cols, a.rows)), bottom = out(cv::Rect(0, a.rows, b.cols, b.rows));
+    a.copyTo(top);
+    b.copyTo(bottom);
+    return out;
+}
+
+/**
+ * @brief 把若干图像的字节依次拼接为一行 CV_8UC1，用于逐位比较 16 位或尺寸、通道数不同的多个输出
+ */
+cv::Mat concat_bytes(std::initializer_list<cv::Mat> images) {
+    size_t total = 0;
+    for (const cv::Mat& m : images) {
+        total += m.cols * m.elemSize() * m.rows;
+    }
+    cv::Mat out(1, (int)total, CV_8UC1);
+    uint8_t* p = out.ptr<uint8_t>(0);
+    for (const cv::Mat& m : images) {
+        size_t row = m.cols * m.elemSize();
+        for (int y = 0; y < m.rows; ++y, p += row) {
+            std::memcpy(p, m.ptr<uint8_t>(y), row);
+        }
+    }
+    return out;
+}
+
+void add_point_cases(std::vector<VerifyCase>& cases) {
+    VerifyCase c;
+    c.name = "01_channel_swap/color";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_1::channel_swap(m), channel_swap(m), ""};
+    };
+    cases.push_back(c);
+
+    c.name = "02_grayscale/color";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_2::BGR2GRAY(m), bgr_to_gray(m), ""};
+    };
+    cases.push_back(c);
+
+    c.name = "05_inverse_hue/color";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_5::HSV2BGR(answer_5::inverse_hue(answer_5::BGR2HSV(m))), inverse_hue(m), ""};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "03_binarize/lut_threshold";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int th = uniform(rng, 0, 255);
+        return VerifyPair{answer_3::Binarize(m, th), apply_lut(m, lut_threshold(th)), format("th=%d", th)};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "04_otsu/otsu_binarize";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_4::Binarize_Otsu(m), otsu_binarize(m), ""};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "06_decrease_color/lut_quantize";
+    c.square = true;
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_6::decrease_color(m), apply_lut(m, lut_quantize(4)), ""};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    // answer_22 用 E[x²] - m² 计算方差，接近单色的图像上会抵消成负数，只用有一定方差的输入
+    c.name = "22_hist_transform/transform_hist";
+    c.patterns = PATTERN_NOISE | PATTERN_SMOOTH | PATTERN_NARROW;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        // 选取 m0、s0，使变换后的值都在 [0, 255] 内
+        Histogram h(m);
+        double mean = h.mean(), sd = h.stddev();
+        int m0 = uniform(rng, 64, 192);
+        double k = std::min((255 - m0) / std::max(1.0, h.max_value() - mean), m0 / std::max(1.0, mean - h.min_value()));
+        int s0 = std::max(1, (int)(uniform(rng, 0.2, 1.0) * k * sd));
+        return VerifyPair{answer_22::histogram_transform(m, m0, s0), transform_hist(m, m0, s0),
+                          format("m0=%d s0=%d", m0, s0)};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "23_hist_equalize/equalize_hist";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        cv::Mat img = apply_lut(m, Lut::generate([](int v) { return std::min(v, 254); }));
+        return VerifyPair{answer_23::histogram_equalization(img), equalize_hist(img), ""};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "24_gamma/lut_gamma";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        double gc = uniform(rng, 1.0, 1.5), g = uniform(rng, 0.5, 3.0);
+        return VerifyPair{answer_24::gamma_correction(m, gc, g), apply_lut(m, lut_gamma(gc, g)),
+                          format("c=%.3f g=%.3f", gc, g)};
+    };
+    cases.push_back(c);
+}
+
+void add_pool_cases(std::vector<VerifyCase>& cases) {
+    // answer_7、answer_8 要求宽高为 8 的倍数
+    VerifyCase c;
+    c.name = "07_average_pooling/pool";
+    c.align = 8;
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_7::average_pooling(m), pool(m, mosaic(POOL_AVG)), ""};
+    };
+    cases.push_back(c);
+
+    c.name = "08_max_pooling/pool";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_8::max_pooling(m), pool(m, mosaic(POOL_MAX)), ""};
+    };
+    cases.push_back(c);
+}
+
+void add_morphology_cases(std::vector<VerifyCase>& cases) {
+    // answer_47 ~ 50 把 rows、cols 对调，只能处理正方形图像；输入先二值化。
+    // 次数取到 20，覆盖一次遍历 MORPHOLOGY_MAX_STEPS 次的分段
+    struct Op {
+        const char* name;
+        MorphologyOp op;
+        cv::Mat (*ref)(cv::Mat, int);
+    };
+    const Op ops[] = {
+        {"47_dilate/morphology", MORPHOLOGY_DILATE, answer_47::Morphology_Erode},
+        {"48_erode/morphology", MORPHOLOGY_ERODE, answer_48::Morphology_Dilate},
+        {"49_opening/morphology", MORPHOLOGY_OPEN, answer_49::Morphology_Opening},
+        {"50_closing/morphology", MORPHOLOGY_CLOSE, answer_50::Morphology_Closing},
+    };
+    for (const Op& op : ops) {
+        VerifyCase c;
+        c.name = op.name;
+        c.type = CV_8UC1;
+        c.square = true;
+        c.run = [op](const cv::Mat& m, std::mt19937& rng) {
+            int n = uniform(rng, 1, 20);
+            cv::Mat bin = apply_lut(m, lut_threshold(127));
+            return VerifyPair{op.ref(bin, n), morphology(bin, morph(op.op, n)), format("iterations=%d", n)};
+        };
+        cases.push_back(c);
+    }
+}
+
+void add_filter_cases(std::vector<VerifyCase>& cases) {
+    // 浮点核：参考实现以 double 累加后截断，convolve 用定点或 float，最多差 1
+    VerifyCase c;
+    c.name = "09_gaussian/convolve";
+    c.tol = tol_diff(1);
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        double sigma = uniform(rng, 0.5, 2.5);
+        return VerifyPair{answer_9::gaussian_filter(with_zero_margin(m, k / 2), sigma, k), convolve(m, kernel_gaussian(k, sigma)), format("k=%d sigma=%.3f", k, sigma)};
+    };
+    cases.push_back(c);
+
+    // answer_41 的高斯滤波同时支持灰度图
+    c.name = "41_gaussian/convolve_gray";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        double sigma = uniform(rng, 0.5, 2.5);
+        return VerifyPair{answer_41::gaussian_filter(m, sigma, k), convolve(m, kernel_gaussian(k, sigma)),
+                          format("k=%d sigma=%.3f", k, sigma)};
+    };
+    cases.push_back(c);
+
+    // 整数运算：结果必须逐位相同
+    c = VerifyCase();
+    c.name = "10_median_filter/median_filter";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        return VerifyPair{answer_10::median_filter(with_zero_margin(m, k / 2), k), median_filter(m, k),
+                          format("k=%d", k)};
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "11_mean_filter/convolve";
+    c.tol = tol_diff(1);
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        return VerifyPair{answer_11::mean_filter(with_zero_margin(m, k / 2), k), convolve(m, kernel_mean(k)), format("k=%d", k)};
+    };
+    cases.push_back(c);
+
+    c.name = "12_motion_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        return VerifyPair{answer_12::motion_filter(m, k), motion_filter(m, k), format("k=%d", k)};
+    };
+    cases.push_back(c);
+
+    // 整数核：结果必须逐位相同
+    c = VerifyCase();
+    c.type = CV_8UC1;
+    c.name = "13_max_min_filter/morphology";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        return VerifyPair{answer_13::max_min_filter(m, k), max_min_filter(m, k), format("k=%d", k)};
+    };
+    cases.push_back(c);
+
+    c.name = "14_diff_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        bool h = uniform(rng, 0, 1);
+        return VerifyPair{answer_14::diff_filter(m, 3, h), diff_filter(m, h), format("horizontal=%d", h)};
+    };
+    cases.push_back(c);
+
+    c.name = "15_sobel_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        bool h = uniform(rng, 0, 1);
+        return VerifyPair{answer_15::sobel_filter(m, 3, h), sobel_filter(m, h),
+                          format("horizontal=%d", h)};
+    };
+    cases.push_back(c);
+
+    c.name = "16_prewitt_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        bool h = uniform(rng, 0, 1);
+        return VerifyPair{answer_16::prewitt_filter(m, 3, h), prewitt_filter(m, h),
+                          format("horizontal=%d", h)};
+    };
+    cases.push_back(c);
+
+    c.name = "17_laplacian_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_17::laplacian_filter(m, 3), laplacian_filter(m), ""};
+    };
+    cases.push_back(c);
+
+    c.name = "18_emboss_filter/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        return VerifyPair{answer_18::emboss_filter(m, 3), emboss_filter(m), ""};
+    };
+    cases.push_back(c);
+
+    c.name = "19_log_filter/convolve";
+    c.tol = tol_diff(1);
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        double sigma = uniform(rng, 1.0, 3.0);
+        return VerifyPair{answer_19::LoG_filter(m, k, sigma), log_filter(m, k, sigma),
+                          format("k=%d sigma=%.3f", k, sigma)};
+    };
+    cases.push_back(c);
+}
+
+void add_pipeline_cases(std::vector<VerifyCase>& cases) {
+    // 流水线与逐步生成整幅中间图像的结果必须逐位相同（灰度化以 answer_2 为参考）
+    VerifyCase c;
+    c.name = "02_grayscale/pipeline";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        Pipeline p;
+        return VerifyPair{answer_2::BGR2GRAY(m), p.run(m, p.gray(p.input())), ""};
+    };
+    cases.push_back(c);
+
+    // answer_41 的前半部分：灰度 → 高斯 → 两个方向的 Sobel，两个输出共享模糊结果的行缓冲
+    c.name = "41_canny_front/pipeline";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        double sigma = uniform(rng, 0.5, 2.5);
+        Pipeline p;
+        PipelineNode blur = p.convolve(p.gray(p.input()), kernel_gaussian(k, sigma));
+        std::vector<cv::Mat> out;
+        p.run(m, {p.convolve(blur, kernel_sobel(true)), p.convolve(blur, kernel_sobel(false))}, out);
+
+        cv::Mat ref = convolve(answer_2::BGR2GRAY(m), kernel_gaussian(k, sigma));
+        return VerifyPair{stack_rows(convolve(ref, kernel_sobel(true)), convolve(ref, kernel_sobel(false))),
+                          stack_rows(out[0], out[1]), format("k=%d sigma=%.3f", k, sigma)};
+    };
+    cases.push_back(c);
+
+    // 二值化 → 开运算，与二值图的差（被开运算去掉的细节），两个输出
+    c.name = "49_opening/pipeline";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int n = uniform(rng, 1, 4), th = uniform(rng, 64, 192);
+        bool square = uniform(rng, 0, 1);
+        Pipeline p;
+        PipelineNode bin = p.lut(p.gray(p.input()), lut_threshold(th));
+        PipelineNode open = p.morphology(bin, MORPHOLOGY_OPEN, n, square);
+        std::vector<cv::Mat> out;
+        p.run(m, {open, p.combine(bin, open, COMBINE_ABSDIFF)}, out);
+
+        MorphologyConfig cfg = morph(MORPHOLOGY_OPEN, n);
+        cfg.square = square;
+        cv::Mat ref_bin = apply_lut(answer_2::BGR2GRAY(m), lut_threshold(th));
+        cv::Mat ref_open = morphology(ref_bin, cfg), diff(m.rows, m.cols, CV_8UC1);
+        for (int y = 0; y < m.rows; ++y) {
+            for (int x = 0; x < m.cols; ++x) {
+                diff.at<uint8_t>(y, x) = (uint8_t)std::abs(ref_bin.at<uint8_t>(y, x) - ref_open.at<uint8_t>(y, x));
+            }
+        }
+        return VerifyPair{stack_rows(ref_open, diff), stack_rows(out[0], out[1]),
+                          format("iterations=%d th=%d square=%d", n, th, square)};
+    };
+    cases.push_back(c);
+
+    // 彩色：均值滤波 → 两次查表（合成一张）→ 方形膨胀 → 与原图取最大值
+    c.name = "11_mean_filter/pipeline";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1;
+        double g = uniform(rng, 0.5, 3.0);
+        int levels = uniform(rng, 2, 8);
+        Pipeline p;
+        PipelineNode mapped = p.lut(p.lut(p.convolve(p.input(), kernel_mean(k)), lut_gamma(1, g)), lut_quantize(levels));
+        PipelineNode out = p.combine(p.morphology(mapped, MORPHOLOGY_DILATE, 1, true), p.input(), COMBINE_MAX);
+
+        MorphologyConfig cfg;
+        cfg.square = true;
+        cv::Mat ref = morphology(apply_lut(apply_lut(convolve(m, kernel_mean(k)), lut_gamma(1, g)), lut_quantize(levels)), cfg);
+        for (int y = 0; y < m.rows; ++y) {
+            for (int x = 0; x < m.cols * 3; ++x) {
+                ref.ptr<uint8_t>(y)[x] = std::max(ref.ptr<uint8_t>(y)[x], m.ptr<uint8_t>(y)[x]);
+            }
+        }
+        return VerifyPair{ref, p.run(m, out), format("k=%d gamma=%.3f levels=%d", k, g, levels)};
+    };
+    cases.push_back(c);
+}
+
+void add_stream_cases(std::vector<VerifyCase>& cases) {
+    // 写出两帧再读回（经过临时文件），检查第二帧，覆盖 PNM 序列中后续帧的帧头
+    struct Format {
+        const char* name;
+        StreamFormat format;
+        int type;
+        Tolerance tol;
+    };
+    // Y4M 彩色帧先转为 420 再转回，只在 2 × 2 块内颜色相同的图像上比较，剩下 YUV 量化的误差
+    const Format formats[] = {
+        {"stream/ppm", STREAM_PNM, CV_8UC3, tol_exact()},
+        {"stream/pgm", STREAM_PNM, CV_8UC1, tol_exact()},
+        {"stream/y4m_mono", STREAM_Y4M, CV_8UC1, tol_exact()},
+        {"stream/y4m_420", STREAM_Y4M, CV_8UC3, tol_diff(3)},
+    };
+    for (const Format& f : formats) {
+        VerifyCase c;
+        c.name = f.name;
+        c.type = f.type;
+        c.tol = f.tol;
+        c.align = f.format == STREAM_Y4M && f.type == CV_8UC3 ? 2 : 1;
+        c.run = [f](const cv::Mat& m, std::mt19937&) {
+            cv::Mat input = m;
+            if (f.format == STREAM_Y4M && f.type == CV_8UC3) {
+                input = m.clone();
+                for (int y = 0; y < m.rows; ++y) {
+                    for (int x = 0; x < m.cols; ++x) {
+                        input.at<cv::Vec3b>(y, x) = m.at<cv::Vec3b>(y & ~1, x & ~1);
+                    }
+                }
+            }
+            FILE* tmp = std::tmpfile();
+            FrameWriter writer;
+            writer.open(tmp, f.format);
+            writer.write(input);
+            writer.write(input);
+            writer.close();
+            std::rewind(tmp);
+            FrameReader reader;
+            cv::Mat frame;
+            reader.open(tmp);
+            reader.read(frame);
+            reader.read(frame);
+            std::fclose(tmp);
+            return VerifyPair{input, frame, ""};
+        };
+        cases.push_back(c);
+    }
+
+    // 三个阶段的流水线与按期限丢帧：只有 2 个帧缓冲，第 0 帧处理得很慢，
+    // 第 0 帧写出前、第 1 帧处理前都已超过期限而被丢弃，之后读入的帧按时写出。
+    // 比较的是 [读入, 处理, 丢弃, 停止, 写出, 写出的内容是否为第 2 帧起的各帧] 六个计数
+    VerifyCase c;
+    c.name = "stream/deadline";
+    c.type = CV_8UC1;
+    c.tol = tol_exact();
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        const int FRAMES = 6;
+        auto frame = [&](int k) {
+            cv::Mat f = m.clone();
+            f.at<uint8_t>(0, 0) = (uint8_t)k;
+            return f;
+        };
+        FILE* tmp = std::tmpfile();
+        FrameWriter writer;
+        writer.open(tmp, STREAM_PNM);
+        for (int k = 0; k < FRAMES; ++k) {
+            writer.write(frame(k));
+        }
+        writer.close();
+        std::rewind(tmp);
+
+        FrameReader reader;
+        reader.open(tmp);
+        FILE* result = std::tmpfile();
+        FrameWriter out;
+        out.open(result, STREAM_PNM);
+        StreamConfig cfg;
+        cfg.buffers = 2;
+        cfg.deadline_ms = 40;
+        int calls = 0;
+        StreamStats stats = stream_process(reader, out, [&](const cv::Mat& in, cv::Mat& dst) {
+            if (calls++ == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(120));
+            }
+            in.copyTo(dst);
+        }, cfg);
+        out.close();
+        std::fclose(tmp);
+
+        std::rewind(result);
+        FrameReader written;
+        written.open(result);
+        int count = 0, same = 1;
+        for (cv::Mat f; written.read(f); ++count) {
+            same &= compare_images(frame(count + 2), f, 0).max_diff == 0;
+        }
+        std::fclose(result);
+
+        uint8_t expected[6] = {FRAMES, FRAMES - 1, 2, 0, FRAMES - 2, 1};
+        uint8_t actual[6] = {(uint8_t)stats.frames, (uint8_t)stats.process.frames, (uint8_t)stats.dropped,
+                             (uint8_t)stats.stopped, (uint8_t)count, (uint8_t)same};
+        return VerifyPair{cv::Mat(1, 6, CV_8UC1, expected).clone(), cv::Mat(1, 6, CV_8UC1, actual).clone(),
+                          format("frames=%d processed=%d dropped=%d stopped=%d written=%d", stats.frames,
+                                 stats.process.frames, stats.dropped, stats.stopped, count)};
+    };
+    cases.push_back(c);
+
+    // 写出失败后停止：此后的帧计入 stopped 而不是 dropped，每一帧都恰好计入一类。
+    // 停止前读入了几帧取决于线程的时序，比较 [丢弃, 写出, 读入 - 停止] 三个计数
+    c.name = "stream/stop";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        FILE* tmp = std::tmpfile();
+        FrameWriter writer;
+        writer.open(tmp, STREAM_PNM);
+        for (int k = 0; k < 6; ++k) {
+            writer.write(m);
+        }
+        writer.close();
+        std::rewind(tmp);
+
+        FrameReader reader;
+        reader.open(tmp);
+        FILE* readonly = std::fopen("/dev/null", "r");
+        FrameWriter out;
+        out.open(readonly, STREAM_PNM);
+        StreamStats stats = stream_process(reader, out, [](const cv::Mat& in, cv::Mat& dst) { in.copyTo(dst); });
+        out.close();
+        std::fclose(readonly);
+        std::fclose(tmp);
+
+        uint8_t expected[3] = {0, 1, 1};
+        uint8_t actual[3] = {(uint8_t)stats.dropped, (uint8_t)stats.latency.frames,
+                             (uint8_t)(stats.frames - stats.stopped)};
+        return VerifyPair{cv::Mat(1, 3, CV_8UC1, expected).clone(), cv::Mat(1, 3, CV_8UC1, actual).clone(),
+                          format("frames=%d dropped=%d stopped=%d", stats.frames, stats.dropped, stats.stopped)};
+    };
+    cases.push_back(c);
+}
+
+/**
+ * @brief 把 m 写入临时的分块图像文件，读回由 fn 分块处理后的结果（文件随后删除）
+ */
+cv::Mat run_tiled(const cv::Mat& m, int tile, cv::Size dsize, int dtype,
+                  const std::function<void(const TiledImage&, TiledImage&)>& fn) {
+    char src_path[] = "/tmp/verify_tiled_XXXXXX", dst_path[] = "/tmp/verify_tiled_XXXXXX";
+    ::close(mkstemp(src_path));
+    ::close(mkstemp(dst_path));
+    cv::Mat out;
+    {
+        TiledImage src, dst;
+        src.create(src_path, m.cols, m.rows, m.type(), tile);
+        src.write(cv::Point(0, 0), m);
+        dst.create(dst_path, dsize.width, dsize.height, dtype, tile);
+        fn(src, dst);
+        dst.read(cv::Rect(0, 0, dsize.width, dsize.height), out);
+    }
+    std::remove(src_path);
+    std::remove(dst_path);
+    return out;
+}
+
+void add_tiled_cases(std::vector<VerifyCase>& cases) {
+    // 分块执行与整幅计算必须逐位相同；块取得较小，使图像跨越多个块
+    VerifyCase c;
+    c.name = "tiled/convolve";
+    c.max_side = 300;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int tile = 8 * uniform(rng, 1, 8), k = uniform(rng, 1, 3) * 2 + 1;
+        Kernel kernel = kernel_gaussian(k, 1.5);
+        cv::Mat out = run_tiled(m, tile, m.size(), m.type(),
+                                [&](const TiledImage& s, TiledImage& d) { tiled_convolve(s, d, kernel); });
+        return VerifyPair{convolve(m, kernel), out, format("tile=%d k=%d", tile, k)};
+    };
+    cases.push_back(c);
+
+    c.name = "tiled/morphology";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int tile = 8 * uniform(rng, 1, 8);
+        MorphologyConfig cfg = morph((MorphologyOp)uniform(rng, 0, 3), uniform(rng, 1, 6));
+        cfg.square = uniform(rng, 0, 1);
+        cv::Mat out = run_tiled(m, tile, m.size(), m.type(),
+                                [&](const TiledImage& s, TiledImage& d) { tiled_morphology(s, d, cfg); });
+        return VerifyPair{morphology(m, cfg), out,
+                          format("tile=%d op=%d iterations=%d square=%d", tile, cfg.op, cfg.iterations, cfg.square)};
+    };
+    cases.push_back(c);
+
+    c.name = "tiled/pipeline";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int tile = 8 * uniform(rng, 1, 8);
+        Pipeline p;
+        PipelineNode blur = p.convolve(p.gray(p.input()), kernel_gaussian(5, 1.4));
+        PipelineNode out = p.combine(p.morphology(p.convolve(blur, kernel_sobel(true)), MORPHOLOGY_CLOSE, 2), blur,
+                                     COMBINE_ADD);
+        cv::Mat tiled = run_tiled(m, tile, m.size(), CV_8UC1,
+                                  [&](const TiledImage& s, TiledImage& d) { tiled_pipeline(s, d, p, out); });
+        return VerifyPair{p.run(m, out), tiled, format("tile=%d halo=%d", tile, p.halo({out}))};
+    };
+    cases.push_back(c);
+
+    c.name = "tiled/resample";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int tile = 8 * uniform(rng, 1, 8);
+        ResampleFilter filter = (ResampleFilter)uniform(rng, 0, 3);
+        cv::Size dsize((int)(m.cols * uniform(rng, 0.3, 2.5)) + 1, (int)(m.rows * uniform(rng, 0.3, 2.5)) + 1);
+        cv::Mat out = run_tiled(m, tile, dsize, m.type(),
+                                [&](const TiledImage& s, TiledImage& d) { tiled_resample(s, d, filter); });
+        return VerifyPair{resample(m, dsize, filter), out,
+                          format("tile=%d filter=%d %dx%d", tile, filter, dsize.width, dsize.height)};
+    };
+    cases.push_back(c);
+}
+
+void add_mapped_cases(std::vector<VerifyCase>& cases) {
+    // 写入临时文件后重新映射，零拷贝视图（PPM 与平面存储经 bgr() 转换）必须与原图逐位相同
+    struct Format {
+        const char* name;
+        int type;
+        bool pnm, planar;
+    };
+    const Format formats[] = {
+        {"mapped/interleaved", CV_8UC3, false, false},
+        {"mapped/planar", CV_8UC3, false, true},
+        {"mapped/ppm", CV_8UC3, true, false},
+        {"mapped/pgm", CV_8UC1, true, false},
+    };
+    for (const Format& f : formats) {
+        VerifyCase c;
+        c.name = f.name;
+        c.type = f.type;
+        c.run = [f](const cv::Mat& m, std::mt19937&) {
+            char path[] = "/tmp/verify_mapped_XXXXXX";
+            ::close(mkstemp(path));
+            if (f.pnm) {
+                save_pnm(path, m);
+            } else {
+                save_mapped_image(path, m, f.planar);
+            }
+            cv::Mat out;
+            {
+                MappedImage image;
+                image.open(path);
+                out = image.bgr().clone();
+            }
+            std::remove(path);
+            return VerifyPair{m, out, ""};
+        };
+        cases.push_back(c);
+    }
+
+    // 构造的文件头：stride × height、plane_bytes × planes 回绕成很小的值，PNM 的宽度超出 int，都必须拒绝
+    VerifyCase c;
+    c.name = "mapped/crafted";
+    c.type = CV_8UC3;
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        char path[] = "/tmp/verify_mapped_XXXXXX";
+        ::close(mkstemp(path));
+        std::streambuf* log = std::cerr.rdbuf(nullptr);  // 预期的格式错误信息不输出
+        auto rejected = [&](bool planar, size_t field, uint64_t value) {
+            save_mapped_image(path, m, planar);
+            FILE* f = std::fopen(path, "r+b");
+            std::fseek(f, (long)field, SEEK_SET);
+            std::fwrite(&value, sizeof(value), 1, f);
+            std::fclose(f);
+            MappedImage image;
+            return !image.open(path);
+        };
+        uint8_t expected[3] = {1, 1, 1};
+        uint8_t actual[3] = {
+            (uint8_t)rejected(false, offsetof(MappedImageHeader, stride), UINT64_MAX / (uint64_t)m.rows + 1),
+            (uint8_t)rejected(true, offsetof(MappedImageHeader, plane_bytes), UINT64_MAX / 3 + 1),
+        };
+        FILE* f = std::fopen(path, "wb");
+        std::fputs("P5 99999999999 1 255\n", f);
+        std::fwrite(m.data, 1, m.cols, f);
+        std::fclose(f);
+        MappedImage image;
+        actual[2] = !image.open(path);
+        std::cerr.rdbuf(log);
+        std::remove(path);
+        return VerifyPair{cv::Mat(1, 3, CV_8UC1, expected).clone(), cv::Mat(1, 3, CV_8UC1, actual).clone(), ""};
+    };
+    cases.push_back(c);
+}
+
+void add_batch_cases(std::vector<VerifyCase>& cases) {
+    // 文字描述的处理链（连续的逐行运算融合为一个 Pipeline）与逐个调用整幅图像的函数结果必须逐位相同
+    VerifyCase c;
+    c.name = "batch/chain";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int k = uniform(rng, 1, 3) * 2 + 1, th = uniform(rng, 32, 160), n = uniform(rng, 1, 3);
+        double sigma = uniform(rng, 0.5, 2.5);
+        OperatorChain chain;
+        chain.parse(format("gray,gauss:%.3f:%d,sobel:v,threshold:%d,close:%d,equalize,gamma:1.5", sigma, k, th, n));
+
+        cv::Mat blurred = convolve(answer_2::BGR2GRAY(m), kernel_gaussian(k, std::atof(format("%.3f", sigma).c_str())));
+        cv::Mat ref = morphology(apply_lut(convolve(blurred, kernel_sobel(false)), lut_threshold(th)),
+                                 morph(MORPHOLOGY_CLOSE, n));
+        ref = apply_lut(equalize_hist(ref), lut_gamma(1, 1.5));
+
+        // 以 hough 结束的处理链：边缘图转为 BGR 后画上票数最多的 n 条直线
+        int lines = uniform(rng, 2, 40);
+        OperatorChain hough_chain;
+        hough_chain.parse(format("gray,gauss:%.3f:%d,canny,hough:%d", sigma, k, lines));
+        cv::Mat edge = canny(blurred);
+        HoughSpace space;
+        hough_vote(edge, space);
+        cv::Mat drawn;
+        cv::merge(std::vector<cv::Mat>{edge, edge, edge}, drawn);
+        hough_draw(drawn, hough_peaks(space, lines));
+        return VerifyPair{concat_bytes({ref, drawn}), concat_bytes({chain.run(m), hough_chain.run(m)}),
+                          chain.describe() + " | " + hough_chain.describe()};
+    };
+    cases.push_back(c);
+
+    // 两个目录中的同名文件写到同一个输出：第二个计入 failed，第一个的结果不被覆盖；
+    // 处理线程多于预读槽时其余文件照常处理
+    c = VerifyCase();
+    c.name = "batch/collision";
+    c.run = [](const cv::Mat& m, std::mt19937&) {
+        char dir[] = "/tmp/verify_batch_XXXXXX";
+        std::string root = mkdtemp(dir);
+        namespace fs = std::filesystem;
+        fs::create_directories(root + "/a");
+        fs::create_directories(root + "/b");
+        std::vector<std::string> files = {root + "/a/same.ppm", root + "/b/same.ppm"};
+        for (int i = 0; i < 4; ++i) {
+            files.push_back(root + format("/a/%d.ppm", i));
+        }
+        cv::Mat flipped = answer_1::channel_swap(m);
+        for (size_t i = 0; i < files.size(); ++i) {
+            save_pnm(files[i], i == 1 ? flipped : m);
+        }
+
+        OperatorChain chain;
+        chain.parse("gray");
+        BatchConfig cfg;
+        cfg.output_dir = root + "/out";
+        cfg.format = "pgm";
+        cfg.workers = 4;
+        cfg.prefetch = 1;
+        std::streambuf* log = std::cerr.rdbuf(nullptr);  // 预期的重名信息不输出
+        BatchStats stats = batch_process(files, chain, cfg);
+        std::cerr.rdbuf(log);
+        cv::Mat out;
+        {
+            MappedImage image;
+            image.open(cfg.output_dir + "/same.pgm");
+            out = image.bgr().clone();
+        }
+        fs::remove_all(root);
+
+        // 第一行的前两个像素为成功、失败的文件数，其余为第一个 same.ppm 的结果
+        cv::Mat expected = cv::Mat::zeros(1, m.cols, CV_8UC1), actual = expected.clone();
+        expected.at<uint8_t>(0, 0) = 5;
+        expected.at<uint8_t>(0, 1) = 1;
+        actual.at<uint8_t>(0, 0) = (uint8_t)stats.files;
+        actual.at<uint8_t>(0, 1) = (uint8_t)stats.failed;
+        if (out.size() != m.size()) {
+            out = cv::Mat::zeros(m.size(), CV_8UC1);
+        }
+        return VerifyPair{stack_rows(expected, chain.run(m)), stack_rows(actual, out),
+                          format("files=%d failed=%d", stats.files, stats.failed)};
+    };
+    cases.push_back(c);
+}
+
+/**
+ * @brief 依次切换到 cpu_detect() 以内的每个版本运行 run，与头文件内核的结果 expected 比较
+ *
+ * 各版本的输出自上而下拼接（第 y / expected.rows 个版本），参考输出是 expected 重复同样的次数；
+ * 某个版本的尺寸或类型不同时直接比较该版本的输出。结束后恢复原来的版本。
+ */
+VerifyPair each_cpu_level(const cv::Mat& expected, const std::function<cv::Mat()>& run, const std::string& params) {
+    imgproc::CpuLevel saved = imgproc::cpu_level();
+    cv::Mat ref, out;
+    for (int level = imgproc::CPU_BASELINE; level <= imgproc::cpu_detect(); ++level) {
+        imgproc::set_cpu_level((imgproc::CpuLevel)level);
+        cv::Mat m = run();
+        if (m.size() != expected.size() || m.type() != expected.type()) {
+            ref = expected;
+            out = m;
+            break;
+        }
+        ref = ref.empty() ? expected : stack_rows(ref, expected);
+        out = out.empty() ? m : stack_rows(out, m);
+    }
+    imgproc::set_cpu_level(saved);
+    return VerifyPair{ref, out, params + " up to " + imgproc::cpu_level_name(imgproc::cpu_detect())};
+}
+
+/**
+ * @brief 随机转换为单通道，覆盖各内核单通道、多通道的两种路径
+ */
+cv::Mat maybe_gray(const cv::Mat& m, std::mt19937& rng) { return uniform(rng, 0, 1) ? bgr_to_gray(m) : m; }
+
+void add_imgproc_cases(std::vector<VerifyCase>& cases) {
+    // libimgproc 的每个入口在每个可用的指令集版本上都必须与同名的头文件函数逐位相同
+    VerifyCase c;
+    c.name = "imgproc/apply_lut";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        double g = uniform(rng, 0.5, 3.0);
+        Lut lut = lut_gamma(1, g);
+        return each_cpu_level(
+            apply_lut(img, lut),
+            [&] {
+                cv::Mat out;
+                imgproc::apply_lut(img, out, lut);
+                return out;
+            },
+            format("g=%.3f cn=%d", g, img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/apply_lut_channels";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int th = uniform(rng, 0, 255), levels = uniform(rng, 2, 8);
+        ChannelLut lut(lut_threshold(th), lut_quantize(levels), lut_gamma(1, 2.2));
+        return each_cpu_level(
+            apply_lut(m, lut),
+            [&] {
+                cv::Mat out;
+                imgproc::apply_lut(m, out, lut);
+                return out;
+            },
+            format("th=%d levels=%d", th, levels));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/equalize_hist";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        return each_cpu_level(
+            equalize_hist(img),
+            [&] {
+                cv::Mat out;
+                imgproc::equalize_hist(img, out);
+                return out;
+            },
+            format("cn=%d", img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/clahe";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        ClaheConfig cfg;
+        cfg.tiles_x = uniform(rng, 1, 8);
+        cfg.tiles_y = uniform(rng, 1, 8);
+        cfg.clip_limit = uniform(rng, 0.0, 4.0);
+        cfg.mode = uniform(rng, 0, 1) ? CLAHE_LUMINANCE : CLAHE_PER_CHANNEL;
+        cv::Mat expected;
+        clahe(img, expected, cfg);
+        return each_cpu_level(
+            expected,
+            [&] {
+                cv::Mat out;
+                imgproc::clahe(img, out, cfg);
+                return out;
+            },
+            format("tiles=%dx%d clip=%.3f mode=%d cn=%d", cfg.tiles_x, cfg.tiles_y, cfg.clip_limit, (int)cfg.mode,
+                   img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/convolve";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        // 整数权重走 int16 路径，小数权重走 float 路径
+        bool integer = uniform(rng, 0, 1);
+        Kernel kernel(uniform(rng, 1, 3) * 2 + 1, uniform(rng, 1, 3) * 2 + 1);
+        for (double& w : kernel.w) {
+            w = integer ? uniform(rng, -2, 2) : uniform(rng, -0.5, 0.5);
+        }
+        // 库内的线程数上限只改变分段方式，结果不变
+        int threads = uniform(rng, 0, 3);
+        imgproc::set_thread_limit(threads);
+        VerifyPair pair = each_cpu_level(
+            convolve(img, kernel),
+            [&] {
+                cv::Mat out;
+                imgproc::convolve(img, out, kernel);
+                return out;
+            },
+            format("%dx%d integer=%d threads=%d cn=%d", kernel.rows, kernel.cols, (int)integer, threads,
+                   img.channels()));
+        imgproc::set_thread_limit(0);
+        return pair;
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "imgproc/gradient";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        GradientConfig cfg;
+        cfg.kernel = uniform(rng, 0, 1) ? GRAD_CENTRAL : GRAD_SOBEL;
+        cfg.norm = uniform(rng, 0, 1) ? GRAD_L1 : GRAD_L2;
+        cfg.reflect = uniform(rng, 0, 1);
+        cfg.bins = uniform(rng, 1, 12);
+        cfg.centered = uniform(rng, 0, 1);
+        const int all = GRAD_X | GRAD_Y | GRAD_MAGNITUDE | GRAD_ORIENTATION;
+        GradientImages g = gradient(m, all, cfg);
+        return each_cpu_level(
+            concat_bytes({g.gx, g.gy, g.magnitude, g.orientation}),
+            [&] {
+                GradientImages out;
+                imgproc::gradient(m, out, all, cfg);
+                return concat_bytes({out.gx, out.gy, out.magnitude, out.orientation});
+            },
+            format("kernel=%d norm=%d reflect=%d bins=%d centered=%d", (int)cfg.kernel, (int)cfg.norm,
+                   (int)cfg.reflect, cfg.bins, (int)cfg.centered));
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "imgproc/pool";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        PoolConfig cfg;
+        cfg.kernel = uniform(rng, 1, 3) == 1 ? 8 : uniform(rng, 1, 9);
+        cfg.stride = uniform(rng, 0, cfg.kernel);
+        cfg.pad = uniform(rng, 0, cfg.kernel - 1);
+        cfg.type = uniform(rng, 0, 1) ? POOL_MAX : POOL_AVG;
+        cfg.mosaic = uniform(rng, 0, 1);
+        cfg.ceil_mode = uniform(rng, 0, 1);
+        return each_cpu_level(
+            pool(img, cfg),
+            [&] {
+                cv::Mat out;
+                imgproc::pool(img, out, cfg);
+                return out;
+            },
+            format("k=%d s=%d pad=%d type=%d mosaic=%d ceil=%d cn=%d", cfg.kernel, cfg.stride, cfg.pad,
+                   (int)cfg.type, (int)cfg.mosaic, (int)cfg.ceil_mode, img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/resample";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        cv::Size size(uniform(rng, 1, 200), uniform(rng, 1, 200));
+        ResampleFilter filter = (ResampleFilter)uniform(rng, RESAMPLE_BILINEAR, RESAMPLE_LANCZOS3);
+        bool antialias = uniform(rng, 0, 1);
+        return each_cpu_level(
+            resample(img, size, filter, antialias),
+            [&] {
+                cv::Mat out;
+                imgproc::resample(img, out, size, filter, antialias);
+                return out;
+            },
+            format("%dx%d filter=%d antialias=%d cn=%d", size.width, size.height, (int)filter, (int)antialias,
+                   img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/warp_affine";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        double theta = uniform(rng, -180.0, 180.0);
+        AffineMatrix a = affine_rotation(theta, m.cols / 2.0, m.rows / 2.0);
+        double scale = uniform(rng, 0.5, 2.0);
+        a.a *= scale;
+        a.b *= scale;
+        a.c *= scale;
+        a.d *= scale;
+        cv::Size dsize(uniform(rng, 8, 200), uniform(rng, 8, 200));
+        WarpInterp interp = (WarpInterp)uniform(rng, WARP_NEAREST, WARP_BICUBIC);
+        uint8_t border = (uint8_t)uniform(rng, 0, 255);
+        return each_cpu_level(
+            warp_affine(img, a, dsize, interp, border),
+            [&] {
+                cv::Mat out;
+                imgproc::warp_affine(img, out, a, dsize, interp, border);
+                return out;
+            },
+            format("theta=%.3f scale=%.3f interp=%d cn=%d", theta, scale, (int)interp, img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/warp_perspective";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        cv::Point2f src[4] = {{0, 0}, {(float)m.cols, 0}, {(float)m.cols, (float)m.rows}, {0, (float)m.rows}};
+        cv::Point2f dst[4];
+        for (int i = 0; i < 4; ++i) {
+            float j = 0.2f * (m.cols + m.rows);
+            dst[i] = cv::Point2f(src[i].x + (float)uniform(rng, -j, j), src[i].y + (float)uniform(rng, -j, j));
+        }
+        Homography H = homography_from_points(src, dst);
+        WarpInterp interp = (WarpInterp)uniform(rng, WARP_NEAREST, WARP_BICUBIC);
+        uint8_t border = (uint8_t)uniform(rng, 0, 255);
+        return each_cpu_level(
+            warp_perspective(img, H, m.size(), interp, border),
+            [&] {
+                cv::Mat out;
+                imgproc::warp_perspective(img, out, H, m.size(), interp, border);
+                return out;
+            },
+            format("interp=%d cn=%d", (int)interp, img.channels()));
+    };
+    cases.push_back(c);
+
+    c.name = "imgproc/remap";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        cv::Mat img = maybe_gray(m, rng);
+        double amp = uniform(rng, 0.0, 8.0), freq = uniform(rng, 0.02, 0.3);
+        RemapTable table(m.size(), m.size(), [&](double x, double y, double& u, double& v) {
+            u = x + amp * std::sin(y * freq);
+            v = y + amp * std::cos(x * freq);
+            return true;
+        });
+        uint8_t border = (uint8_t)uniform(rng, 0, 255);
+        return each_cpu_level(
+            table.apply(img, border),
+            [&] {
+                cv::Mat out;
+                imgproc::remap(img, out, table, border);
+                return out;
+            },
+            format("amp=%.3f freq=%.3f cn=%d", amp, freq, img.channels()));
+    };
+    cases.push_back(c);
+
+    c = VerifyCase();
+    c.name = "imgproc/sauvola_binarize";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        SauvolaConfig cfg;
+        cfg.window = uniform(rng, 0, 20) * 2 + 1;
+        cfg.k = uniform(rng, 0.1, 0.5);
+        return each_cpu_level(
+            sauvola_binarize(m, cfg),
+            [&] {
+                cv::Mat out;
+                imgproc::sauvola_binarize(m, out, cfg);
+                return out;
+            },
+            format("window=%d k=%.3f", cfg.window, cfg.k));
+    };
+    cases.push_back(c);
+}
+
+void add_geometry_cases(std::vector<VerifyCase>& cases) {
+    VerifyCase c;
+    c.name = "25_nearest/warp_affine";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        double rx = uniform(rng, 0.5, 1.9), ry = uniform(rng, 0.5, 1.9);
+        cv::Size dsize((int)(m.cols * rx), (int)(m.rows * ry));
+        AffineMatrix inv{1 / rx, 0, 0, 1 / ry, 0, 0};
+        return VerifyPair{answer_25::nearest_neighbor(m, rx, ry),
+                          warp_affine(m, from_answer_inverse(inv, 0), dsize, WARP_NEAREST),
+                          format("rx=%.3f ry=%.3f", rx, ry), nearest_mask(dsize, inv, 0.5)};
+    };
+    cases.push_back(c);
+
+    // answer_27 把越界的 tap 截断到边缘后，用截断后的位置计算权重，与 warp_affine 复制边缘像素不同，
+    // 只比较 4 × 4 邻域都在图像内的部分。插值权重是 Q10 定点数、小数部分只取 8 bit，
+    // 噪声图像上个别像素会差 2 ~ 3，另外要求 PSNR 不低于 45 dB
+    c.name = "27_bicubic/warp_affine";
+    c.tol = tol_diff(1, 0.05);
+    c.tol.min_psnr = 45;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        double rx = uniform(rng, 0.6, 2.5), ry = uniform(rng, 0.6, 2.5);
+        cv::Mat ref = answer_27::bicubic(m, rx, ry);
+        cv::Mat opt =
+            warp_affine(m, from_answer_inverse(AffineMatrix{1 / rx, 0, 0, 1 / ry, 0, 0}, 0), ref.size(), WARP_BICUBIC);
+        int x0 = (int)std::ceil(rx), x1 = std::min(ref.cols, (int)std::ceil((m.cols - 2) * rx));
+        int y0 = (int)std::ceil(ry), y1 = std::min(ref.rows, (int)std::ceil((m.rows - 2) * ry));
+        cv::Rect inner(x0, y0, x1 - x0, y1 - y0);
+        return VerifyPair{ref(inner).clone(), opt(inner).clone(), format("rx=%.3f ry=%.3f", rx, ry)};
+    };
+    cases.push_back(c);
+
+    // answer_28 ~ 31 把 (-1, 0) 内的源坐标截断为 0，warp_affine 在那里填充边界值 0，
+    // 输入的第一行、第一列置 0 后两者一致
+    c = VerifyCase();
+    c.name = "28_translate/warp_affine";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int tx = uniform(rng, -m.cols, m.cols), ty = uniform(rng, -m.rows, m.rows);
+        return VerifyPair{answer_28::affine(m, 1, 0, 0, 1, tx, ty),
+                          warp_affine(m, AffineMatrix{1, 0, 0, 1, (double)tx, (double)ty}, m.size(), WARP_NEAREST),
+                          format("tx=%d ty=%d", tx, ty)};
+    };
+    cases.push_back(c);
+
+    c.name = "29_scale/warp_affine";
+    c.run = [](const cv::Mat& src, std::mt19937& rng) {
+        cv::Mat m = zero_first_row_col(src);
+        double a = uniform(rng, 0.5, 2.0), d = uniform(rng, 0.5, 2.0);
+        int tx = uniform(rng, -m.cols / 2, m.cols / 2), ty = uniform(rng, -m.rows / 2, m.rows / 2);
+        cv::Size dsize((int)(m.cols * a), (int)(m.rows * d));
+        AffineMatrix inv{1 / a, 0, 0, 1 / d, (double)-tx, (double)-ty};
+        return VerifyPair{answer_29::affine(m, a, 0, 0, d, tx, ty),
+                          warp_affine(m, from_answer_inverse(inv, 0.5), dsize, WARP_NEAREST),
+                          format("a=%.3f d=%.3f tx=%d ty=%d", a, d, tx, ty), nearest_mask(dsize, inv, 0)};
+    };
+    cases.push_back(c);
+
+    c.name = "30_rotate/warp_affine";
+    c.run = [](const cv::Mat& src, std::mt19937& rng) {
+        cv::Mat m = zero_first_row_col(src);
+        double theta = uniform(rng, -180.0, 180.0);
+        AffineMatrix inv = affine_invert(affine_rotation(theta, m.cols / 2.0, m.rows / 2.0));
+        return VerifyPair{answer_30::affine(m, 1, 0, 0, 1, 0, 0, theta),
+                          warp_affine(m, from_answer_inverse(inv, 0.5), m.size(), WARP_NEAREST),
+                          format("theta=%.3f", theta), nearest_mask(m.size(), inv, 0)};
+    };
+    cases.push_back(c);
+
+    // answer_31 的逆映射没有除以行列式（用的是倾斜之前的 det = 1），这里按它实际的逆映射构造
+    c.name = "31_skew/warp_affine";
+    c.run = [](const cv::Mat& src, std::mt19937& rng) {
+        cv::Mat m = zero_first_row_col(src);
+        int dx = uniform(rng, 0, 40), dy = uniform(rng, 0, 40);
+        cv::Size dsize(m.cols + dx, m.rows + dy);
+        AffineMatrix inv{1, -(double)dx / m.rows, -(double)dy / m.cols, 1, 0, 0};
+        return VerifyPair{answer_31::affine(m, 1, 0, 0, 1, 0, 0, 0, dx, dy),
+                          warp_affine(m, from_answer_inverse(inv, 0.5), dsize, WARP_NEAREST),
+                          format("dx=%d dy=%d", dx, dy), nearest_mask(dsize, inv, 0)};
+    };
+    cases.push_back(c);
+
+    // 源图超过 2 GB（rows × step > 2³¹）时 SIMD 路径的 32 bit gather 偏移会回绕：
+    // 3 行、每行 2³⁰ 字节的视图（只有用到的页占内存）与紧凑的拷贝结果必须逐位相同
+    c = VerifyCase();
+    c.name = "remap/large_source";
+    c.type = CV_8UC1;
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        const size_t step = (size_t)1 << 30, bytes = 3 * step;
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        CV_Assert(p != MAP_FAILED);
+        cv::Mat large(3, m.cols, CV_8UC1, p, step);
+        m(cv::Rect(0, 0, m.cols, 3)).copyTo(large);
+        cv::Mat compact = large.clone();
+
+        double sx = uniform(rng, 0.3, 1.5), sy = uniform(rng, 0.01, 0.05);
+        RemapTable table(large.size(), m.size(), [&](double x, double y, double& u, double& v) {
+            u = x * sx;
+            v = y * sy;
+            return true;
+        });
+        cv::Mat ref = table.apply(compact), out = table.apply(large);
+        munmap(p, bytes);
+        return VerifyPair{ref, out, format("sx=%.3f sy=%.3f", sx, sy)};
+    };
+    cases.push_back(c);
+}
+
+void add_hough_cases(std::vector<VerifyCase>& cases) {
+    // answer_44 ~ 46：投票、非极大值抑制、把前 30 条直线画到黑色图像上
+    VerifyCase c;
+    c.type = CV_8UC1;
+    c.name = "46_hough_line/hough";
+    c.run = [](const cv::Mat& m, std::mt19937& rng) {
+        int th = uniform(rng, 128, 250);
+        cv::Mat edge = apply_lut(m, lut_threshold(th));
+
+        std::unique_ptr<answer_46::struct_hough_table> table(new answer_46::struct_hough_table());
+        *table = answer_46::Hough_NMS(answer_46::Hough_vote(*table, edge));
+        cv::Mat ref = answer_46::Hough_inverse(*table, cv::Mat::zeros(m.rows, m.cols, CV_8UC3));
+
+        HoughSpace space;
+        hough_vote(edge, space);
+        cv::Mat out = cv::Mat::zeros(m.rows, m.cols, CV_8UC3);
+        hough_draw(out, hough_peaks(space, 30));
+        return VerifyPair{ref, out, format("th=%d", th)};
+    };
+    cases.push_back(c);
+}
+
+/**
+ * @brief 各 answer 的 main 在 imori.jpg 上的处理流程
+ *
+ * answer_9、10、19、24 原本读取仓库中没有的 imori_noise.jpg 等图像，这里同样用 imori.jpg。
+ */
+void add_golden_cases(std::vector<GoldenCase>& cases) {
+    const std::string input = "imori.jpg";
+    auto golden = [&](const std::string& name, std::function<cv::Mat(const cv::Mat&)> ref,
+                      std::function<cv::Mat(const cv::Mat&)> opt = nullptr, Tolerance tol = Tolerance()) {
+        cases.push_back(GoldenCase{name, input, ref, opt, tol});
+    };
+    auto gray2 = [](const cv::Mat& m) { return answer_2::BGR2GRAY(m); };
+
+    golden("answer-1", [](const cv::Mat& m) { return answer_1::channel_swap(m); },
+           [](const cv::Mat& m) { return channel_swap(m); });
+    golden("answer-2", gray2, [](const cv::Mat& m) { return bgr_to_gray(m); });
+    golden("answer-3", [&](const cv::Mat& m) { return answer_3::Binarize(answer_3::BGR2GRAY(m), 128); },
+           [&](const cv::Mat& m) { return apply_lut(gray2(m), lut_threshold(128)); });
+    golden("answer-4", [](const cv::Mat& m) { return answer_4::Binarize_Otsu(answer_4::BGR2GRAY(m)); },
+           [&](const cv::Mat& m) { return otsu_binarize(gray2(m)); });
+    golden("answer-5", [](const cv::Mat& m) {
+        return answer_5::HSV2BGR(answer_5::inverse_hue(answer_5::BGR2HSV(m)));
+    }, [](const cv::Mat& m) { return inverse_hue(m); });
+    golden("answer-6", [](const cv::Mat& m) { return answer_6::decrease_color(m); },
+           [](const cv::Mat& m) { return apply_lut(m, lut_quantize(4)); });
+    golden("answer-7", [](const cv::Mat& m) { return answer_7::average_pooling(m); },
+           [](const cv::Mat& m) { return pool(m, mosaic(POOL_AVG)); });
+    golden("answer-8", [](const cv::Mat& m) { return answer_8::max_pooling(m); },
+           [](const cv::Mat& m) { return pool(m, mosaic(POOL_MAX)); });
+    golden("answer-9", [](const cv::Mat& m) { return answer_9::gaussian_filter(with_zero_margin(m, 1), 1.3, 3); },
+           [](const cv::Mat& m) { return convolve(m, kernel_gaussian(3, 1.3)); }, tol_diff(1));
+    golden("answer-10", [](const cv::Mat& m) { return answer_10::median_filter(with_zero_margin(m, 1), 3); },
+           [](const cv::Mat& m) { return median_filter(m, 3); });
+    golden("answer-11", [](const cv::Mat& m) { return answer_11::mean_filter(with_zero_margin(m, 1), 3); },
+           [](const cv::Mat& m) { return convolve(m, kernel_mean(3)); }, tol_diff(1));
+    golden("answer-12", [](const cv::Mat& m) { return answer_12::motion_filter(m, 3); },
+           [](const cv::Mat& m) { return motion_filter(m, 3); }, tol_diff(1));
+    golden("answer-13", [](const cv::Mat& m) { return answer_13::max_min_filter(answer_13::BGR2GRAY(m), 3); },
+           [&](const cv::Mat& m) { return max_min_filter(gray2(m), 3); });
+    for (bool h : {false, true}) {
+        const char* dir = h ? "_h" : "_v";
+        golden(std::string("answer-14") + dir,
+               [h](const cv::Mat& m) { return answer_14::diff_filter(answer_14::BGR2GRAY(m), 3, h); },
+               [=](const cv::Mat& m) { return diff_filter(gray2(m), h); });
+        golden(std::string("answer-15") + dir,
+               [h](const cv::Mat& m) { return answer_15::sobel_filter(answer_15::BGR2GRAY(m), 3, h); },
+               [=](const cv::Mat& m) { return sobel_filter(gray2(m), h); });
+        golden(std::string("answer-16") + dir,
+               [h](const cv::Mat& m) { return answer_16::prewitt_filter(answer_16::BGR2GRAY(m), 3, h); },
+               [=](const cv::Mat& m) { return prewitt_filter(gray2(m), h); });
+    }
+    golden("answer-17", [](const cv::Mat& m) { return answer_17::laplacian_filter(answer_17::BGR2GRAY(m), 3); },
+           [&](const cv::Mat& m) { return laplacian_filter(gray2(m)); });
+    golden("answer-18", [](const cv::Mat& m) { return answer_18::emboss_filter(answer_18::BGR2GRAY(m), 3); },
+           [&](const cv::Mat& m) { return emboss_filter(gray2(m)); });
+    golden("answer-19", [](const cv::Mat& m) { return answer_19::LoG_filter(answer_19::BGR2GRAY(m), 5, 3); },
+           [&](const cv::Mat& m) { return log_filter(gray2(m), 5, 3); }, tol_diff(1));
+    golden("answer-24", [](const cv::Mat& m) { return answer_24::gamma_correction(m, 1, 2.2); },
+           [](const cv::Mat& m) { return apply_lut(m, lut_gamma(1, 2.2)); });
+    golden("answer-25", [](const cv::Mat& m) { return answer_25::nearest_neighbor(m, 1.5, 1.5); });
+    golden("answer-27", [](const cv::Mat& m) { return answer_27::bicubic(m, 1.5, 1.5); });
+    golden("answer-28", [](const cv::Mat& m) { return answer_28::affine(m, 1, 0, 0, 1, 30, -30); },
+           [](const cv::Mat& m) { return warp_affine(m, AffineMatrix{1, 0, 0, 1, 30, -30}, m.size(), WARP_NEAREST); });
+    golden("answer-29", [](const cv::Mat& m) { return answer_29::affine(m, 1.3, 0, 0, 0.8, 30, -30); });
+    golden("answer-30", [](const cv::Mat& m) { return answer_30::affine(m, 1, 0, 0, 1, 0, 0, -30); });
+    golden("answer-31", [](const cv::Mat& m) { return answer_31::affine(m, 1, 0, 0, 1, 0, 0, 0, 30, 30); });
+
+    // 以下固定处理 128 × 128 的图像（imori.jpg 正好是这个尺寸）
+    golden("answer-32", [](const cv::Mat& m) {
+        std::unique_ptr<answer_32::fourier_str> f(new answer_32::fourier_str());
+        *f = answer_32::dft(answer_32::BGR2GRAY(m), *f);
+        return answer_32::idft(cv::Mat::zeros(128, 128, CV_8UC1), *f);
+    });
+    golden("answer-36", [](const cv::Mat& m) {
+        std::unique_ptr<answer_36::dct_str> d(new answer_36::dct_str());
+        *d = answer_36::dct(m, *d);
+        return answer_36::idct(cv::Mat::zeros(128, 128, CV_8UC3), *d);
+    });
+    golden("answer-38", [](const cv::Mat& m) {
+        std::unique_ptr<answer_38::dct_str> d(new answer_38::dct_str());
+        *d = answer_38::quantization(answer_38::dct(m, *d));
+        return answer_38::idct(cv::Mat::zeros(128, 128, CV_8UC3), *d);
+    });
+    golden("answer-43", [](const cv::Mat& m) { return answer_43::Canny(m); });
+
+    auto otsu = [](const cv::Mat& m) { return answer_47::Binarize_Otsu(answer_47::BGR2GRAY(m)); };
+    golden("answer-47", [=](const cv::Mat& m) { return answer_47::Morphology_Erode(otsu(m), 2); },
+           [=](const cv::Mat& m) { return morphology(otsu(m), morph(MORPHOLOGY_DILATE, 2)); });
+    golden("answer-48", [=](const cv::Mat& m) { return answer_48::Morphology_Dilate(otsu(m), 2); },
+           [=](const cv::Mat& m) { return morphology(otsu(m), morph(MORPHOLOGY_ERODE, 2)); });
+    golden("answer-49", [=](const cv::Mat& m) { return answer_49::Morphology_Opening(otsu(m), 1); },
+           [=](const cv::Mat& m) { return morphology(otsu(m), morph(MORPHOLOGY_OPEN, 1)); });
+    golden("answer-50", [](const cv::Mat& m) { return answer_50::Morphology_Closing(answer_50::Canny(m), 1); },
+           [](const cv::Mat& m) { return morphology(answer_50::Canny(m), morph(MORPHOLOGY_CLOSE, 1)); });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    VerifyOptions opt;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* key) -> const char* {
+            size_t n = std::strlen(key);
+            return arg.compare(0, n, key) == 0 ? arg.c_str() + n : nullptr;
+        };
+        if (const char* v = value("--filter=")) {
+            opt.filter = v;
+        } else if (const char* v = value("--seed=")) {
+            opt.seed = (uint32_t)std::strtoul(v, nullptr, 10);
+        } else if (const char* v = value("--iterations=")) {
+            opt.iterations = std::atoi(v);
+        } else if (const char* v = value("--golden-dir=")) {
+            opt.golden_dir = v;
+        } else if (arg == "--update-golden") {
+            opt.update_golden = true;
+        } else if (arg == "--no-golden") {
+            opt.golden = false;
+        } else if (arg == "--verbose") {
+            opt.verbose = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<VerifyCase> cases;
+    add_point_cases(cases);
+    add_pool_cases(cases);
+    add_morphology_cases(cases);
+    add_filter_cases(cases);
+    add_geometry_cases(cases);
+    add_hough_cases(cases);
+    add_pipeline_cases(cases);
+    add_stream_cases(cases);
+    add_tiled_cases(cases);
+    add_mapped_cases(cases);
+    add_batch_cases(cases);
+    add_imgproc_cases(cases);
+    std::vector<GoldenCase> goldens;
+    add_golden_cases(goldens);
+    if (list) {
+        for (const VerifyCase& c : cases) {
+            std::cout << c.name << std::endl;
+        }
+        for (const GoldenCase& c : goldens) {
+            std::cout << c.name << std::endl;
+        }
+        return 0;
+    }
+
+    int failed = opt.update_golden ? 0 : verify_run(cases, opt);
+    if (opt.golden || opt.update_golden) {
+        failed += golden_run(goldens, opt);
+    }
+    std::printf("\n%s\n", failed ? "FAILED" : "all passed");
+    return failed ? 1 : 0;
+}